@@ -0,0 +1,182 @@
+/*  -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+
+/*\
+|*|
+|*| bench-common.h
+|*|
+|*| https://github.com/madmurphy/libgnunetworker
+|*|
+|*| Copyright (C) 2022 madmurphy <madmurphy333@gmail.com>
+|*|
+|*| **GNUnet Worker** is free software: you can redistribute it and/or modify
+|*| it under the terms of the GNU Affero General Public License as published by
+|*| the Free Software Foundation, either version 3 of the License, or (at your
+|*| option) any later version.
+|*|
+|*| **GNUnet Worker** is distributed in the hope that it will be useful, but
+|*| WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+|*| or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public
+|*| License for more details.
+|*|
+|*| You should have received a copy of the GNU Affero General Public License
+|*| along with this program. If not, see <http://www.gnu.org/licenses/>.
+|*|
+\*/
+
+
+/**
+
+	@file       bench-common.h
+	@brief      Sample collection and reporting shared by the benchmarks
+
+	Every benchmark collects one latency sample (in nanoseconds) per operation
+	and prints one CSV record with its percentiles and its throughput, so that
+	the output of different builds can be compared with ordinary text tools.
+
+**/
+
+
+#ifndef __BENCH_COMMON_H__
+#define __BENCH_COMMON_H__
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+
+/**
+	@brief      The header of the CSV records printed by `bench_report()`
+**/
+#define BENCH_CSV_HEADER \
+	"benchmark,samples,ops_per_sec,p50_ns,p99_ns,p999_ns\n"
+
+
+/**
+	@brief      The latency samples of one benchmark
+**/
+typedef struct BenchSamples {
+	uint64_t * values;				/**< The samples, in nanoseconds **/
+	size_t count;					/**< The number of samples collected **/
+	size_t size;					/**< The room available in `::values` **/
+	uint64_t elapsed;				/**< The whole duration of the run **/
+} BenchSamples;
+
+
+/**
+	@brief      Read the monotonic clock
+	@return     The current time in nanoseconds
+**/
+static inline uint64_t bench_now (void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+}
+
+
+/**
+	@brief      Allocate room for the samples of one benchmark
+	@param      samples         The samples to initialize
+	@param      size            The number of samples that will be collected
+	@return     `0` on success, `-1` if no memory is available
+**/
+static inline int bench_samples_init (
+	BenchSamples * const samples,
+	const size_t size
+) {
+	samples->count = 0;
+	samples->elapsed = 0;
+	samples->size = size;
+	return (samples->values = malloc(size * sizeof(uint64_t))) ? 0 : -1;
+}
+
+
+/**
+	@brief      Free the samples of one benchmark
+	@param      samples         The samples to free
+**/
+static inline void bench_samples_uninit (
+	BenchSamples * const samples
+) {
+	free(samples->values);
+	samples->values = NULL;
+	samples->count = samples->size = 0;
+}
+
+
+/**
+	@brief      Add one sample (samples beyond the allocated room are dropped)
+	@param      samples         The samples of the benchmark
+	@param      value           The latency to record, in nanoseconds
+**/
+static inline void bench_samples_add (
+	BenchSamples * const samples,
+	const uint64_t value
+) {
+	if (samples->count < samples->size) {
+		samples->values[samples->count++] = value;
+	}
+}
+
+
+static int bench_compare_u64 (const void * const a, const void * const b) {
+	const uint64_t x = *((const uint64_t *) a), y = *((const uint64_t *) b);
+	return (x > y) - (x < y);
+}
+
+
+/**
+	@brief      Get a percentile of a sorted array of samples (nearest rank)
+	@param      samples         The samples, sorted in ascending order
+	@param      per_mille       The percentile wanted, in thousandths
+	@return     The sample at the requested rank
+**/
+static inline uint64_t bench_percentile (
+	const BenchSamples * const samples,
+	const unsigned int per_mille
+) {
+	if (!samples->count) {
+		return 0;
+	}
+	size_t rank = (samples->count * per_mille + 999) / 1000;
+	return samples->values[rank ? rank - 1 : 0];
+}
+
+
+/**
+	@brief      Print the CSV record of a benchmark (this sorts the samples)
+	@param      name            The name of the benchmark
+	@param      samples         The samples collected
+	@param      operations      The number of operations performed during
+	                            `BenchSamples::elapsed`
+**/
+static inline void bench_report (
+	const char * const name,
+	BenchSamples * const samples,
+	const size_t operations
+) {
+	qsort(
+		samples->values,
+		samples->count,
+		sizeof(uint64_t),
+		&bench_compare_u64
+	);
+	printf(
+		"%s,%zu,%.0f,%llu,%llu,%llu\n",
+		name,
+		samples->count,
+		samples->elapsed ? operations * 1e9 / samples->elapsed : 0.0,
+		(unsigned long long) bench_percentile(samples, 500),
+		(unsigned long long) bench_percentile(samples, 990),
+		(unsigned long long) bench_percentile(samples, 999)
+	);
+	fflush(stdout);
+}
+
+
+#endif
+
+
+/*  EOF  */
+
@@ -0,0 +1,230 @@
+/*  -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+
+/*\
+|*|
+|*| bench-histogram.h
+|*|
+|*| https://github.com/madmurphy/libgnunetworker
+|*|
+|*| Copyright (C) 2022 madmurphy <madmurphy333@gmail.com>
+|*|
+|*| **GNUnet Worker** is free software: you can redistribute it and/or modify
+|*| it under the terms of the GNU Affero General Public License as published by
+|*| the Free Software Foundation, either version 3 of the License, or (at your
+|*| option) any later version.
+|*|
+|*| **GNUnet Worker** is distributed in the hope that it will be useful, but
+|*| WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+|*| or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public
+|*| License for more details.
+|*|
+|*| You should have received a copy of the GNU Affero General Public License
+|*| along with this program. If not, see <http://www.gnu.org/licenses/>.
+|*|
+\*/
+
+
+/**
+
+	@file       bench-histogram.h
+	@brief      A log-linear latency histogram in the style of HdrHistogram
+
+	Values below `BENCH_HISTOGRAM_SUB_COUNT` are counted exactly; above that,
+	every power of two is split into `BENCH_HISTOGRAM_SUB_COUNT / 2` linear
+	sub-buckets, so that the relative error never exceeds
+	`1 / (BENCH_HISTOGRAM_SUB_COUNT / 2)` (about 1.6%) over the whole 64-bit
+	range, with a fixed amount of memory and no allocation while recording.
+
+**/
+
+
+#ifndef __BENCH_HISTOGRAM_H__
+#define __BENCH_HISTOGRAM_H__
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/**
+	@brief      The number of bits of precision of every bucket
+**/
+#define BENCH_HISTOGRAM_SUB_BITS 7
+
+
+/**
+	@brief      The number of values that are counted exactly
+**/
+#define BENCH_HISTOGRAM_SUB_COUNT (1u << BENCH_HISTOGRAM_SUB_BITS)
+
+
+/**
+	@brief      The number of linear sub-buckets of every power of two
+**/
+#define BENCH_HISTOGRAM_HALF_COUNT (BENCH_HISTOGRAM_SUB_COUNT >> 1)
+
+
+/**
+	@brief      The total number of buckets of a histogram
+**/
+#define BENCH_HISTOGRAM_SIZE \
+	(BENCH_HISTOGRAM_SUB_COUNT + \
+	(64 - BENCH_HISTOGRAM_SUB_BITS) * BENCH_HISTOGRAM_HALF_COUNT)
+
+
+/**
+	@brief      A histogram of latencies (it is not thread-safe: every
+	            histogram must be updated by one thread only)
+**/
+typedef struct BenchHistogram {
+	uint64_t counts[BENCH_HISTOGRAM_SIZE];	/**< The buckets **/
+	uint64_t total;						/**< The number of values recorded **/
+	uint64_t sum;						/**< The sum of the values recorded **/
+	uint64_t max;						/**< The largest value recorded **/
+} BenchHistogram;
+
+
+/**
+	@brief      Empty a histogram
+	@param      histogram       The histogram to empty
+**/
+static inline void bench_histogram_reset (
+	BenchHistogram * const histogram
+) {
+	memset(histogram, 0, sizeof(BenchHistogram));
+}
+
+
+/**
+	@brief      Get the bucket a value falls in
+	@param      value           The value to look up
+	@return     The index of the bucket
+**/
+static inline unsigned int bench_histogram_index (
+	const uint64_t value
+) {
+	if (value < BENCH_HISTOGRAM_SUB_COUNT) {
+		return value;
+	}
+	const unsigned int shift =
+		63 - __builtin_clzll(value) - (BENCH_HISTOGRAM_SUB_BITS - 1);
+	return
+		BENCH_HISTOGRAM_SUB_COUNT +
+		(shift - 1) * BENCH_HISTOGRAM_HALF_COUNT +
+		((value >> shift) - BENCH_HISTOGRAM_HALF_COUNT);
+}
+
+
+/**
+	@brief      Get the highest value that falls in a bucket
+	@param      index           The index of the bucket
+	@return     The highest value equivalent to the bucket
+**/
+static inline uint64_t bench_histogram_value (
+	const unsigned int index
+) {
+	if (index < BENCH_HISTOGRAM_SUB_COUNT) {
+		return index;
+	}
+	const unsigned int
+		shift = (index - BENCH_HISTOGRAM_SUB_COUNT) /
+			BENCH_HISTOGRAM_HALF_COUNT + 1,
+		sub = (index - BENCH_HISTOGRAM_SUB_COUNT) %
+			BENCH_HISTOGRAM_HALF_COUNT + BENCH_HISTOGRAM_HALF_COUNT;
+	return ((uint64_t) sub << shift) + ((uint64_t) 1 << shift) - 1;
+}
+
+
+/**
+	@brief      Record a value
+	@param      histogram       The histogram to update
+	@param      value           The value to record
+**/
+static inline void bench_histogram_record (
+	BenchHistogram * const histogram,
+	const uint64_t value
+) {
+	histogram->counts[bench_histogram_index(value)]++;
+	histogram->total++;
+	histogram->sum += value;
+	if (value > histogram->max) {
+		histogram->max = value;
+	}
+}
+
+
+/**
+	@brief      Add all the values of a histogram to another histogram
+	@param      dest            The histogram to update
+	@param      src             The histogram to add
+**/
+static inline void bench_histogram_merge (
+	BenchHistogram * const dest,
+	const BenchHistogram * const src
+) {
+	for (unsigned int idx = 0; idx < BENCH_HISTOGRAM_SIZE; idx++) {
+		dest->counts[idx] += src->counts[idx];
+	}
+	dest->total += src->total;
+	dest->sum += src->sum;
+	if (src->max > dest->max) {
+		dest->max = src->max;
+	}
+}
+
+
+/**
+	@brief      Get a percentile of the values recorded
+	@param      histogram       The histogram to read
+	@param      per_million     The percentile wanted, in millionths
+	@return     The highest value equivalent to the bucket of the requested
+	            rank (never more than the largest value recorded)
+**/
+static inline uint64_t bench_histogram_percentile (
+	const BenchHistogram * const histogram,
+	const uint64_t per_million
+) {
+	const uint64_t rank = (histogram->total * per_million + 999999) / 1000000;
+	uint64_t seen = 0, value;
+	for (unsigned int idx = 0; idx < BENCH_HISTOGRAM_SIZE; idx++) {
+		if ((seen += histogram->counts[idx]) >= rank && seen) {
+			value = bench_histogram_value(idx);
+			return value < histogram->max ? value : histogram->max;
+		}
+	}
+	return histogram->max;
+}
+
+
+/**
+	@brief      Print the non-empty buckets of a histogram as CSV records
+	@param      output          The stream to write to
+	@param      histogram       The histogram to print
+**/
+static inline void bench_histogram_dump (
+	FILE * const output,
+	const BenchHistogram * const histogram
+) {
+	uint64_t seen = 0;
+	fprintf(output, "value_ns,count,cumulative_fraction\n");
+	for (unsigned int idx = 0; idx < BENCH_HISTOGRAM_SIZE; idx++) {
+		if (histogram->counts[idx]) {
+			seen += histogram->counts[idx];
+			fprintf(
+				output,
+				"%llu,%llu,%.6f\n",
+				(unsigned long long) bench_histogram_value(idx),
+				(unsigned long long) histogram->counts[idx],
+				(double) seen / histogram->total
+			);
+		}
+	}
+}
+
+
+#endif
+
+
+/*  EOF  */
+
@@ -0,0 +1,438 @@
+/*  -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+
+/*\
+|*|
+|*| gnunet-worker-bench.c
+|*|
+|*| https://github.com/madmurphy/libgnunetworker
+|*|
+|*| Copyright (C) 2022 madmurphy <madmurphy333@gmail.com>
+|*|
+|*| **GNUnet Worker** is free software: you can redistribute it and/or modify
+|*| it under the terms of the GNU Affero General Public License as published by
+|*| the Free Software Foundation, either version 3 of the License, or (at your
+|*| option) any later version.
+|*|
+|*| **GNUnet Worker** is distributed in the hope that it will be useful, but
+|*| WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+|*| or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public
+|*| License for more details.
+|*|
+|*| You should have received a copy of the GNU Affero General Public License
+|*| along with this program. If not, see <http://www.gnu.org/licenses/>.
+|*|
+\*/
+
+
+/*
+
+Microbenchmarks for the public API. Usage:
+
+	gnunet-worker-bench [-n SAMPLES] [BENCHMARK...]
+
+Without arguments every benchmark is run with its own default number of
+samples; `-l` lists the available benchmarks. One CSV record per benchmark is
+printed to the standard output (see `bench-common.h`).
+
+*/
+
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sched.h>
+#include "gnunet_worker_lib.h"
+#include "bench-common.h"
+
+
+typedef struct Benchmark {
+	const char * name;
+	size_t default_samples;
+	int (* run) (BenchSamples * samples);
+} Benchmark;
+
+
+static GNUNET_WORKER_Handle bench_worker;
+static atomic_uint_fast64_t executed_at;
+
+
+static void do_nothing (void * const data) {
+
+	/*  Nothing to do...  */
+
+}
+
+
+static void * call_nothing (void * const data) {
+
+	return data;
+
+}
+
+
+static void stamp_execution_time (void * const data) {
+
+	atomic_store_explicit(&executed_at, bench_now(), memory_order_release);
+
+}
+
+
+/*  Wait until the worker has run everything that has been pushed so far
+	(calls have the default priority, like the jobs of these benchmarks)  */
+static int drain_worker (void) {
+
+	return GNUNET_WORKER_call(bench_worker, &call_nothing, NULL, NULL);
+
+}
+
+
+static void * push_from_worker_thread (void * const v_samples) {
+
+	BenchSamples * const samples = v_samples;
+	uint64_t start, end = bench_now();
+	const uint64_t begin = end;
+
+	while (samples->count < samples->size) {
+
+		start = end;
+
+		if (
+			GNUNET_WORKER_push_load_with_priority(
+				bench_worker,
+				GNUNET_SCHEDULER_PRIORITY_DEFAULT,
+				&do_nothing,
+				NULL
+			)
+		) {
+
+			return v_samples;
+
+		}
+
+		end = bench_now();
+		bench_samples_add(samples, end - start);
+
+	}
+
+	samples->elapsed = end - begin;
+	return NULL;
+
+}
+
+
+static int bench_push_same_thread (BenchSamples * const samples) {
+
+	void * failed;
+
+	if (
+		GNUNET_WORKER_call(
+			bench_worker,
+			&push_from_worker_thread,
+			samples,
+			&failed
+		) || failed
+	) {
+
+		return -1;
+
+	}
+
+	return drain_worker();
+
+}
+
+
+static int bench_push_cross_thread (BenchSamples * const samples) {
+
+	uint64_t start, end = bench_now();
+	const uint64_t begin = end;
+
+	while (samples->count < samples->size) {
+
+		start = end;
+
+		if (
+			GNUNET_WORKER_push_load_with_priority(
+				bench_worker,
+				GNUNET_SCHEDULER_PRIORITY_DEFAULT,
+				&do_nothing,
+				NULL
+			)
+		) {
+
+			return -1;
+
+		}
+
+		end = bench_now();
+		bench_samples_add(samples, end - start);
+
+	}
+
+	samples->elapsed = end - begin;
+	return drain_worker();
+
+}
+
+
+static int bench_push_to_execution (BenchSamples * const samples) {
+
+	uint64_t start, done;
+	const uint64_t begin = bench_now();
+
+	while (samples->count < samples->size) {
+
+		atomic_store_explicit(&executed_at, 0, memory_order_relaxed);
+		start = bench_now();
+
+		if (
+			GNUNET_WORKER_push_load_with_priority(
+				bench_worker,
+				GNUNET_SCHEDULER_PRIORITY_DEFAULT,
+				&stamp_execution_time,
+				NULL
+			)
+		) {
+
+			return -1;
+
+		}
+
+		while (
+			!(done = atomic_load_explicit(&executed_at, memory_order_acquire))
+		) {
+
+			sched_yield();
+
+		}
+
+		bench_samples_add(samples, done - start);
+
+	}
+
+	samples->elapsed = bench_now() - begin;
+	return 0;
+
+}
+
+
+static int bench_ping (BenchSamples * const samples) {
+
+	uint64_t start, end = bench_now();
+	const uint64_t begin = end;
+
+	while (samples->count < samples->size) {
+
+		start = end;
+
+		if (!GNUNET_WORKER_ping(bench_worker)) {
+
+			return -1;
+
+		}
+
+		end = bench_now();
+		bench_samples_add(samples, end - start);
+
+	}
+
+	samples->elapsed = end - begin;
+	return drain_worker();
+
+}
+
+
+static int bench_call_round_trip (BenchSamples * const samples) {
+
+	uint64_t start, end = bench_now();
+	const uint64_t begin = end;
+
+	while (samples->count < samples->size) {
+
+		start = end;
+
+		if (GNUNET_WORKER_call(bench_worker, &call_nothing, NULL, NULL)) {
+
+			return -1;
+
+		}
+
+		end = bench_now();
+		bench_samples_add(samples, end - start);
+
+	}
+
+	samples->elapsed = end - begin;
+	return 0;
+
+}
+
+
+static int bench_create_destroy (BenchSamples * const samples) {
+
+	GNUNET_WORKER_Handle worker;
+	uint64_t start, end = bench_now();
+	const uint64_t begin = end;
+
+	while (samples->count < samples->size) {
+
+		start = end;
+
+		if (
+			GNUNET_WORKER_create(&worker, NULL, NULL, NULL) ||
+			GNUNET_WORKER_synch_destroy(worker)
+		) {
+
+			return -1;
+
+		}
+
+		end = bench_now();
+		bench_samples_add(samples, end - start);
+
+	}
+
+	samples->elapsed = end - begin;
+	return 0;
+
+}
+
+
+static const Benchmark benchmarks[] = {
+	{ "push-same-thread", 1000000, &bench_push_same_thread },
+	{ "push-cross-thread", 1000000, &bench_push_cross_thread },
+	{ "push-to-execution", 100000, &bench_push_to_execution },
+	{ "ping", 100000, &bench_ping },
+	{ "call-round-trip", 100000, &bench_call_round_trip },
+	{ "create-destroy", 1000, &bench_create_destroy }
+};
+
+
+#define BENCHMARK_COUNT (sizeof(benchmarks) / sizeof(Benchmark))
+
+
+static int run_benchmark (
+	const Benchmark * const benchmark,
+	const size_t sample_count
+) {
+
+	BenchSamples samples;
+
+	if (
+		bench_samples_init(
+			&samples,
+			sample_count ? sample_count : benchmark->default_samples
+		)
+	) {
+
+		fprintf(stderr, "%s: out of memory\n", benchmark->name);
+		return -1;
+
+	}
+
+	const int retval = benchmark->run(&samples);
+
+	if (retval) {
+
+		fprintf(stderr, "%s: the worker has failed\n", benchmark->name);
+
+	} else {
+
+		bench_report(benchmark->name, &samples, samples.count);
+
+	}
+
+	bench_samples_uninit(&samples);
+	return retval;
+
+}
+
+
+int main (const int argc, char * const * const argv) {
+
+	size_t sample_count = 0, idx;
+	int opt, retval = 0;
+
+	while ((opt = getopt(argc, argv, "ln:")) != -1) {
+
+		switch (opt) {
+
+			case 'l':
+
+				for (idx = 0; idx < BENCHMARK_COUNT; idx++) {
+
+					printf("%s\n", benchmarks[idx].name);
+
+				}
+
+				return 0;
+
+			case 'n':
+
+				sample_count = strtoul(optarg, NULL, 10);
+				break;
+
+			default:
+
+				fprintf(
+					stderr,
+					"Usage: %s [-l] [-n SAMPLES] [BENCHMARK...]\n",
+					argv[0]
+				);
+
+				return 2;
+
+		}
+
+	}
+
+	if (GNUNET_WORKER_create(&bench_worker, NULL, NULL, NULL)) {
+
+		fprintf(stderr, "Unable to create the worker\n");
+		return 1;
+
+	}
+
+	printf(BENCH_CSV_HEADER);
+
+	for (idx = 0; idx < BENCHMARK_COUNT; idx++) {
+
+		if (optind < argc) {
+
+			int argi = optind;
+
+			while (argi < argc && strcmp(argv[argi], benchmarks[idx].name)) {
+
+				argi++;
+
+			}
+
+			if (argi == argc) {
+
+				continue;
+
+			}
+
+		}
+
+		if (run_benchmark(benchmarks + idx, sample_count)) {
+
+			retval = 1;
+
+		}
+
+	}
+
+	GNUNET_WORKER_synch_destroy(bench_worker);
+	return retval;
+
+}
+
+
+/*  EOF  */
+
@@ -0,0 +1,503 @@
+/*  -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+
+/*\
+|*|
+|*| gnunet-worker-contention.c
+|*|
+|*| https://github.com/madmurphy/libgnunetworker
+|*|
+|*| Copyright (C) 2022 madmurphy <madmurphy333@gmail.com>
+|*|
+|*| **GNUnet Worker** is free software: you can redistribute it and/or modify
+|*| it under the terms of the GNU Affero General Public License as published by
+|*| the Free Software Foundation, either version 3 of the License, or (at your
+|*| option) any later version.
+|*|
+|*| **GNUnet Worker** is distributed in the hope that it will be useful, but
+|*| WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+|*| or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public
+|*| License for more details.
+|*|
+|*| You should have received a copy of the GNU Affero General Public License
+|*| along with this program. If not, see <http://www.gnu.org/licenses/>.
+|*|
+\*/
+
+
+/*
+
+A sweep of the number of producer threads pushing into one single worker.
+Usage:
+
+	gnunet-worker-contention [-p MAX_PRODUCERS] [-n JOBS] [-o FILE]
+
+The producer count doubles at every round, from 1 to `MAX_PRODUCERS` (by
+default the number of online CPUs). The worker thread is pinned to the first
+CPU and every producer to the next one, in round robin. For every round one
+CSV record is written to `FILE` (by default the standard output) with the
+push throughput and, summed over the worker and all the producers, the
+hardware counters collected via `perf_event_open(2)` and the time spent
+blocked (wall-clock time minus CPU time of the producers, i.e. mostly futex
+waits). The last two columns are the cycles and the cache misses of the worker
+thread alone, divided by the number of jobs: since the worker thread does the
+same work for every job, they grow only with the cache lines that the
+producers steal from it (e.g. by false sharing), and are the figures to watch
+for regressions in the memory layout of a worker. Counters that the system
+does not allow to read are left empty.
+
+*/
+
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "gnunet_worker_lib.h"
+#include "bench-common.h"
+
+
+#define CONTENTION_CSV_HEADER \
+	"producers,jobs,seconds,pushes_per_sec,jobs_per_sec,cycles," \
+	"cache_misses,context_switches,wait_ns,worker_cycles_per_job," \
+	"worker_cache_misses_per_job\n"
+
+
+enum CounterIndex {
+	COUNTER_CYCLES,
+	COUNTER_CACHE_MISSES,
+	COUNTER_CONTEXT_SWITCHES,
+	COUNTER_COUNT
+};
+
+
+typedef struct CounterSet {
+	int fds[COUNTER_COUNT];
+	uint64_t values[COUNTER_COUNT];
+} CounterSet;
+
+
+typedef struct Producer {
+	pthread_t thread;
+	unsigned int cpu;
+	CounterSet counters;
+	uint64_t wait_ns;
+} Producer;
+
+
+static const struct {
+	uint32_t type;
+	uint64_t config;
+} counter_events[COUNTER_COUNT] = {
+	[COUNTER_CYCLES] = {
+		PERF_TYPE_HARDWARE,
+		PERF_COUNT_HW_CPU_CYCLES
+	},
+	[COUNTER_CACHE_MISSES] = {
+		PERF_TYPE_HARDWARE,
+		PERF_COUNT_HW_CACHE_MISSES
+	},
+	[COUNTER_CONTEXT_SWITCHES] = {
+		PERF_TYPE_SOFTWARE,
+		PERF_COUNT_SW_CONTEXT_SWITCHES
+	}
+};
+
+
+static GNUNET_WORKER_Handle bench_worker;
+static pthread_barrier_t start_barrier;
+static unsigned long jobs_per_producer = 100000;
+static unsigned int cpu_count;
+static CounterSet worker_counters;
+
+
+static void counters_open (CounterSet * const counters) {
+
+	struct perf_event_attr attr;
+
+	for (unsigned int idx = 0; idx < COUNTER_COUNT; idx++) {
+
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = counter_events[idx].type;
+		attr.config = counter_events[idx].config;
+		attr.disabled = 1;
+		attr.exclude_hv = 1;
+		counters->values[idx] = 0;
+
+		/*  Unprivileged users might be allowed to count only user space  */
+
+		if (
+			(
+				counters->fds[idx] =
+					syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0)
+			) < 0
+		) {
+
+			attr.exclude_kernel = 1;
+			counters->fds[idx] =
+				syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+
+		}
+
+		if (counters->fds[idx] >= 0) {
+
+			ioctl(counters->fds[idx], PERF_EVENT_IOC_ENABLE, 0);
+
+		}
+
+	}
+
+}
+
+
+static void counters_close (CounterSet * const counters) {
+
+	for (unsigned int idx = 0; idx < COUNTER_COUNT; idx++) {
+
+		if (counters->fds[idx] < 0) {
+
+			continue;
+
+		}
+
+		ioctl(counters->fds[idx], PERF_EVENT_IOC_DISABLE, 0);
+
+		if (
+			read(
+				counters->fds[idx],
+				counters->values + idx,
+				sizeof(uint64_t)
+			) != sizeof(uint64_t)
+		) {
+
+			counters->values[idx] = 0;
+
+		}
+
+		close(counters->fds[idx]);
+
+	}
+
+}
+
+
+static void pin_current_thread (const unsigned int cpu) {
+
+	cpu_set_t cpu_set;
+
+	CPU_ZERO(&cpu_set);
+	CPU_SET(cpu % cpu_count, &cpu_set);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+
+}
+
+
+static void * worker_prepare (void * const data) {
+
+	pin_current_thread(0);
+	counters_open(&worker_counters);
+	return NULL;
+
+}
+
+
+static void * worker_collect (void * const data) {
+
+	counters_close(&worker_counters);
+	return NULL;
+
+}
+
+
+static void do_nothing (void * const data) {
+
+	/*  Nothing to do...  */
+
+}
+
+
+static uint64_t thread_cpu_time (void) {
+
+	struct timespec now;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+	return (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+
+}
+
+
+static void * producer_routine (void * const v_producer) {
+
+	Producer * const producer = v_producer;
+
+	pin_current_thread(producer->cpu);
+	pthread_barrier_wait(&start_barrier);
+	counters_open(&producer->counters);
+
+	const uint64_t wall_start = bench_now(), cpu_start = thread_cpu_time();
+
+	for (unsigned long idx = 0; idx < jobs_per_producer; idx++) {
+
+		while (GNUNET_WORKER_push_load(bench_worker, &do_nothing, NULL));
+
+	}
+
+	producer->wait_ns =
+		(bench_now() - wall_start) - (thread_cpu_time() - cpu_start);
+
+	counters_close(&producer->counters);
+	return NULL;
+
+}
+
+
+static void print_counter (
+	FILE * const output,
+	const uint64_t value,
+	const bool available
+) {
+
+	if (available) {
+
+		fprintf(output, ",%llu", (unsigned long long) value);
+
+	} else {
+
+		fputc(',', output);
+
+	}
+
+}
+
+
+static int run_round (
+	FILE * const output,
+	const unsigned int producer_count
+) {
+
+	Producer * const producers = calloc(producer_count, sizeof(Producer));
+	const unsigned long total_jobs = producer_count * jobs_per_producer;
+	uint64_t start, push_time, total_time, wait_ns = 0;
+	uint64_t totals[COUNTER_COUNT];
+	bool available[COUNTER_COUNT];
+
+	if (!producers) {
+
+		return -1;
+
+	}
+
+	if (GNUNET_WORKER_call(bench_worker, &worker_prepare, NULL, NULL)) {
+
+		free(producers);
+		return -1;
+
+	}
+
+	pthread_barrier_init(&start_barrier, NULL, producer_count + 1);
+
+	for (unsigned int idx = 0; idx < producer_count; idx++) {
+
+		producers[idx].cpu = idx + 1;
+		pthread_create(
+			&producers[idx].thread,
+			NULL,
+			&producer_routine,
+			producers + idx
+		);
+
+	}
+
+	pthread_barrier_wait(&start_barrier);
+	start = bench_now();
+
+	for (unsigned int idx = 0; idx < producer_count; idx++) {
+
+		pthread_join(producers[idx].thread, NULL);
+
+	}
+
+	push_time = bench_now() - start;
+
+	/*  Calls have the same priority as the jobs and run after all of them  */
+
+	GNUNET_WORKER_call(bench_worker, &worker_collect, NULL, NULL);
+	total_time = bench_now() - start;
+	pthread_barrier_destroy(&start_barrier);
+
+	for (unsigned int cnt = 0; cnt < COUNTER_COUNT; cnt++) {
+
+		available[cnt] = worker_counters.fds[cnt] >= 0;
+		totals[cnt] = worker_counters.values[cnt];
+
+	}
+
+	for (unsigned int idx = 0; idx < producer_count; idx++) {
+
+		wait_ns += producers[idx].wait_ns;
+
+		for (unsigned int cnt = 0; cnt < COUNTER_COUNT; cnt++) {
+
+			available[cnt] &= producers[idx].counters.fds[cnt] >= 0;
+			totals[cnt] += producers[idx].counters.values[cnt];
+
+		}
+
+	}
+
+	fprintf(
+		output,
+		"%u,%lu,%.6f,%.0f,%.0f",
+		producer_count,
+		total_jobs,
+		total_time / 1e9,
+		total_jobs * 1e9 / push_time,
+		total_jobs * 1e9 / total_time
+	);
+
+	for (unsigned int cnt = 0; cnt < COUNTER_COUNT; cnt++) {
+
+		print_counter(output, totals[cnt], available[cnt]);
+
+	}
+
+	fprintf(output, ",%llu", (unsigned long long) wait_ns);
+
+	for (unsigned int cnt = 0; cnt < COUNTER_CONTEXT_SWITCHES; cnt++) {
+
+		if (worker_counters.fds[cnt] >= 0) {
+
+			fprintf(
+				output,
+				",%.3f",
+				(double) worker_counters.values[cnt] / total_jobs
+			);
+
+		} else {
+
+			fputc(',', output);
+
+		}
+
+	}
+
+	fputc('\n', output);
+	fflush(output);
+	free(producers);
+	return 0;
+
+}
+
+
+int main (const int argc, char * const * const argv) {
+
+	FILE * output = stdout;
+	unsigned int max_producers = 0;
+	int opt, retval = 0;
+
+	while ((opt = getopt(argc, argv, "n:o:p:")) != -1) {
+
+		switch (opt) {
+
+			case 'n':
+
+				jobs_per_producer = strtoul(optarg, NULL, 10);
+				break;
+
+			case 'o':
+
+				if (!(output = fopen(optarg, "w"))) {
+
+					perror(optarg);
+					return 1;
+
+				}
+
+				break;
+
+			case 'p':
+
+				max_producers = strtoul(optarg, NULL, 10);
+				break;
+
+			default:
+
+				fprintf(
+					stderr,
+					"Usage: %s [-p MAX_PRODUCERS] [-n JOBS] [-o FILE]\n",
+					argv[0]
+				);
+
+				return 2;
+
+		}
+
+	}
+
+	const long online_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+	cpu_count = online_cpus > 0 ? online_cpus : 1;
+
+	if (!max_producers) {
+
+		max_producers = cpu_count;
+
+	}
+
+	if (GNUNET_WORKER_create(&bench_worker, NULL, NULL, NULL)) {
+
+		fprintf(stderr, "Unable to create the worker\n");
+		return 1;
+
+	}
+
+	fprintf(output, CONTENTION_CSV_HEADER);
+
+	for (unsigned int count = 1; ; count <<= 1) {
+
+		if (count > max_producers) {
+
+			count = max_producers;
+
+		}
+
+		if (run_round(output, count)) {
+
+			fprintf(stderr, "The worker has failed\n");
+			retval = 1;
+			break;
+
+		}
+
+		if (count == max_producers) {
+
+			break;
+
+		}
+
+	}
+
+	GNUNET_WORKER_synch_destroy(bench_worker);
+
+	if (output != stdout) {
+
+		fclose(output);
+
+	}
+
+	return retval;
+
+}
+
+
+/*  EOF  */
+
@@ -0,0 +1,565 @@
+/*  -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+
+/*\
+|*|
+|*| gnunet-worker-loadgen.c
+|*|
+|*| https://github.com/madmurphy/libgnunetworker
+|*|
+|*| Copyright (C) 2022 madmurphy <madmurphy333@gmail.com>
+|*|
+|*| **GNUnet Worker** is free software: you can redistribute it and/or modify
+|*| it under the terms of the GNU Affero General Public License as published by
+|*| the Free Software Foundation, either version 3 of the License, or (at your
+|*| option) any later version.
+|*|
+|*| **GNUnet Worker** is distributed in the hope that it will be useful, but
+|*| WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+|*| or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public
+|*| License for more details.
+|*|
+|*| You should have received a copy of the GNU Affero General Public License
+|*| along with this program. If not, see <http://www.gnu.org/licenses/>.
+|*|
+\*/
+
+
+/*
+
+An open-loop load generator. Usage:
+
+	gnunet-worker-loadgen [-r RATE] [-d SECONDS] [-t PRODUCERS]
+		[-m PRIORITY=WEIGHT,...] [-s SERVICE] [-H FILE]
+
+The producers push `RATE` jobs per second in total, for `SECONDS` seconds,
+following a fixed schedule: every job has an intended start time that does
+not depend on how fast the previous jobs were pushed or served. A producer
+that falls behind pushes at once, without skipping jobs and without moving
+the schedule forward, so that the time lost is charged to the jobs that
+suffered it (no coordinated omission).
+
+The priority of every job is drawn from the mix given with `-m` (e.g.
+`-m default=90,urgent=10`; the default is `default=1`), and so is the time
+the job keeps the worker busy, given with `-s` in microseconds as
+`const:USEC`, `uniform:MIN-MAX` or `exp:MEAN` (the default is `const:0`).
+
+The delay between the intended and the actual start of every job is
+recorded in one histogram per priority. At the end one CSV record per
+priority and one for all the jobs are printed to the standard output; with
+`-H` the whole histogram of all the jobs is also written to `FILE`. A short
+summary of the run is printed to the standard error.
+
+*/
+
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include "gnunet_worker_lib.h"
+#include "bench-common.h"
+#include "bench-histogram.h"
+
+
+#define LOADGEN_CSV_HEADER \
+	"priority,jobs,mean_ns,p50_ns,p90_ns,p99_ns,p999_ns,p9999_ns,max_ns\n"
+
+
+/*  Below this distance from the intended time producers spin instead of
+	sleeping  */
+#define SPIN_THRESHOLD_NS 50000
+
+
+enum ServiceDistribution {
+	SERVICE_CONSTANT,
+	SERVICE_UNIFORM,
+	SERVICE_EXPONENTIAL
+};
+
+
+typedef struct LoadJob {
+	uint64_t intended_start;
+	uint64_t service_ns;
+	enum GNUNET_SCHEDULER_Priority priority;
+} LoadJob;
+
+
+typedef struct Producer {
+	pthread_t thread;
+	unsigned int index;
+	uint64_t seed;
+	unsigned long failures;
+} Producer;
+
+
+static const char * const priority_names[GNUNET_SCHEDULER_PRIORITY_COUNT] = {
+	[GNUNET_SCHEDULER_PRIORITY_IDLE] = "idle",
+	[GNUNET_SCHEDULER_PRIORITY_BACKGROUND] = "background",
+	[GNUNET_SCHEDULER_PRIORITY_DEFAULT] = "default",
+	[GNUNET_SCHEDULER_PRIORITY_HIGH] = "high",
+	[GNUNET_SCHEDULER_PRIORITY_UI] = "ui",
+	[GNUNET_SCHEDULER_PRIORITY_URGENT] = "urgent"
+};
+
+
+static GNUNET_WORKER_Handle bench_worker;
+static LoadJob * load_jobs;
+static uint64_t job_count, run_start;
+static double arrival_rate = 100000, run_seconds = 5;
+static unsigned int producer_count = 1;
+static unsigned int priority_weights[GNUNET_SCHEDULER_PRIORITY_COUNT];
+static unsigned int weight_sum;
+static enum ServiceDistribution service_distribution = SERVICE_CONSTANT;
+static double service_a, service_b;
+static atomic_ulong jobs_completed;
+
+/*  Touched only by the worker thread  */
+static BenchHistogram histograms[GNUNET_SCHEDULER_PRIORITY_COUNT];
+
+
+static uint64_t random_next (uint64_t * const state) {
+
+	/*  xorshift64*  */
+
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+	return *state * 0x2545F4914F6CDD1DULL;
+
+}
+
+
+static double random_unit (uint64_t * const state) {
+
+	return (random_next(state) >> 11) * (1.0 / 9007199254740992.0);
+
+}
+
+
+static uint64_t draw_service_time (uint64_t * const state) {
+
+	double usec;
+
+	switch (service_distribution) {
+
+		case SERVICE_UNIFORM:
+
+			usec = service_a + (service_b - service_a) * random_unit(state);
+			break;
+
+		case SERVICE_EXPONENTIAL:
+
+			usec = -service_a * log(1.0 - random_unit(state));
+			break;
+
+		default:
+
+			usec = service_a;
+
+	}
+
+	return usec * 1000;
+
+}
+
+
+static enum GNUNET_SCHEDULER_Priority draw_priority (uint64_t * const state) {
+
+	unsigned int ticket = random_next(state) % weight_sum, prio = 0;
+
+	while (ticket >= priority_weights[prio]) {
+
+		ticket -= priority_weights[prio++];
+
+	}
+
+	return prio;
+
+}
+
+
+static void run_load_job (void * const v_job) {
+
+	const LoadJob * const job = v_job;
+	const uint64_t now = bench_now();
+
+	bench_histogram_record(
+		histograms + job->priority,
+		now > job->intended_start ? now - job->intended_start : 0
+	);
+
+	/*  Keep the worker busy for the job's service time  */
+
+	while (bench_now() - now < job->service_ns);
+
+	atomic_fetch_add_explicit(&jobs_completed, 1, memory_order_release);
+
+}
+
+
+static void wait_until (const uint64_t deadline) {
+
+	uint64_t now = bench_now();
+
+	if (now + SPIN_THRESHOLD_NS < deadline) {
+
+		const uint64_t wake_up = deadline - SPIN_THRESHOLD_NS;
+		const struct timespec until = {
+			.tv_sec = wake_up / 1000000000,
+			.tv_nsec = wake_up % 1000000000
+		};
+
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL);
+
+	}
+
+	while (bench_now() < deadline);
+
+}
+
+
+static void * producer_routine (void * const v_producer) {
+
+	Producer * const producer = v_producer;
+	LoadJob * job;
+
+	/*  Producers take turns: job `n` belongs to producer `n % producer_count`
+		and is due `n / arrival_rate` seconds after the start  */
+
+	for (
+		uint64_t idx = producer->index;
+			idx < job_count;
+		idx += producer_count
+	) {
+
+		job = load_jobs + idx;
+		job->intended_start = run_start + (uint64_t) (idx * 1e9 / arrival_rate);
+		job->priority = draw_priority(&producer->seed);
+		job->service_ns = draw_service_time(&producer->seed);
+		wait_until(job->intended_start);
+
+		if (
+			GNUNET_WORKER_push_load_with_priority(
+				bench_worker,
+				job->priority,
+				&run_load_job,
+				job
+			)
+		) {
+
+			producer->failures++;
+
+		}
+
+	}
+
+	return NULL;
+
+}
+
+
+static void print_histogram (
+	const char * const name,
+	const BenchHistogram * const histogram
+) {
+
+	printf(
+		"%s,%llu,%.0f,%llu,%llu,%llu,%llu,%llu,%llu\n",
+		name,
+		(unsigned long long) histogram->total,
+		histogram->total ? (double) histogram->sum / histogram->total : 0.0,
+		(unsigned long long) bench_histogram_percentile(histogram, 500000),
+		(unsigned long long) bench_histogram_percentile(histogram, 900000),
+		(unsigned long long) bench_histogram_percentile(histogram, 990000),
+		(unsigned long long) bench_histogram_percentile(histogram, 999000),
+		(unsigned long long) bench_histogram_percentile(histogram, 999900),
+		(unsigned long long) histogram->max
+	);
+
+}
+
+
+static int parse_mix (char * const mix) {
+
+	char * save_ptr, * entry, * weight;
+	unsigned int prio;
+
+	memset(priority_weights, 0, sizeof(priority_weights));
+	weight_sum = 0;
+
+	for (
+		entry = strtok_r(mix, ",", &save_ptr);
+			entry;
+		entry = strtok_r(NULL, ",", &save_ptr)
+	) {
+
+		if ((weight = strchr(entry, '='))) {
+
+			*weight++ = '\0';
+
+		}
+
+		for (
+			prio = 0;
+				prio < GNUNET_SCHEDULER_PRIORITY_COUNT && (
+					!priority_names[prio] ||
+					strcmp(priority_names[prio], entry)
+				);
+			prio++
+		);
+
+		if (prio == GNUNET_SCHEDULER_PRIORITY_COUNT) {
+
+			return -1;
+
+		}
+
+		priority_weights[prio] = weight ? strtoul(weight, NULL, 10) : 1;
+		weight_sum += priority_weights[prio];
+
+	}
+
+	return weight_sum ? 0 : -1;
+
+}
+
+
+static int parse_service (const char * const service) {
+
+	if (sscanf(service, "const:%lf", &service_a) == 1) {
+
+		service_distribution = SERVICE_CONSTANT;
+		return 0;
+
+	}
+
+	if (sscanf(service, "uniform:%lf-%lf", &service_a, &service_b) == 2) {
+
+		service_distribution = SERVICE_UNIFORM;
+		return service_b >= service_a ? 0 : -1;
+
+	}
+
+	if (sscanf(service, "exp:%lf", &service_a) == 1) {
+
+		service_distribution = SERVICE_EXPONENTIAL;
+		return 0;
+
+	}
+
+	return -1;
+
+}
+
+
+int main (const int argc, char * const * const argv) {
+
+	const char * histogram_path = NULL;
+	unsigned long failures = 0;
+	int opt;
+
+	priority_weights[GNUNET_SCHEDULER_PRIORITY_DEFAULT] = weight_sum = 1;
+
+	while ((opt = getopt(argc, argv, "d:H:m:r:s:t:")) != -1) {
+
+		switch (opt) {
+
+			case 'd':
+
+				run_seconds = strtod(optarg, NULL);
+				break;
+
+			case 'H':
+
+				histogram_path = optarg;
+				break;
+
+			case 'm':
+
+				if (parse_mix(optarg)) {
+
+					fprintf(stderr, "Invalid priority mix: %s\n", optarg);
+					return 2;
+
+				}
+
+				break;
+
+			case 'r':
+
+				arrival_rate = strtod(optarg, NULL);
+				break;
+
+			case 's':
+
+				if (parse_service(optarg)) {
+
+					fprintf(stderr, "Invalid service time: %s\n", optarg);
+					return 2;
+
+				}
+
+				break;
+
+			case 't':
+
+				producer_count = strtoul(optarg, NULL, 10);
+				break;
+
+			default:
+
+				fprintf(
+					stderr,
+					"Usage: %s [-r RATE] [-d SECONDS] [-t PRODUCERS] "
+					"[-m PRIORITY=WEIGHT,...] [-s SERVICE] [-H FILE]\n",
+					argv[0]
+				);
+
+				return 2;
+
+		}
+
+	}
+
+	if (arrival_rate <= 0 || run_seconds <= 0 || !producer_count) {
+
+		fprintf(stderr, "Rate, duration and producers must be positive\n");
+		return 2;
+
+	}
+
+	job_count = arrival_rate * run_seconds;
+
+	if (!(load_jobs = calloc(job_count, sizeof(LoadJob)))) {
+
+		fprintf(stderr, "Unable to allocate %llu jobs\n",
+			(unsigned long long) job_count);
+		return 1;
+
+	}
+
+	Producer * const producers = calloc(producer_count, sizeof(Producer));
+
+	if (!producers) {
+
+		fprintf(stderr, "Unable to allocate %u producers\n", producer_count);
+		return 1;
+
+	}
+
+	if (GNUNET_WORKER_create(&bench_worker, NULL, NULL, NULL)) {
+
+		fprintf(stderr, "Unable to create the worker\n");
+		return 1;
+
+	}
+
+	/*  Leave some time to the producers for getting ready  */
+
+	run_start = bench_now() + 10000000;
+
+	for (unsigned int idx = 0; idx < producer_count; idx++) {
+
+		producers[idx].index = idx;
+		producers[idx].seed = 0x9E3779B97F4A7C15ULL * (idx + 1);
+		pthread_create(
+			&producers[idx].thread,
+			NULL,
+			&producer_routine,
+			producers + idx
+		);
+
+	}
+
+	for (unsigned int idx = 0; idx < producer_count; idx++) {
+
+		pthread_join(producers[idx].thread, NULL);
+		failures += producers[idx].failures;
+
+	}
+
+	const uint64_t push_end = bench_now();
+
+	while (
+		atomic_load_explicit(&jobs_completed, memory_order_acquire) <
+			job_count - failures
+	) {
+
+		usleep(1000);
+
+	}
+
+	const uint64_t run_end = bench_now();
+
+	GNUNET_WORKER_synch_destroy(bench_worker);
+
+	BenchHistogram * const all_jobs = malloc(sizeof(BenchHistogram));
+
+	if (!all_jobs) {
+
+		fprintf(stderr, "Unable to allocate the histogram\n");
+		return 1;
+
+	}
+
+	bench_histogram_reset(all_jobs);
+	printf(LOADGEN_CSV_HEADER);
+
+	for (unsigned int prio = 0; prio < GNUNET_SCHEDULER_PRIORITY_COUNT; prio++) {
+
+		if (priority_weights[prio]) {
+
+			print_histogram(priority_names[prio], histograms + prio);
+			bench_histogram_merge(all_jobs, histograms + prio);
+
+		}
+
+	}
+
+	print_histogram("all", all_jobs);
+
+	fprintf(
+		stderr,
+		"offered %.0f jobs/s, pushed %.0f jobs/s, completed %.0f jobs/s, "
+		"%lu failed pushes\n",
+		arrival_rate,
+		job_count * 1e9 / (push_end - run_start),
+		(job_count - failures) * 1e9 / (run_end - run_start),
+		failures
+	);
+
+	if (histogram_path) {
+
+		FILE * const output = fopen(histogram_path, "w");
+
+		if (!output) {
+
+			perror(histogram_path);
+
+		} else {
+
+			bench_histogram_dump(output, all_jobs);
+			fclose(output);
+
+		}
+
+	}
+
+	free(all_jobs);
+	free(producers);
+	free(load_jobs);
+	return 0;
+
+}
+
+
+/*  EOF  */
+
@@ -0,0 +1,63 @@
+/*  -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <gnunet/gnunet_worker_lib.h>
+
+
+/*  This counter is touched only by the worker thread, so it needs no lock  */
+static uintptr_t counter = 0;
+
+
+static void * increase_counter (void * const data) {
+
+	counter += (uintptr_t) data;
+	printf("Hello world from the worker thread (counter: %" PRIuPTR ")\n", counter);
+	return (void *) counter;
+
+}
+
+
+int main (const int argc, const char * const * const argv) {
+
+	GNUNET_WORKER_Handle my_worker;
+	void * result;
+
+	/*  Create a separate thread where GNUnet's scheduler is run  */
+	if (GNUNET_WORKER_create(&my_worker, NULL, NULL, NULL)) {
+
+		fprintf(stderr, "Sorry, something went wrong :-(\n");
+		return 1;
+
+	};
+
+	/*  Run a function in the scheduler's thread and wait for its result (no
+		barriers needed)  */
+
+	for (uintptr_t step = 1; step < 4; step++) {
+
+		if (
+			GNUNET_WORKER_call(
+				my_worker,
+				&increase_counter,
+				(void *) step,
+				&result
+			)
+		) {
+
+			fprintf(stderr, "The call has failed\n");
+			break;
+
+		}
+
+		printf("The worker thread has returned %" PRIuPTR "\n", (uintptr_t) result);
+
+	}
+
+	/*  Shut down the scheduler and wait until it returns  */
+	GNUNET_WORKER_synch_destroy(my_worker);
+
+	return 0;
+
+}
@@ -0,0 +1,7 @@
+#!/usr/bin/sh
+#
+# run-call-example.sh
+#
+
+gcc -pedantic -Wall -pthread -lgnunetworker -o '/tmp/call-example' call-example.c && \
+	'/tmp/call-example' && rm '/tmp/call-example'
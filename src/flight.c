@@ -0,0 +1,773 @@
+/*  -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+
+/*\
+|*|
+|*| libgnunetworker/src/flight.c
+|*|
+|*| https://github.com/madmurphy/libgnunetworker
+|*|
+|*| Copyright (C) 2022 madmurphy <madmurphy333@gmail.com>
+|*|
+|*| **GNUnet Worker** is free software: you can redistribute it and/or modify
+|*| it under the terms of the GNU Affero General Public License as published by
+|*| the Free Software Foundation, either version 3 of the License, or (at your
+|*| option) any later version.
+|*|
+|*| **GNUnet Worker** is distributed in the hope that it will be useful, but
+|*| WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+|*| or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public
+|*| License for more details.
+|*|
+|*| You should have received a copy of the GNU Affero General Public License
+|*| along with this program. If not, see <http://www.gnu.org/licenses/>.
+|*|
+\*/
+
+
+/**
+
+	@file       flight.c
+	@brief      An always-on ring of the last events of every worker, dumped
+	            on demand or when the process crashes
+
+**/
+
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_scheduler_lib.h>
+#include "include/gnunet_worker_lib.h"
+#include "flight.h"
+
+
+/*
+
+Unlike the tracer, the flight recorders cannot be switched off: every worker
+writes its events into a ring of its own (see `flight_record()`) and the rings
+are only read when something goes wrong.
+
+Everything that reads the rings must be async-signal-safe, because the dumps
+are mostly requested from signal handlers: no locks, no `malloc()`, no
+`printf()` -- the text is formatted by hand and written with `write()`.
+
+In a core file the rings can be found by searching for `FLIGHT_RECORDER_MAGIC`
+(e.g. with GDB's `find` command) and printed as `FlightRecorder` structures.
+
+*/
+
+
+
+		/*\
+		|*|
+		|*|     LOCAL ENVIRONMENT
+		|*|    ________________________________
+		\*/
+
+
+
+	/*  CONSTANTS AND VARIABLES  */
+
+
+/**
+
+	@brief      The names of the events of `GNUNET_WORKER_TraceEvent`
+
+**/
+static const char * const EVENT_NAMES[] = {
+	"enqueue",
+	"drain",
+	"start",
+	"finish",
+	"cancel",
+	"state"
+};
+
+
+/**
+
+	@brief      The names of the stages of `GNUNET_WORKER_LifeStage`
+
+**/
+static const char * const STAGE_NAMES[] = {
+	"alive",
+	"says bye",
+	"dying",
+	"zombie",
+	"dead"
+};
+
+
+/**
+
+	@brief      The fatal signals that dump the flight recorders
+
+**/
+static const int FATAL_SIGNALS[] = {
+	SIGSEGV,
+	SIGBUS,
+	SIGILL,
+	SIGFPE,
+	SIGABRT
+};
+
+
+/**
+
+	@brief      The number of members of `FATAL_SIGNALS`
+
+**/
+#define FATAL_SIGNAL_COUNT (sizeof(FATAL_SIGNALS) / sizeof(*FATAL_SIGNALS))
+
+
+/**
+
+	@brief      The actions that were installed for `FATAL_SIGNALS` before
+	            ours, in the same order
+
+**/
+static struct sigaction previous_fatal_actions[FATAL_SIGNAL_COUNT];
+
+
+/**
+
+	@brief      Every flight recorder ever mapped (a lock-free stack)
+
+**/
+static _Atomic(FlightRecorder *) flight_recorders = NULL;
+
+
+/**
+
+	@brief      Where the flight recorders are dumped
+
+**/
+static atomic_int flight_recorder_output = STDERR_FILENO;
+
+
+
+	/*  TYPES  */
+
+
+/**
+
+	@brief      A small text buffer for formatting without `printf()`
+
+**/
+typedef struct DumpLine {
+	size_t
+		length;                     /**< The bytes in `::text` **/
+	char
+		text[192];                  /**< The text **/
+} DumpLine;
+
+
+
+	/*  INLINED FUNCTIONS  */
+
+
+/**
+
+	@brief      Append a string to a line, truncating it if it does not fit
+	@param      line            The line to append to            [NON-NULLABLE]
+	@param      string          The string to append             [NON-NULLABLE]
+
+**/
+static inline void line_append (
+	DumpLine * const line,
+	const char * string
+) {
+	while (*string && line->length < sizeof(line->text)) {
+		line->text[line->length++] = *string++;
+	}
+}
+
+
+/**
+
+	@brief      Append an unsigned number to a line
+	@param      line            The line to append to            [NON-NULLABLE]
+	@param      number          The number to append
+	@param      base            `10` or `16`
+	@param      min_digits      The minimum number of digits (zero-padded)
+
+**/
+static inline void line_append_number (
+	DumpLine * const line,
+	uint64_t number,
+	const unsigned int base,
+	unsigned int min_digits
+) {
+	char digits[24];
+	char * cursor = digits + sizeof(digits);
+	*--cursor = '\0';
+	do {
+		*--cursor = "0123456789abcdef"[number % base];
+		number /= base;
+		if (min_digits) {
+			min_digits--;
+		}
+	} while (number || min_digits);
+	line_append(line, cursor);
+}
+
+
+/**
+
+	@brief      Append a timestamp in seconds with microsecond precision
+	@param      line            The line to append to            [NON-NULLABLE]
+	@param      nanoseconds     The timestamp, in nanoseconds
+
+**/
+static inline void line_append_time (
+	DumpLine * const line,
+	const uint64_t nanoseconds
+) {
+	line_append_number(line, nanoseconds / 1000000000, 10, 1);
+	line_append(line, ".");
+	line_append_number(line, nanoseconds % 1000000000 / 1000, 10, 6);
+}
+
+
+/**
+
+	@brief      Append an address to a line
+	@param      line            The line to append to            [NON-NULLABLE]
+	@param      address         The address to append
+
+**/
+static inline void line_append_address (
+	DumpLine * const line,
+	const uintptr_t address
+) {
+	line_append(line, "0x");
+	line_append_number(line, address, 16, 1);
+}
+
+
+/**
+
+	@brief      Write a line to a file descriptor and empty it
+	@param      line            The line to write                [NON-NULLABLE]
+	@param      fd              The file descriptor to write to
+
+	Write errors are ignored: there is nobody left to report them to.
+
+**/
+static inline void line_write (
+	DumpLine * const line,
+	const int fd
+) {
+	size_t written = 0;
+	ssize_t chunk;
+	if (line->length == sizeof(line->text)) {
+		line->text[line->length - 1] = '\n';
+	} else {
+		line->text[line->length++] = '\n';
+	}
+	while (written < line->length) {
+		chunk = write(fd, line->text + written, line->length - written);
+		if (chunk < 0 && errno == EINTR) {
+			continue;
+		}
+		if (chunk <= 0) {
+			break;
+		}
+		written += chunk;
+	}
+	line->length = 0;
+}
+
+
+/**
+
+	@brief      Get the name of an entry of a table, or a fallback
+	@param      table           The table                        [NON-NULLABLE]
+	@param      table_size      The number of entries in @p table
+	@param      index           The entry to look up
+	@return     The name
+
+**/
+static inline const char * table_name (
+	const char * const * const table,
+	const size_t table_size,
+	const unsigned int index
+) {
+	return index < table_size ? table[index] : "unknown";
+}
+
+
+
+	/*  FUNCTIONS  */
+
+
+/**
+
+	@brief      Dump all the flight recorders, then hand a fatal signal over to
+	            the action that was installed before ours
+	@param      signum          The signal
+	@param      info            Information about the signal
+	@param      context         The interrupted context
+
+	The previous action is restored first, so that whatever happens next (and
+	any further delivery of the signal) is up to it. A previous handler is
+	invoked directly, with the original information about the signal (crash
+	reporters and sanitizers need it); otherwise the signal is raised again
+	and its default action takes place.
+
+**/
+static void flight_recorder_fatal_handler (
+	const int signum,
+	siginfo_t * const info,
+	void * const context
+) {
+
+	const int saved_errno = errno;
+	size_t idx = 0;
+
+	GNUNET_WORKER_dump_flight_recorders(
+		atomic_load_explicit(&flight_recorder_output, memory_order_relaxed)
+	);
+
+	while (idx < FATAL_SIGNAL_COUNT && FATAL_SIGNALS[idx] != signum) {
+
+		idx++;
+
+	}
+
+	if (idx == FATAL_SIGNAL_COUNT) {
+
+		raise(signum);
+		return;
+
+	}
+
+	const struct sigaction * const previous = previous_fatal_actions + idx;
+
+	sigaction(signum, previous, NULL);
+	errno = saved_errno;
+
+	if (previous->sa_flags & SA_SIGINFO) {
+
+		previous->sa_sigaction(signum, info, context);
+
+	} else if (
+		previous->sa_handler != SIG_DFL &&
+		previous->sa_handler != SIG_IGN
+	) {
+
+		previous->sa_handler(signum);
+
+	} else {
+
+		raise(signum);
+
+	}
+
+}
+
+
+/**
+
+	@brief      Dump all the flight recorders on demand
+	@param      signum          The signal (unused)
+
+**/
+static void flight_recorder_dump_handler (
+	const int signum
+) {
+
+	const int saved_errno = errno;
+
+	GNUNET_WORKER_dump_flight_recorders(
+		atomic_load_explicit(&flight_recorder_output, memory_order_relaxed)
+	);
+
+	errno = saved_errno;
+
+}
+
+
+
+		/*\
+		|*|
+		|*|     SHARED ENVIRONMENT
+		|*|    ________________________________
+		\*/
+
+
+
+	/*  Please see `flight.h` for the complete documentation  */
+
+
+/**
+
+	@brief      Get a flight recorder for a new worker
+
+*/
+FlightRecorder * GNUNET_WORKER_flight_recorder_open (
+	const GNUNET_WORKER_Handle worker
+) {
+
+	FlightRecorder * recorder;
+	bool expected;
+
+	for (
+		recorder = atomic_load_explicit(&flight_recorders, memory_order_acquire);
+		recorder;
+		recorder = recorder->next
+	) {
+
+		expected = false;
+
+		if (
+			!atomic_load_explicit(&recorder->in_use, memory_order_relaxed) &&
+			atomic_compare_exchange_strong_explicit(
+				&recorder->in_use,
+				&expected,
+				true,
+				memory_order_acquire,
+				memory_order_relaxed
+			)
+		) {
+
+			goto take_over;
+
+		}
+
+	}
+
+	recorder = mmap(
+		NULL,
+		sizeof(FlightRecorder),
+		PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS,
+		-1,
+		0
+	);
+
+	if (recorder == MAP_FAILED) {
+
+		return NULL;
+
+	}
+
+	/*  The mapping is zero-filled  */
+
+	memcpy(recorder->magic, FLIGHT_RECORDER_MAGIC, sizeof(FLIGHT_RECORDER_MAGIC));
+	atomic_init(&recorder->in_use, true);
+	recorder->next = atomic_load_explicit(&flight_recorders, memory_order_relaxed);
+
+	while (
+		!atomic_compare_exchange_weak_explicit(
+			&flight_recorders,
+			&recorder->next,
+			recorder,
+			memory_order_release,
+			memory_order_relaxed
+		)
+	);
+
+
+	/* \                                 /\
+	\ */     take_over:                 /* \
+	 \/     _______________________     \ */
+
+
+	/*  Events of the previous owner must not be attributed to the new one  */
+
+	for (size_t idx = 0; idx < FLIGHT_RECORDER_SIZE; idx++) {
+
+		atomic_store_explicit(
+			&recorder->events[idx].timestamp,
+			0,
+			memory_order_relaxed
+		);
+
+	}
+
+	atomic_store_explicit(&recorder->head, 0, memory_order_relaxed);
+	atomic_store_explicit(&recorder->worker, worker, memory_order_relaxed);
+	return recorder;
+
+}
+
+
+/**
+
+	@brief      Release the flight recorder of a worker that is being freed
+
+*/
+void GNUNET_WORKER_flight_recorder_close (
+	FlightRecorder * const recorder
+) {
+
+	atomic_store_explicit(&recorder->in_use, false, memory_order_release);
+
+}
+
+
+/**
+
+	@brief      Dump a flight recorder as text (async-signal-safe)
+
+*/
+void GNUNET_WORKER_flight_recorder_dump (
+	const FlightRecorder * const recorder,
+	const int fd
+) {
+
+	DumpLine line = { .length = 0 };
+	struct timespec now;
+	const size_t head =
+		atomic_load_explicit(&recorder->head, memory_order_relaxed);
+	const bool in_use =
+		atomic_load_explicit(&recorder->in_use, memory_order_relaxed);
+
+	clock_gettime(FLIGHT_RECORDER_CLOCK, &now);
+	line_append(&line, "gnunet-worker flight recorder: worker ");
+
+	line_append_address(
+		&line,
+		(uintptr_t) atomic_load_explicit(&recorder->worker, memory_order_relaxed)
+	);
+
+	line_append(&line, in_use ? " (alive), " : " (freed), ");
+	line_append_number(&line, head, 10, 1);
+	line_append(&line, " events, now ");
+
+	line_append_time(
+		&line,
+		(uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec
+	);
+
+	line_write(&line, fd);
+
+	for (
+		size_t idx = head > FLIGHT_RECORDER_SIZE ? head - FLIGHT_RECORDER_SIZE : 0;
+		idx < head;
+		idx++
+	) {
+
+		const FlightEvent * const slot =
+			recorder->events + (idx & (FLIGHT_RECORDER_SIZE - 1));
+
+		const uint64_t timestamp =
+			atomic_load_explicit(&slot->timestamp, memory_order_relaxed);
+
+		const unsigned int event =
+			atomic_load_explicit(&slot->event, memory_order_relaxed);
+
+		const unsigned int detail =
+			atomic_load_explicit(&slot->detail, memory_order_relaxed);
+
+		/*  Reserved by a thread that has not filled it yet  */
+
+		if (!timestamp) {
+
+			continue;
+
+		}
+
+		line_append(&line, "  ");
+		line_append_time(&line, timestamp);
+		line_append(&line, " ");
+
+		line_append(
+			&line,
+			table_name(
+				EVENT_NAMES,
+				sizeof(EVENT_NAMES) / sizeof(*EVENT_NAMES),
+				event
+			)
+		);
+
+		switch (event) {
+
+			case GNUNET_WORKER_TRACE_DRAIN:
+
+				line_append(&line, " jobs ");
+				line_append_number(&line, detail, 10, 1);
+				break;
+
+			case GNUNET_WORKER_TRACE_STATE:
+
+				line_append(&line, " ");
+
+				line_append(
+					&line,
+					table_name(
+						STAGE_NAMES,
+						sizeof(STAGE_NAMES) / sizeof(*STAGE_NAMES),
+						detail
+					)
+				);
+
+				break;
+
+			default:
+
+				line_append(&line, " routine ");
+
+				line_append_address(
+					&line,
+					atomic_load_explicit(&slot->routine, memory_order_relaxed)
+				);
+
+				line_append(&line, " data ");
+
+				line_append_address(
+					&line,
+					atomic_load_explicit(&slot->data, memory_order_relaxed)
+				);
+
+				line_append(&line, " priority ");
+				line_append_number(&line, detail, 10, 1);
+
+		}
+
+		line_write(&line, fd);
+
+	}
+
+}
+
+
+/**
+
+	@brief      Get the file descriptor where the flight recorders are dumped
+	            (async-signal-safe)
+
+*/
+int GNUNET_WORKER_flight_recorder_fd (void) {
+
+	return atomic_load_explicit(&flight_recorder_output, memory_order_relaxed);
+
+}
+
+
+
+		/*\
+		|*|
+		|*|     GLOBAL ENVIRONMENT
+		|*|    ________________________________
+		\*/
+
+
+
+	/*  Please see the public header for the complete documentation  */
+
+
+/**
+
+	@brief      Dump the flight recorders of all the workers (async-signal-safe)
+
+*/
+void GNUNET_WORKER_dump_flight_recorders (
+	const int fd
+) {
+
+	for (
+		const FlightRecorder * recorder =
+			atomic_load_explicit(&flight_recorders, memory_order_acquire);
+		recorder;
+		recorder = recorder->next
+	) {
+
+		GNUNET_WORKER_flight_recorder_dump(recorder, fd);
+
+	}
+
+}
+
+
+/**
+
+	@brief      Dump the flight recorders when the process receives a signal
+
+*/
+bool GNUNET_WORKER_install_flight_recorder_dump (
+	const int fd,
+	const int dump_signal
+) {
+
+	struct sigaction action, dump_rollback, rollback[FATAL_SIGNAL_COUNT];
+	size_t idx;
+
+	atomic_store_explicit(&flight_recorder_output, fd, memory_order_relaxed);
+	memset(&action, 0, sizeof(action));
+	sigemptyset(&action.sa_mask);
+
+	if (dump_signal) {
+
+		action.sa_handler = &flight_recorder_dump_handler;
+		action.sa_flags = SA_RESTART;
+
+		if (sigaction(dump_signal, &action, &dump_rollback)) {
+
+			return false;
+
+		}
+
+	}
+
+	action.sa_sigaction = &flight_recorder_fatal_handler;
+	action.sa_flags = SA_SIGINFO | SA_RESETHAND | SA_NODEFER;
+
+	for (idx = 0; idx < FATAL_SIGNAL_COUNT; idx++) {
+
+		if (sigaction(FATAL_SIGNALS[idx], &action, rollback + idx)) {
+
+			goto roll_back_and_fail;
+
+		}
+
+		/*  When invoked twice we must not chain our handler to itself  */
+
+		if (
+			!(rollback[idx].sa_flags & SA_SIGINFO) ||
+			rollback[idx].sa_sigaction != &flight_recorder_fatal_handler
+		) {
+
+			previous_fatal_actions[idx] = rollback[idx];
+
+		}
+
+	}
+
+	return true;
+
+
+	/* \                                 /\
+	\ */     roll_back_and_fail:        /* \
+	 \/     _______________________     \ */
+
+
+	while (idx--) {
+
+		sigaction(FATAL_SIGNALS[idx], rollback + idx, NULL);
+
+	}
+
+	if (dump_signal) {
+
+		sigaction(dump_signal, &dump_rollback, NULL);
+
+	}
+
+	return false;
+
+}
+
+
+/*  EOF  */
+
@@ -0,0 +1,240 @@
+/*  -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4 -*-  */
+
+/*\
+|*|
+|*| libgnunetworker/src/flight.h
+|*|
+|*| https://github.com/madmurphy/libgnunetworker
+|*|
+|*| Copyright (C) 2022 madmurphy <madmurphy333@gmail.com>
+|*|
+|*| **GNUnet Worker** is free software: you can redistribute it and/or modify
+|*| it under the terms of the GNU Affero General Public License as published by
+|*| the Free Software Foundation, either version 3 of the License, or (at your
+|*| option) any later version.
+|*|
+|*| **GNUnet Worker** is distributed in the hope that it will be useful, but
+|*| WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+|*| or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public
+|*| License for more details.
+|*|
+|*| You should have received a copy of the GNU Affero General Public License
+|*| along with this program. If not, see <http://www.gnu.org/licenses/>.
+|*|
+\*/
+
+
+/**
+
+    @file       flight.h
+    @brief      GNUnet Worker flight recorder private header
+
+**/
+
+
+#ifndef __GNUNET_WORKER_FLIGHT_PRIVATE_HEADER__
+#define __GNUNET_WORKER_FLIGHT_PRIVATE_HEADER__
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "include/gnunet_worker_lib.h"
+
+
+/**
+
+    @brief      The number of events every flight recorder remembers (must be
+                a power of two)
+
+**/
+#define FLIGHT_RECORDER_SIZE 1024
+
+
+/**
+
+    @brief      The string every flight recorder begins with, for finding the
+                recorders in a core file
+
+**/
+#define FLIGHT_RECORDER_MAGIC "GNUNET_WORKER_FLIGHT_RECORDER"
+
+
+/**
+
+    @brief      The clock of the flight recorders
+
+    The coarse clock costs a fraction of the precise one (and has a resolution
+    of a few milliseconds), which is enough for telling what a worker was
+    doing when it got stuck.
+
+**/
+#ifdef CLOCK_MONOTONIC_COARSE
+#define FLIGHT_RECORDER_CLOCK CLOCK_MONOTONIC_COARSE
+#else
+#define FLIGHT_RECORDER_CLOCK CLOCK_MONOTONIC
+#endif
+
+
+_Static_assert(
+    !(FLIGHT_RECORDER_SIZE & (FLIGHT_RECORDER_SIZE - 1)),
+    "FLIGHT_RECORDER_SIZE must be a power of two"
+);
+
+
+/**
+
+    @brief      One event remembered by a flight recorder
+
+    The fields are written with relaxed atomic stores (plain stores on most
+    CPUs), so that a dump can read them while the worker is running; an event
+    that is being overwritten might thus appear torn in a dump.
+
+**/
+typedef struct FlightEvent {
+    atomic_uint_fast64_t
+        timestamp;                  /**< Atomic; `FLIGHT_RECORDER_CLOCK`, in
+                                         nanoseconds **/
+    atomic_uintptr_t
+        routine,                    /**< Atomic; the job's routine **/
+        data;                       /**< Atomic; the job's data **/
+    atomic_uint
+        event,                      /**< Atomic; a `GNUNET_WORKER_TraceEvent`
+                                         **/
+        detail;                     /**< Atomic; the job's priority, the
+                                         number of jobs collected
+                                         (`GNUNET_WORKER_TRACE_DRAIN`) or the
+                                         new stage (`GNUNET_WORKER_TRACE_STATE`)
+                                         **/
+} FlightEvent;
+
+
+/**
+
+    @brief      The ring of the last events of a worker
+
+    Every recorder is an anonymous memory mapping of its own, which core files
+    include by default. Recorders are never unmapped: when a worker is freed its
+    recorder is released and later reused by a new worker, so that a dump can
+    never touch unmapped memory.
+
+**/
+typedef struct FlightRecorder {
+    char
+        magic[32];                  /**< `FLIGHT_RECORDER_MAGIC` **/
+    struct FlightRecorder
+        * next;                     /**< The next recorder of the process **/
+    _Atomic(GNUNET_WORKER_Handle)
+        worker;                     /**< Atomic; the worker that is using the
+                                         recorder, or the last one that has
+                                         used it **/
+    atomic_bool
+        in_use;                     /**< Atomic; a worker is using the
+                                         recorder **/
+    atomic_size_t
+        head;                       /**< Atomic; the number of events ever
+                                         recorded **/
+    FlightEvent
+        events[FLIGHT_RECORDER_SIZE];   /**< The ring **/
+} FlightRecorder;
+
+
+/**
+
+    @brief      Remember an event
+    @param      recorder        The recorder to write to         [NON-NULLABLE]
+    @param      event           The event
+    @param      routine         The job's routine                    [NULLABLE]
+    @param      data            The job's data                       [NULLABLE]
+    @param      detail          See `FlightEvent::detail`
+
+    Events can be recorded by any thread: an uncontended atomic increment
+    reserves the slot, then five stores and a coarse clock reading fill it.
+
+**/
+static inline void flight_record (
+    FlightRecorder * const recorder,
+    const GNUNET_WORKER_TraceEvent event,
+    const GNUNET_CallbackRoutine routine,
+    void * const data,
+    const unsigned int detail
+) {
+    struct timespec now;
+    FlightEvent * const slot =
+        recorder->events + (
+            atomic_fetch_add_explicit(&recorder->head, 1, memory_order_relaxed) &
+            (FLIGHT_RECORDER_SIZE - 1)
+        );
+    clock_gettime(FLIGHT_RECORDER_CLOCK, &now);
+    atomic_store_explicit(
+        &slot->timestamp,
+        (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec,
+        memory_order_relaxed
+    );
+    atomic_store_explicit(
+        &slot->routine,
+        (uintptr_t) routine,
+        memory_order_relaxed
+    );
+    atomic_store_explicit(&slot->data, (uintptr_t) data, memory_order_relaxed);
+    atomic_store_explicit(&slot->event, event, memory_order_relaxed);
+    atomic_store_explicit(&slot->detail, detail, memory_order_relaxed);
+}
+
+
+/**
+
+    @brief      Get a flight recorder for a new worker
+    @param      worker          The worker that needs it         [NON-NULLABLE]
+    @return     The recorder, or `NULL` if no memory is available
+
+**/
+extern FlightRecorder * GNUNET_WORKER_flight_recorder_open (
+    const GNUNET_WORKER_Handle worker
+);
+
+
+/**
+
+    @brief      Release the flight recorder of a worker that is being freed
+    @param      recorder        The recorder to release          [NON-NULLABLE]
+
+    The events stay readable until a new worker takes the recorder over.
+
+**/
+extern void GNUNET_WORKER_flight_recorder_close (
+    FlightRecorder * const recorder
+);
+
+
+/**
+
+    @brief      Dump a flight recorder as text (async-signal-safe)
+    @param      recorder        The recorder to dump             [NON-NULLABLE]
+    @param      fd              The file descriptor to write to
+
+**/
+extern void GNUNET_WORKER_flight_recorder_dump (
+    const FlightRecorder * const recorder,
+    const int fd
+);
+
+
+/**
+
+    @brief      Get the file descriptor where the flight recorders are dumped
+                (async-signal-safe)
+    @return     The file descriptor passed to
+                `GNUNET_WORKER_install_flight_recorder_dump()`, or
+                `STDERR_FILENO`
+
+**/
+extern int GNUNET_WORKER_flight_recorder_fd (void);
+
+
+#endif
+
+
+/*  EOF  */
+
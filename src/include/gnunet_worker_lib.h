@@ -37,9 +37,12 @@
 
 
 #include <time.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include <gnunet/platform.h>
 #include <gnunet/gnunet_common.h>
+#include <gnunet/gnunet_time_lib.h>
 
 
 #ifdef __cplusplus
@@ -66,6 +69,10 @@ enum GNUNET_WORKER_ErrNo {
     GNUNET_WORKER_ERR_ALREADY_SERVING = 3,  /**< A worker thread is attempting
                                                  to redefine itself **/
     GNUNET_WORKER_ERR_INVALID_TIME = 4,     /**< Time is invalid **/
+    GNUNET_WORKER_ERR_JOB_QUEUED = 13,      /**< The job node is still owned
+                                                 by a worker **/
+    GNUNET_WORKER_ERR_INVALID_PRIORITY = 14,    /**< The priority is out of
+                                                     range **/
 
     /*  Errors that cannot be fixed (life is hard)  */
     GNUNET_WORKER_ERR_EXPIRED = 5,          /**< Time has expired **/
@@ -77,6 +84,10 @@ enum GNUNET_WORKER_ErrNo {
     GNUNET_WORKER_ERR_SIGNAL = 9,           /**< Error in the communication
                                                  with the worker **/
     GNUNET_WORKER_ERR_UNKNOWN = 10,         /**< Unknown/unexpected error **/
+    GNUNET_WORKER_ERR_QUEUE_FULL = 11,      /**< The worker has reached its
+                                                 capacity **/
+    GNUNET_WORKER_ERR_CANCELLED = 12,       /**< The job was dropped before
+                                                 running **/
 
     /*  Errors that need a change in GNUnet Worker's bad code to be fixed  */
     GNUNET_WORKER_ERR_INTERNAL_BUG = 127    /**< Unexpected error, probably due
@@ -120,6 +131,28 @@ typedef struct GNUNET_WORKER_Instance GNUNET_WORKER_Instance;
 typedef struct GNUNET_WORKER_Instance * GNUNET_WORKER_Handle;
 
 
+/**
+
+    @brief      A checked identifier of a worker
+
+    Unlike a `GNUNET_WORKER_Handle`, an identifier stays harmless after its
+    worker has been freed: the functions that accept identifiers recognize the
+    stale ones and reject them. See `GNUNET_WORKER_get_id()`.
+
+**/
+typedef uint64_t GNUNET_WORKER_Id;
+
+
+/**
+
+    @brief      A ticket for a job pushed into a worker (opaque)
+
+    See `GNUNET_WORKER_push_load_with_ticket()`.
+
+**/
+typedef struct GNUNET_WORKER_JobList * GNUNET_WORKER_Ticket;
+
+
 /**
 
     @brief      Generic callback function
@@ -130,6 +163,334 @@ typedef void (* GNUNET_CallbackRoutine) (
 );
 
 
+/**
+
+    @brief      The number of 64-bit words reserved by a `GNUNET_WORKER_Job`
+
+**/
+#define GNUNET_WORKER_JOB_WORDS 16
+
+
+/**
+
+    @brief      A job node that the caller embeds in its own objects (opaque)
+
+    The size of the structure is fixed, but its content is private. A node must
+    be zero-filled (e.g. with `GNUNET_WORKER_JOB_INIT`, `calloc()` or
+    `memset()`) before it is pushed for the first time; after that it must not
+    be touched until the library hands it back. See
+    `GNUNET_WORKER_push_job()`.
+
+**/
+typedef struct GNUNET_WORKER_Job {
+    union {
+        void * pointer;
+        uint64_t number;
+    } reserved[GNUNET_WORKER_JOB_WORDS];    /**< Private **/
+} GNUNET_WORKER_Job;
+
+
+/**
+
+    @brief      An initializer for a `GNUNET_WORKER_Job` that has never been
+                pushed
+
+**/
+#define GNUNET_WORKER_JOB_INIT { { { NULL } } }
+
+
+/**
+
+    @brief      A function that receives a job node back from a worker
+
+    The first argument is the node that has been handed back, the second one
+    is `true` if the job's routine has run, `false` if the job has been dropped
+    by the shutdown of the worker.
+
+**/
+typedef void (* GNUNET_WORKER_JobCompletion) (
+    GNUNET_WORKER_Job * job,
+    bool has_run
+);
+
+
+/**
+
+    @brief      A job to push into a worker as part of a batch
+
+    See `GNUNET_WORKER_push_load_batch()`.
+
+**/
+typedef struct GNUNET_WORKER_Load {
+    enum GNUNET_SCHEDULER_Priority
+        priority;                   /**< The priority of the job **/
+    GNUNET_CallbackRoutine
+        routine;                    /**< The job's routine [NON-NULLABLE] **/
+    void
+        * data;                     /**< Custom data to pass to the job's
+                                         routine [NULLABLE] **/
+} GNUNET_WORKER_Load;
+
+
+/**
+
+    @brief      A snapshot of the statistics of a worker
+
+    See `GNUNET_WORKER_get_stats()`. All counters start from zero when the
+    worker is created and are never reset.
+
+**/
+typedef struct GNUNET_WORKER_Stats {
+    uint64_t
+        jobs_pushed_locally,        /**< Jobs pushed from the worker thread **/
+        jobs_pushed_remotely,       /**< Jobs pushed from other threads **/
+        jobs_executed,              /**< Jobs whose routine has been invoked **/
+        jobs_dropped,               /**< Jobs freed without running by the
+                                         shutdown **/
+        beeps_sent,                 /**< Notifications written into the
+                                         worker's beep channel **/
+        beeps_received,             /**< Notifications read by the worker
+                                         thread **/
+        beeps_failed,               /**< Notifications that could not be
+                                         written (see
+                                         `GNUNET_WORKER_ERR_SIGNAL`) **/
+        wakeups;                    /**< Times the worker thread has woken up
+                                         for collecting the jobs pushed by
+                                         other threads **/
+    size_t
+        wishlist_length,            /**< Jobs pushed by other threads that the
+                                         worker thread has not collected yet
+                                         **/
+        wishlist_peak,              /**< The largest number of jobs collected
+                                         at once from other threads **/
+        scheduled_length,           /**< Jobs collected by the worker thread
+                                         and not started yet **/
+        scheduled_peak;             /**< The largest value ever reached by
+                                         `::scheduled_length` after a
+                                         collection **/
+} GNUNET_WORKER_Stats;
+
+
+/**
+
+    @brief      The number of buckets of a `GNUNET_WORKER_Histogram`
+
+    Latencies below 32 ns are counted exactly; above that, every power of two
+    is split into 16 linear buckets (the relative error is below 6.25%), up
+    to 2^40 ns (about 18 minutes); longer latencies fall into the last
+    bucket.
+
+**/
+#define GNUNET_WORKER_HISTOGRAM_SIZE 592
+
+
+/**
+
+    @brief      The phases of the life of a job whose latency can be tracked
+
+    See `GNUNET_WORKER_set_latency_tracking()`.
+
+**/
+typedef enum GNUNET_WORKER_LatencyKind {
+    GNUNET_WORKER_LATENCY_PICKUP = 0,   /**< From the push to the moment the
+                                             worker thread collects the job **/
+    GNUNET_WORKER_LATENCY_WAIT = 1,     /**< From the push to the start of the
+                                             job's routine **/
+    GNUNET_WORKER_LATENCY_RUN = 2,      /**< From the start to the end of the
+                                             job's routine **/
+    GNUNET_WORKER_LATENCY_KIND_COUNT = 3    /**< The number of phases **/
+} GNUNET_WORKER_LatencyKind;
+
+
+/**
+
+    @brief      A log-linear histogram of latencies, in nanoseconds
+
+    See `GNUNET_WORKER_get_latency_histogram()`.
+
+**/
+typedef struct GNUNET_WORKER_Histogram {
+    uint64_t
+        counts[GNUNET_WORKER_HISTOGRAM_SIZE],   /**< The buckets **/
+        total,                      /**< The number of samples **/
+        sum,                        /**< The sum of all the samples **/
+        max;                        /**< The largest sample **/
+} GNUNET_WORKER_Histogram;
+
+
+/**
+
+    @brief      What the routine profiler of a worker measures
+
+    See `GNUNET_WORKER_set_routine_profiling()`; the flags can be combined.
+
+**/
+typedef enum GNUNET_WORKER_ProfileFlags {
+    GNUNET_WORKER_PROFILE_OFF = 0,      /**< Nothing: profiling is paused **/
+    GNUNET_WORKER_PROFILE_TIMES = 1,    /**< The calls, the wall time and the
+                                             CPU time of every routine **/
+    GNUNET_WORKER_PROFILE_HARDWARE = 2  /**< The calls and the CPU cycles and
+                                             instructions of every routine,
+                                             via the hardware counters **/
+} GNUNET_WORKER_ProfileFlags;
+
+
+/**
+
+    @brief      The resources spent by the worker thread in one routine
+
+    See `GNUNET_WORKER_get_routine_profile()`. Times are in nanoseconds.
+
+**/
+typedef struct GNUNET_WORKER_RoutineProfile {
+    GNUNET_CallbackRoutine
+        routine;                    /**< The routine, or `NULL` for all the
+                                         routines that did not fit in the
+                                         profile **/
+    uint64_t
+        calls,                      /**< The number of calls measured **/
+        wall_time,                  /**< The time elapsed in the routine **/
+        cpu_time,                   /**< The CPU time used by the worker
+                                         thread in the routine **/
+        cycles,                     /**< The CPU cycles spent in the routine
+                                         (user space only) **/
+        instructions;               /**< The instructions retired in the
+                                         routine (user space only) **/
+} GNUNET_WORKER_RoutineProfile;
+
+
+/**
+
+    @brief      The events reported to a `GNUNET_WORKER_Tracer`
+
+**/
+typedef enum GNUNET_WORKER_TraceEvent {
+    GNUNET_WORKER_TRACE_ENQUEUE = 0,    /**< A job has been pushed **/
+    GNUNET_WORKER_TRACE_DRAIN = 1,      /**< The worker thread has collected
+                                             the jobs pushed by other threads
+                                             **/
+    GNUNET_WORKER_TRACE_START = 2,      /**< A job's routine is about to be
+                                             invoked **/
+    GNUNET_WORKER_TRACE_FINISH = 3,     /**< A job's routine has returned **/
+    GNUNET_WORKER_TRACE_CANCEL = 4,     /**< A job will never run (it has been
+                                             cancelled via its ticket or
+                                             dropped by the shutdown) **/
+    GNUNET_WORKER_TRACE_STATE = 5       /**< The worker has entered a new
+                                             stage of its life **/
+} GNUNET_WORKER_TraceEvent;
+
+
+/**
+
+    @brief      The stages of the life of a worker, in the order in which they
+                are entered
+
+**/
+typedef enum GNUNET_WORKER_LifeStage {
+    GNUNET_WORKER_STAGE_ALIVE = 0,      /**< The worker is alive and well **/
+    GNUNET_WORKER_STAGE_SAYS_BYE = 1,   /**< The worker is calling its
+                                             `on_worker_end` routine **/
+    GNUNET_WORKER_STAGE_DYING = 2,      /**< The worker is shutting down **/
+    GNUNET_WORKER_STAGE_ZOMBIE = 3,     /**< The worker is unable to die (its
+                                             beep channel is down) **/
+    GNUNET_WORKER_STAGE_DEAD = 4        /**< The worker is dead and about to
+                                             be disposed **/
+} GNUNET_WORKER_LifeStage;
+
+
+/**
+
+    @brief      The description of an event passed to a `GNUNET_WORKER_Tracer`
+
+    Jobs pushed via `GNUNET_WORKER_call()` and `GNUNET_WORKER_timedcall()` are
+    reported with a routine and data that belong to the library.
+
+**/
+typedef struct GNUNET_WORKER_TraceRecord {
+    GNUNET_WORKER_Handle
+        worker;                     /**< The worker concerned; after
+                                         `GNUNET_WORKER_TRACE_FINISH` and
+                                         `GNUNET_WORKER_STAGE_DEAD` it is
+                                         only an identifier, since it might
+                                         have been destroyed already **/
+    GNUNET_WORKER_TraceEvent
+        event;                      /**< What has happened **/
+    const void
+        * job;                      /**< An opaque identifier of the job,
+                                         unique among the jobs that have not
+                                         finished or been cancelled yet
+                                         (`NULL` for
+                                         `GNUNET_WORKER_TRACE_DRAIN` and
+                                         `GNUNET_WORKER_TRACE_STATE`) **/
+    GNUNET_CallbackRoutine
+        routine;                    /**< The job's routine (`NULL` for
+                                         `GNUNET_WORKER_TRACE_DRAIN` and
+                                         `GNUNET_WORKER_TRACE_STATE`) **/
+    void
+        * data;                     /**< The job's data (`NULL` for
+                                         `GNUNET_WORKER_TRACE_DRAIN` and
+                                         `GNUNET_WORKER_TRACE_STATE`) **/
+    uint64_t
+        timestamp,                  /**< The monotonic clock
+                                         (`CLOCK_MONOTONIC`), in nanoseconds;
+                                         for `GNUNET_WORKER_TRACE_DRAIN` the
+                                         moment the collection began **/
+        duration;                   /**< How long the collection has taken,
+                                         in nanoseconds
+                                         (`GNUNET_WORKER_TRACE_DRAIN` only)
+                                         **/
+    enum GNUNET_SCHEDULER_Priority
+        priority;                   /**< The job's priority **/
+    size_t
+        job_count;                  /**< The number of jobs collected
+                                         (`GNUNET_WORKER_TRACE_DRAIN` only)
+                                         **/
+    GNUNET_WORKER_LifeStage
+        stage;                      /**< The stage just entered
+                                         (`GNUNET_WORKER_TRACE_STATE` only) **/
+    bool
+        rerun;                      /**< The job is a periodic job that has
+                                         already run, so no
+                                         `GNUNET_WORKER_TRACE_ENQUEUE` precedes
+                                         this event
+                                         (`GNUNET_WORKER_TRACE_START` and
+                                         `GNUNET_WORKER_TRACE_CANCEL` only)
+                                         **/
+} GNUNET_WORKER_TraceRecord;
+
+
+/**
+
+    @brief      A callback that receives the lifecycle events of all the
+                workers
+
+    See `GNUNET_WORKER_set_tracer()`.
+
+**/
+typedef struct GNUNET_WORKER_Tracer {
+    void (* trace) (
+        const GNUNET_WORKER_TraceRecord * record,
+        void * tracer_data
+    );                              /**< The routine invoked for every event
+                                         [NON-NULLABLE] **/
+    void
+        * data;                     /**< Custom data to pass to `::trace`
+                                         [NULLABLE] **/
+} GNUNET_WORKER_Tracer;
+
+
+/**
+
+    @brief      Callback function that returns a result to the caller
+
+    See `GNUNET_WORKER_call()`.
+
+**/
+typedef void * (* GNUNET_WORKER_CallRoutine) (
+    void * data
+);
+
+
 /**
 
     @brief      Callback function for deciding about a worker's destiny
@@ -392,7 +753,9 @@ extern int GNUNET_WORKER_adopt_running_scheduler (
     @param      job_routine     The task to schedule             [NON-NULLABLE]
     @param      job_data        Custom data to pass to the task      [NULLABLE]
     @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
-                `GNUNET_WORKER_ERR_NO_MEMORY`, `GNUNET_WORKER_ERR_SIGNAL` and
+                `GNUNET_WORKER_ERR_NO_MEMORY`, `GNUNET_WORKER_ERR_SIGNAL`,
+                `GNUNET_WORKER_ERR_QUEUE_FULL`,
+                `GNUNET_WORKER_ERR_INVALID_PRIORITY` and
                 `GNUNET_WORKER_ERR_INVALID_HANDLE`
 
     This function is identical to `GNUNET_WORKER_push_load()`, but allows to
@@ -411,7 +774,9 @@ extern int GNUNET_WORKER_adopt_running_scheduler (
     - `GNUNET_SCHEDULER_PRIORITY_SHUTDOWN`
 
     The additional `GNUNET_SCHEDULER_PRIORITY_KEEP` cannot be used in this
-    context.
+    context. `GNUNET_SCHEDULER_PRIORITY_KEEP` and any value that is not listed
+    above make all the functions that accept a priority fail with
+    `GNUNET_WORKER_ERR_INVALID_PRIORITY`.
 
     The functions pushed into the worker thread are free to use all the
     scheduler's utilities (such as `GNUNET_SCHEDULER_add_with_priority()`,
@@ -421,7 +786,18 @@ extern int GNUNET_WORKER_adopt_running_scheduler (
     (i.e., the memory previously allocated for the worker will be destroyed).
 
     A non-zero return value indicates that @p job_routine was not scheduled
-    (the call was no-op and the user may attempt again).
+    (the call was no-op and the user may attempt again), with one exception:
+    if other threads have pushed their jobs on top of this one before it
+    turned out that the worker cannot be woken up, the job stays queued and
+    `GNUNET_WORKER_ERR_SIGNAL` is returned anyway. Such a job runs only if the
+    worker wakes up for some other reason, otherwise it is dropped by the
+    worker's shutdown. Either way the beep channel of the worker is broken.
+
+    A return value of `GNUNET_WORKER_ERR_QUEUE_FULL` can be returned only if a
+    capacity has been set via `GNUNET_WORKER_set_capacity()`, and indicates
+    that the worker has too many pending jobs. See
+    `GNUNET_WORKER_wait_push_load()` for a variant that waits for room
+    instead.
 
 **/
 extern int GNUNET_WORKER_push_load_with_priority (
@@ -440,7 +816,8 @@ extern int GNUNET_WORKER_push_load_with_priority (
     @param      job_routine     The task to schedule             [NON-NULLABLE]
     @param      job_data        Custom data to pass to the task      [NULLABLE]
     @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
-                `GNUNET_WORKER_ERR_NO_MEMORY`, `GNUNET_WORKER_ERR_SIGNAL` and
+                `GNUNET_WORKER_ERR_NO_MEMORY`, `GNUNET_WORKER_ERR_SIGNAL`,
+                `GNUNET_WORKER_ERR_QUEUE_FULL` and
                 `GNUNET_WORKER_ERR_INVALID_HANDLE`
 
     Use this routine every time you want to run a function in a worker thread.
@@ -470,7 +847,8 @@ extern int GNUNET_WORKER_push_load_with_priority (
     that does not use a worker's address after this has been destroyed. Please
     have a look at the documentation of either `GNUNET_WORKER_start_serving()`,
     `GNUNET_WORKER_create()` or `GNUNET_WORKER_adopt_running_scheduler()` for
-    more information on how to avoid that his happens.
+    more information on how to avoid that his happens, or use
+    `GNUNET_WORKER_push_load_by_id()` instead.
 
 **/
 static inline int GNUNET_WORKER_push_load (
@@ -489,150 +867,623 @@ static inline int GNUNET_WORKER_push_load (
 
 /**
 
-    @brief      Terminate a worker and free its memory, without waiting for the
-                scheduler to return -- this will be completed in parallel
-                (asynchronous)
-    @param      worker          The worker to destroy            [NON-NULLABLE]
+    @brief      Schedule a batch of new functions for the worker, atomically
+    @param      worker          The worker for which the tasks must be
+                                scheduled                        [NON-NULLABLE]
+    @param      jobs            An array of jobs to schedule     [NON-NULLABLE]
+    @param      job_count       The number of members in @p jobs
     @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
-                `GNUNET_WORKER_ERR_DOUBLE_FREE` and `GNUNET_WORKER_ERR_SIGNAL`
+                `GNUNET_WORKER_ERR_NO_MEMORY`, `GNUNET_WORKER_ERR_SIGNAL`,
+                `GNUNET_WORKER_ERR_QUEUE_FULL` and
+                `GNUNET_WORKER_ERR_INVALID_HANDLE`
 
-    This function is used to launch `GNUNET_SCHEDULER_shutdown()` in the worker
-    thread, without waiting for the scheduler to return.
+    This function is equivalent to invoking
+    `GNUNET_WORKER_push_load_with_priority()` once for each member of @p jobs,
+    in the same order, but the batch is handed over to the worker as a whole:
+    the worker is notified at most once and will never see only a part of it.
+    Jobs are scheduled in the order in which they appear in @p jobs.
 
-    Functions already scheduled via `GNUNET_WORKER_push_load()` that had no
-    time to be invoked will be immediately cancelled. If the user had passed an
-    `on_worker_end` routine during the creation of the worker, this will be
-    launched now.
+    Pushing bursts of many small jobs this way is much cheaper than pushing
+    them one by one.
 
-    This function can be invoked by any thread (including the worker thread as
-    well). Directly launching `GNUNET_SCHEDULER_shutdown()` from the worker
-    thread will have identical effects to launching this function from any
-    other thread (i.e., the memory previously allocated for the worker will be
-    destroyed).
+    The status is all-or-nothing: a non-zero return value indicates that none
+    of the jobs was scheduled (the call was no-op and the user may attempt
+    again), except for the `GNUNET_WORKER_ERR_SIGNAL` case described in
+    `GNUNET_WORKER_push_load_with_priority()`, in which the whole batch stays
+    queued. If @p job_count is zero the function does nothing and returns
+    `GNUNET_WORKER_SUCCESS`.
 
-    A return value of `GNUNET_WORKER_ERR_DOUBLE_FREE` indicates that another
-    thread has already triggered the worker's destruction (this includes having
-    invoked `GNUNET_SCHEDULER_shutdown()` from the scheduler itself). If this
-    happens, the caller's code is in a dangerous position: the next time,
-    instead of a handle in the process of being destroyed, an already destroyed
-    handle might be passed to this function, and that will cause undefined
-    behavior (probably a crash). This error must be handled exactly like a
-    double free or corruption error, and you should always pay attention that
-    no more than one thread can destroy the worker. You must not handle
-    `GNUNET_WORKER_ERR_DOUBLE_FREE` using runtime checks unless you are
-    debugging your program; the way to handle this error is by writing code
-    that does not destroy a worker twice. Please have a look at the
-    documentation of either `GNUNET_WORKER_adopt_running_scheduler()`,
-    `GNUNET_WORKER_start_serving()` or `GNUNET_WORKER_create()` for more
-    information on how to avoid that his happens. It is very likely that this
-    error code will be removed in the future and a call to `exit()` will appear
-    in its place.
+    The @p jobs array is not referenced after this function returns and can
+    be safely reused.
 
-    A value of `GNUNET_WORKER_ERR_SIGNAL` indicates that it was not possible to
-    notify the worker about the shutdown (this error can be thrown only if this
-    function was not invoked from the worker thread). In this case there is not
-    much to do. The return value was caused by an error during `write()` into
-    the worker's pipe. The only way to know whether the worker has received the
-    message or not is by passing an `on_worker_end` routine during the creation
-    of the worker and let it signal about the shutdown happening. If no signal
-    arrives it is possible to try and wake up the worker for the shutdown by
-    using `GNUNET_WORKER_ping()` or by invoking this function again. A pipe
-    breaking is a very unlikely event to occur, and it might make sense to
-    ignore completely the possible `GNUNET_WORKER_ERR_SIGNAL` return value,
-    assume that the worker has been destroyed, and tolerate the rare events of
-    workers turned into zombies; or alternatively, it might be a good idea to
-    launch `exit()`, if a worker turns into a zombie.
+    A batch counts as @p job_count jobs against the capacity of the worker (see
+    `GNUNET_WORKER_set_capacity()`): if the worker has no room for all of
+    them `GNUNET_WORKER_ERR_QUEUE_FULL` is returned.
+
+    See `GNUNET_WORKER_push_load()` for the meaning of
+    `GNUNET_WORKER_ERR_INVALID_HANDLE`.
 
 **/
-extern int GNUNET_WORKER_asynch_destroy (
-    const GNUNET_WORKER_Handle worker
+extern int GNUNET_WORKER_push_load_batch (
+    const GNUNET_WORKER_Handle worker,
+    const GNUNET_WORKER_Load * const jobs,
+    const size_t job_count
 );
 
 
 /**
 
-    @brief      Terminate a worker and free its memory, waiting for the
-                scheduler to complete the shutdown (synchronous)
-    @param      worker          The worker to destroy            [NON-NULLABLE]
+    @brief      Schedule a new function for the worker, with a priority, only
+                if the worker has room for it
+    @param      worker          The worker for which the task must be scheduled
+                                                                 [NON-NULLABLE]
+    @param      job_priority    The priority of the task
+    @param      job_routine     The task to schedule             [NON-NULLABLE]
+    @param      job_data        Custom data to pass to the task      [NULLABLE]
     @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
-                `GNUNET_WORKER_ERR_DOUBLE_FREE`, `GNUNET_WORKER_ERR_UNKNOWN`
-                `GNUNET_WORKER_ERR_NOT_ALONE`, `GNUNET_WORKER_ERR_SIGNAL` and
-                `GNUNET_WORKER_ERR_INTERNAL_BUG`
+                `GNUNET_WORKER_ERR_NO_MEMORY`, `GNUNET_WORKER_ERR_SIGNAL`,
+                `GNUNET_WORKER_ERR_QUEUE_FULL` and
+                `GNUNET_WORKER_ERR_INVALID_HANDLE`
 
-    This function is used to launch `GNUNET_SCHEDULER_shutdown()` in the worker
-    thread, waiting for the scheduler to return.
+    This function never blocks: if the worker has reached its capacity (see
+    `GNUNET_WORKER_set_capacity()`) it fails immediately with
+    `GNUNET_WORKER_ERR_QUEUE_FULL`. It is identical to
+    `GNUNET_WORKER_push_load_with_priority()`, and exists for making the
+    intention explicit next to `GNUNET_WORKER_wait_push_load()` and
+    `GNUNET_WORKER_timedwait_push_load()`.
 
-    Functions already scheduled via `GNUNET_WORKER_push_load()` that had no
-    time to be invoked will be immediately cancelled. If the user had passed an
-    `on_worker_end` routine during the creation of the worker, this will be
-    launched now.
+**/
+static inline int GNUNET_WORKER_try_push_load (
+    const GNUNET_WORKER_Handle worker,
+    const enum GNUNET_SCHEDULER_Priority job_priority,
+    const GNUNET_CallbackRoutine job_routine,
+    void * const job_data
+) {
+    return GNUNET_WORKER_push_load_with_priority(
+        worker,
+        job_priority,
+        job_routine,
+        job_data
+    );
+}
 
-    This function can be invoked by any thread (including the worker thread as
-    well). Directly launching `GNUNET_SCHEDULER_shutdown()` from the worker
-    thread will have identical effects to launching this function from any
-    other thread (i.e., the memory previously allocated for the worker will be
-    destroyed).
 
-    Any return value different than `GNUNET_WORKER_ERR_SIGNAL` indicate that
-    the scheduler will eventually shut down. However only zero grants that the
-    scheduler is not running anymore when this function returns. In fact, any
-    error code different than zero makes this function behave like
-    `GNUNET_WORKER_asynch_destroy()`.
+/**
 
-    A return value of `GNUNET_WORKER_ERR_DOUBLE_FREE` indicates that another
-    thread has already triggered the worker's destruction (this includes having
-    invoked `GNUNET_SCHEDULER_shutdown()` from the scheduler itself). If this
-    happens, the caller's code is in a dangerous position: the next time,
-    instead of a handle in the process of being destroyed, an already destroyed
-    handle might be passed to this function, and that will cause undefined
-    behavior (probably a crash). This error must be handled exactly like a
-    double free or corruption error, and you should always pay attention that
-    no more than one thread can destroy the worker. You must not handle
-    `GNUNET_WORKER_ERR_DOUBLE_FREE` using runtime checks unless you are
-    debugging your program; the way to handle this error is by writing code
-    that does not destroy a worker twice. Please have a look at the
-    documentation of either `GNUNET_WORKER_adopt_running_scheduler()`,
-    `GNUNET_WORKER_start_serving()` or `GNUNET_WORKER_create()` for more
-    information on how to avoid that his happens. It is very likely that this
-    error code will be removed in the future and a call to `exit()` will appear
-    in its place.
+    @brief      Schedule a new function for the worker, with a priority,
+                waiting for the worker to make room for it if necessary
+    @param      worker          The worker for which the task must be scheduled
+                                                                 [NON-NULLABLE]
+    @param      job_priority    The priority of the task
+    @param      job_routine     The task to schedule             [NON-NULLABLE]
+    @param      job_data        Custom data to pass to the task      [NULLABLE]
+    @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
+                `GNUNET_WORKER_ERR_NO_MEMORY`, `GNUNET_WORKER_ERR_SIGNAL`,
+                `GNUNET_WORKER_ERR_QUEUE_FULL`, `GNUNET_WORKER_ERR_UNKNOWN` and
+                `GNUNET_WORKER_ERR_INVALID_HANDLE`
 
-    A return value of `GNUNET_WORKER_ERR_UNKNOWN` can only be due to a
-    non-standard implementation of the `pthread_join()` and
-    `pthread_cond_wait()` functions currently in use.
+    If the worker has reached its capacity (see `GNUNET_WORKER_set_capacity()`)
+    this function blocks until the worker starts enough pending jobs. This is
+    what gives producers real flow control when the worker cannot keep up.
 
-    A value of `GNUNET_WORKER_ERR_SIGNAL` indicates that it was not possible to
-    notify the worker about the shutdown (this error can be thrown only if this
-    function was not invoked from the worker thread). In this case there is not
-    much to do. The return value was caused by an error during `write()` into
-    the worker's pipe. The only way to know whether the worker has received the
-    message or not is by passing an `on_worker_end` routine during the creation
-    of the worker and let it signal about the shutdown happening. If no signal
-    arrives it is possible to try and wake up the worker for the shutdown by
-    using `GNUNET_WORKER_ping()` or by invoking this function again. A pipe
-    breaking is a very unlikely event to occur, and it might make sense to
-    ignore completely the possible `GNUNET_WORKER_ERR_SIGNAL` return value,
-    assume that the worker has been destroyed, and tolerate the rare events of
-    workers turned into zombies; or alternatively, it might be a good idea to
-    launch `exit()`, if a worker turns into a zombie.
+    When invoked from the worker thread this function never blocks (the worker
+    would wait for itself) and behaves like `GNUNET_WORKER_try_push_load()`.
 
-    A value of `GNUNET_WORKER_ERR_INTERNAL_BUG` should never be returned;
-    please fill a bug report if it happens.
+    If the worker is destroyed while this function is waiting, it returns
+    `GNUNET_WORKER_SUCCESS`: it will appear as if the job was scheduled and
+    then immediately cancelled by the shutdown.
 
 **/
-extern int GNUNET_WORKER_synch_destroy (
-    const GNUNET_WORKER_Handle worker
+extern int GNUNET_WORKER_wait_push_load (
+    const GNUNET_WORKER_Handle worker,
+    const enum GNUNET_SCHEDULER_Priority job_priority,
+    const GNUNET_CallbackRoutine job_routine,
+    void * const job_data
 );
 
 
 /**
 
-    @brief      Terminate a worker and free its memory, waiting for the
-                scheduler to complete the shutdown (synchronous), but only if
-                this happens within a certain time, otherwise it will be
-                completed in parallel (asynchronous)
-    @param      worker          The worker to destroy            [NON-NULLABLE]
-    @param      absolute_time   The absolute time to wait until  [NON-NULLABLE]
+    @brief      Schedule a new function for the worker, with a priority,
+                waiting until a certain time for the worker to make room for it
+                if necessary
+    @param      worker          The worker for which the task must be scheduled
+                                                                 [NON-NULLABLE]
+    @param      job_priority    The priority of the task
+    @param      job_routine     The task to schedule             [NON-NULLABLE]
+    @param      job_data        Custom data to pass to the task      [NULLABLE]
+    @param      absolute_time   The absolute time to wait until  [NON-NULLABLE]
+    @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
+                `GNUNET_WORKER_ERR_NO_MEMORY`, `GNUNET_WORKER_ERR_SIGNAL`,
+                `GNUNET_WORKER_ERR_QUEUE_FULL`, `GNUNET_WORKER_ERR_EXPIRED`,
+                `GNUNET_WORKER_ERR_INVALID_TIME`, `GNUNET_WORKER_ERR_UNKNOWN`
+                and `GNUNET_WORKER_ERR_INVALID_HANDLE`
+
+    This function is identical to `GNUNET_WORKER_wait_push_load()`, but gives
+    up with `GNUNET_WORKER_ERR_EXPIRED` if the worker has not made room for the
+    job by @p absolute_time. Like with `GNUNET_WORKER_timedsynch_destroy()`,
+    @p absolute_time is measured against the `CLOCK_REALTIME` clock.
+
+**/
+extern int GNUNET_WORKER_timedwait_push_load (
+    const GNUNET_WORKER_Handle worker,
+    const enum GNUNET_SCHEDULER_Priority job_priority,
+    const GNUNET_CallbackRoutine job_routine,
+    void * const job_data,
+    const struct timespec * const absolute_time
+);
+
+
+/**
+
+    @brief      Schedule a new function for the worker, with a priority, and
+                get a ticket for cancelling it
+    @param      worker          The worker for which the task must be scheduled
+                                                                 [NON-NULLABLE]
+    @param      job_priority    The priority of the task
+    @param      job_routine     The task to schedule             [NON-NULLABLE]
+    @param      job_data        Custom data to pass to the task      [NULLABLE]
+    @param      save_ticket     A placeholder for storing the job's ticket
+                                                                 [NON-NULLABLE]
+    @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
+                `GNUNET_WORKER_ERR_NO_MEMORY`, `GNUNET_WORKER_ERR_SIGNAL`,
+                `GNUNET_WORKER_ERR_QUEUE_FULL` and
+                `GNUNET_WORKER_ERR_INVALID_HANDLE`
+
+    This function is identical to `GNUNET_WORKER_push_load_with_priority()`,
+    but it also stores in @p save_ticket a ticket that can be later passed to
+    `GNUNET_WORKER_cancel_load()` if the job becomes obsolete before it runs.
+
+    Every ticket must be handed back exactly once, either via
+    `GNUNET_WORKER_cancel_load()` or via `GNUNET_WORKER_release_ticket()`; a
+    ticket keeps a small block of memory alive until then, but it never keeps
+    the worker alive (a ticket can be safely released after its worker has
+    been destroyed).
+
+    If the function fails, or if the worker is shutting down and the job is
+    dropped right away, @p save_ticket is set to `NULL` (both
+    `GNUNET_WORKER_cancel_load()` and `GNUNET_WORKER_release_ticket()` accept
+    `NULL`). The only exception is a `GNUNET_WORKER_ERR_SIGNAL` returned for a
+    job that stays queued (see `GNUNET_WORKER_push_load_with_priority()`):
+    then @p save_ticket is valid and must be handed back as usual.
+
+**/
+extern int GNUNET_WORKER_push_load_with_ticket (
+    const GNUNET_WORKER_Handle worker,
+    const enum GNUNET_SCHEDULER_Priority job_priority,
+    const GNUNET_CallbackRoutine job_routine,
+    void * const job_data,
+    GNUNET_WORKER_Ticket * const save_ticket
+);
+
+
+/**
+
+    @brief      Cancel a job that has not started yet and release its ticket
+    @param      ticket          The ticket of the job to cancel      [NULLABLE]
+    @return     A boolean: `true` if the job has been cancelled and its routine
+                will never be invoked, `false` if the job had already started
+                (or had already been dropped by the worker's shutdown)
+
+    This function can be invoked from any thread, including the worker thread
+    and the job's own routine. A job cancelled before the worker thread has
+    noticed it never reaches the scheduler. When this function is invoked from
+    the worker thread the job is removed from the scheduler at once; otherwise
+    the worker thread is woken up and removes it as soon as it can, so that a
+    job due far in the future (see `GNUNET_WORKER_push_load_at()`) does not
+    keep its room in the capacity of the worker until then.
+
+    A periodic job (see `GNUNET_WORKER_push_load_periodic()`) is stopped even
+    when its routine is running, although `false` is returned in that case.
+
+    The ticket is released in any case and must not be used again.
+
+**/
+extern bool GNUNET_WORKER_cancel_load (
+    const GNUNET_WORKER_Ticket ticket
+);
+
+
+/**
+
+    @brief      Release a ticket without cancelling its job
+    @param      ticket          The ticket to release                [NULLABLE]
+
+    Use this function for jobs that do not need to be cancelled anymore. The
+    ticket must not be used again.
+
+**/
+extern void GNUNET_WORKER_release_ticket (
+    const GNUNET_WORKER_Ticket ticket
+);
+
+
+/**
+
+    @brief      Schedule a new function for the worker, using a job node owned
+                by the caller
+    @param      worker          The worker for which the task must be scheduled
+                                                                 [NON-NULLABLE]
+    @param      job             The job node to push             [NON-NULLABLE]
+    @param      job_priority    The priority of the task
+    @param      job_routine     The task to schedule             [NON-NULLABLE]
+    @param      job_data        Custom data to pass to the task      [NULLABLE]
+    @param      on_job_complete The function that receives @p job back
+                                                                 [NON-NULLABLE]
+    @return     Possible return values are `GNUNET_WORKER_SUCCESS`,
+                `GNUNET_WORKER_ERR_JOB_QUEUED`,
+                `GNUNET_WORKER_ERR_INVALID_HANDLE`,
+                `GNUNET_WORKER_ERR_QUEUE_FULL` and
+                `GNUNET_WORKER_ERR_SIGNAL`
+
+    This function is identical to `GNUNET_WORKER_push_load_with_priority()`,
+    but instead of taking a node from the worker's pool (or from `malloc()`) it
+    links @p job directly, which is meant to be embedded in a long-lived object
+    of the caller. The node is never freed by the library.
+
+    On success the node belongs to the worker until @p on_job_complete is
+    invoked with it: by the worker thread right after @p job_routine has
+    returned, or by the thread that shuts the worker down if the job is
+    dropped (possibly even before this function returns, if the worker is
+    already shutting down). Pushing the node again while it is still owned by
+    a worker fails with `GNUNET_WORKER_ERR_JOB_QUEUED`; from inside
+    @p on_job_complete the node can already be pushed again. On failure the
+    node stays with the caller and @p on_job_complete is not invoked, except
+    when `GNUNET_WORKER_ERR_SIGNAL` is returned for a job that stays queued
+    (see `GNUNET_WORKER_push_load_with_priority()`): then the node still
+    belongs to the worker.
+
+    The object that contains @p job must not be freed by @p job_routine: the
+    completion function is the natural place for doing it.
+
+**/
+extern int GNUNET_WORKER_push_job (
+    const GNUNET_WORKER_Handle worker,
+    GNUNET_WORKER_Job * const job,
+    const enum GNUNET_SCHEDULER_Priority job_priority,
+    const GNUNET_CallbackRoutine job_routine,
+    void * const job_data,
+    const GNUNET_WORKER_JobCompletion on_job_complete
+);
+
+
+/**
+
+    @brief      Schedule a new function for the worker, to be run at a certain
+                time
+    @param      worker          The worker for which the task must be scheduled
+                                                                 [NON-NULLABLE]
+    @param      job_priority    The priority of the task
+    @param      due_time        When the task must run
+    @param      job_routine     The task to schedule             [NON-NULLABLE]
+    @param      job_data        Custom data to pass to the task      [NULLABLE]
+    @param      save_ticket     A placeholder for storing the job's ticket, or
+                                `NULL` if the job will never be cancelled
+                                                                     [NULLABLE]
+    @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
+                `GNUNET_WORKER_ERR_NO_MEMORY`, `GNUNET_WORKER_ERR_SIGNAL`,
+                `GNUNET_WORKER_ERR_QUEUE_FULL` and
+                `GNUNET_WORKER_ERR_INVALID_HANDLE`
+
+    This is the equivalent of `GNUNET_SCHEDULER_add_at_with_priority()` for
+    threads other than the worker thread. The due time travels with the job
+    and the worker thread hands the job directly to the scheduler's timer
+    queue, without any intermediate task. Times already passed make the job
+    run as soon as possible.
+
+    Until it runs, the job counts against the worker's capacity (see
+    `GNUNET_WORKER_set_capacity()`) like any other pending job. If
+    @p save_ticket is not `NULL` the same rules as in
+    `GNUNET_WORKER_push_load_with_ticket()` apply.
+
+**/
+extern int GNUNET_WORKER_push_load_at (
+    const GNUNET_WORKER_Handle worker,
+    const enum GNUNET_SCHEDULER_Priority job_priority,
+    const struct GNUNET_TIME_Absolute due_time,
+    const GNUNET_CallbackRoutine job_routine,
+    void * const job_data,
+    GNUNET_WORKER_Ticket * const save_ticket
+);
+
+
+/**
+
+    @brief      Schedule a new function for the worker, to be run after a delay
+    @param      worker          The worker for which the task must be scheduled
+                                                                 [NON-NULLABLE]
+    @param      job_priority    The priority of the task
+    @param      delay           How long to wait before running the task,
+                                counting from the moment of the push
+    @param      job_routine     The task to schedule             [NON-NULLABLE]
+    @param      job_data        Custom data to pass to the task      [NULLABLE]
+    @param      save_ticket     A placeholder for storing the job's ticket, or
+                                `NULL` if the job will never be cancelled
+                                                                     [NULLABLE]
+    @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
+                `GNUNET_WORKER_ERR_NO_MEMORY`, `GNUNET_WORKER_ERR_SIGNAL`,
+                `GNUNET_WORKER_ERR_QUEUE_FULL` and
+                `GNUNET_WORKER_ERR_INVALID_HANDLE`
+
+    This is the equivalent of `GNUNET_SCHEDULER_add_delayed_with_priority()`
+    for threads other than the worker thread; see
+    `GNUNET_WORKER_push_load_at()`.
+
+**/
+extern int GNUNET_WORKER_push_load_delayed (
+    const GNUNET_WORKER_Handle worker,
+    const enum GNUNET_SCHEDULER_Priority job_priority,
+    const struct GNUNET_TIME_Relative delay,
+    const GNUNET_CallbackRoutine job_routine,
+    void * const job_data,
+    GNUNET_WORKER_Ticket * const save_ticket
+);
+
+
+/**
+
+    @brief      Schedule a function for the worker, to be run periodically
+    @param      worker          The worker for which the task must be scheduled
+                                                                 [NON-NULLABLE]
+    @param      job_priority    The priority of the task
+    @param      period          The interval between two runs of the task (the
+                                first run happens after one interval)
+    @param      job_routine     The task to schedule             [NON-NULLABLE]
+    @param      job_data        Custom data to pass to the task      [NULLABLE]
+    @param      save_ticket     A placeholder for storing the job's ticket
+                                                                 [NON-NULLABLE]
+    @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
+                `GNUNET_WORKER_ERR_NO_MEMORY`, `GNUNET_WORKER_ERR_SIGNAL`,
+                `GNUNET_WORKER_ERR_QUEUE_FULL`,
+                `GNUNET_WORKER_ERR_INVALID_TIME` and
+                `GNUNET_WORKER_ERR_INVALID_HANDLE`
+
+    The task runs every @p period until the job is cancelled via
+    `GNUNET_WORKER_cancel_load()` or the worker shuts down; the same job node
+    is reused across all the runs. Runs are aligned to the first due time:
+    if the worker falls behind by more than one period the missed runs are
+    skipped rather than fired in a row. A zero @p period is rejected with
+    `GNUNET_WORKER_ERR_INVALID_TIME`.
+
+    Cancelling a periodic job while its routine is running returns `false`,
+    but prevents any further run. Releasing its ticket via
+    `GNUNET_WORKER_release_ticket()` instead leaves the job running until the
+    worker shuts down.
+
+**/
+extern int GNUNET_WORKER_push_load_periodic (
+    const GNUNET_WORKER_Handle worker,
+    const enum GNUNET_SCHEDULER_Priority job_priority,
+    const struct GNUNET_TIME_Relative period,
+    const GNUNET_CallbackRoutine job_routine,
+    void * const job_data,
+    GNUNET_WORKER_Ticket * const save_ticket
+);
+
+
+/**
+
+    @brief      Run a function in the worker thread and wait for its result
+    @param      worker          The worker that must run the function
+                                                                 [NON-NULLABLE]
+    @param      call_routine    The function to run              [NON-NULLABLE]
+    @param      call_data       Custom data to pass to the function  [NULLABLE]
+    @param      save_result     A placeholder for storing the value returned by
+                                @p call_routine                      [NULLABLE]
+    @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
+                `GNUNET_WORKER_ERR_NO_MEMORY`, `GNUNET_WORKER_ERR_SIGNAL`,
+                `GNUNET_WORKER_ERR_QUEUE_FULL`, `GNUNET_WORKER_ERR_CANCELLED`
+                and `GNUNET_WORKER_ERR_INVALID_HANDLE`
+
+    This function pushes @p call_routine into the worker with
+    `GNUNET_SCHEDULER_PRIORITY_DEFAULT` and blocks until it has returned, so
+    that its return value can be passed back to the caller. It replaces the
+    pattern of pushing a job and then waiting on a barrier or a condition
+    variable for it to complete.
+
+    No memory is allocated for waiting: the completion record lives on the
+    caller's stack and the caller sleeps on a futex (on systems without
+    futexes a condition variable is used instead).
+
+    If the caller is the worker thread itself, @p call_routine is invoked
+    immediately.
+
+    A return value of `GNUNET_WORKER_ERR_CANCELLED` indicates that the worker
+    was shut down before @p call_routine could run; in this case
+    @p save_result is left untouched. See `GNUNET_WORKER_push_load()` for the
+    meaning of `GNUNET_WORKER_ERR_INVALID_HANDLE`.
+
+**/
+extern int GNUNET_WORKER_call (
+    const GNUNET_WORKER_Handle worker,
+    const GNUNET_WORKER_CallRoutine call_routine,
+    void * const call_data,
+    void ** const save_result
+);
+
+
+/**
+
+    @brief      Run a function in the worker thread and wait for its result,
+                but only if the function starts within a certain time
+    @param      worker          The worker that must run the function
+                                                                 [NON-NULLABLE]
+    @param      call_routine    The function to run              [NON-NULLABLE]
+    @param      call_data       Custom data to pass to the function  [NULLABLE]
+    @param      save_result     A placeholder for storing the value returned by
+                                @p call_routine                      [NULLABLE]
+    @param      absolute_time   The absolute time to wait until  [NON-NULLABLE]
+    @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
+                `GNUNET_WORKER_ERR_NO_MEMORY`, `GNUNET_WORKER_ERR_SIGNAL`,
+                `GNUNET_WORKER_ERR_QUEUE_FULL`, `GNUNET_WORKER_ERR_CANCELLED`,
+                `GNUNET_WORKER_ERR_EXPIRED`, `GNUNET_WORKER_ERR_INVALID_TIME`
+                and `GNUNET_WORKER_ERR_INVALID_HANDLE`
+
+    This function is identical to `GNUNET_WORKER_call()`, but if
+    @p call_routine has not started by @p absolute_time (measured against the
+    `CLOCK_REALTIME` clock, like with `GNUNET_WORKER_timedsynch_destroy()`) the
+    call is cancelled and `GNUNET_WORKER_ERR_EXPIRED` is returned. A routine
+    that has already started when the time expires cannot be interrupted: in
+    that case this function keeps waiting for its result.
+
+**/
+extern int GNUNET_WORKER_timedcall (
+    const GNUNET_WORKER_Handle worker,
+    const GNUNET_WORKER_CallRoutine call_routine,
+    void * const call_data,
+    void ** const save_result,
+    const struct timespec * const absolute_time
+);
+
+
+/**
+
+    @brief      Terminate a worker and free its memory, without waiting for the
+                scheduler to return -- this will be completed in parallel
+                (asynchronous)
+    @param      worker          The worker to destroy            [NON-NULLABLE]
+    @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
+                `GNUNET_WORKER_ERR_DOUBLE_FREE` and `GNUNET_WORKER_ERR_SIGNAL`
+
+    This function is used to launch `GNUNET_SCHEDULER_shutdown()` in the worker
+    thread, without waiting for the scheduler to return.
+
+    Functions already scheduled via `GNUNET_WORKER_push_load()` that had no
+    time to be invoked will be immediately cancelled. If the user had passed an
+    `on_worker_end` routine during the creation of the worker, this will be
+    launched now.
+
+    This function can be invoked by any thread (including the worker thread as
+    well). Directly launching `GNUNET_SCHEDULER_shutdown()` from the worker
+    thread will have identical effects to launching this function from any
+    other thread (i.e., the memory previously allocated for the worker will be
+    destroyed).
+
+    A return value of `GNUNET_WORKER_ERR_DOUBLE_FREE` indicates that another
+    thread has already triggered the worker's destruction (this includes having
+    invoked `GNUNET_SCHEDULER_shutdown()` from the scheduler itself). If this
+    happens, the caller's code is in a dangerous position: the next time,
+    instead of a handle in the process of being destroyed, an already destroyed
+    handle might be passed to this function, and that will cause undefined
+    behavior (probably a crash). This error must be handled exactly like a
+    double free or corruption error, and you should always pay attention that
+    no more than one thread can destroy the worker. You must not handle
+    `GNUNET_WORKER_ERR_DOUBLE_FREE` using runtime checks unless you are
+    debugging your program; the way to handle this error is by writing code
+    that does not destroy a worker twice. Please have a look at the
+    documentation of either `GNUNET_WORKER_adopt_running_scheduler()`,
+    `GNUNET_WORKER_start_serving()` or `GNUNET_WORKER_create()` for more
+    information on how to avoid that his happens. It is very likely that this
+    error code will be removed in the future and a call to `exit()` will appear
+    in its place.
+
+    A value of `GNUNET_WORKER_ERR_SIGNAL` indicates that it was not possible to
+    notify the worker about the shutdown (this error can be thrown only if this
+    function was not invoked from the worker thread). In this case there is not
+    much to do. The return value was caused by an error during `write()` into
+    the worker's beep channel (an eventfd or a pipe, depending on how the
+    library was configured). The only way to know whether the worker has
+    received the message or not is by passing an `on_worker_end` routine during
+    the creation of the worker and let it signal about the shutdown happening.
+    If no signal arrives it is possible to try and wake up the worker for the
+    shutdown by using `GNUNET_WORKER_ping()` or by invoking this function again.
+    A beep channel breaking is a very unlikely event to occur, and it might make
+    sense to ignore completely the possible `GNUNET_WORKER_ERR_SIGNAL` return
+    value, assume that the worker has been destroyed, and tolerate the rare
+    events of workers turned into zombies; or alternatively, it might be a good
+    idea to launch `exit()`, if a worker turns into a zombie.
+
+**/
+extern int GNUNET_WORKER_asynch_destroy (
+    const GNUNET_WORKER_Handle worker
+);
+
+
+/**
+
+    @brief      Terminate a worker and free its memory, waiting for the
+                scheduler to complete the shutdown (synchronous)
+    @param      worker          The worker to destroy            [NON-NULLABLE]
+    @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
+                `GNUNET_WORKER_ERR_DOUBLE_FREE`, `GNUNET_WORKER_ERR_UNKNOWN`
+                `GNUNET_WORKER_ERR_NOT_ALONE`, `GNUNET_WORKER_ERR_SIGNAL` and
+                `GNUNET_WORKER_ERR_INTERNAL_BUG`
+
+    This function is used to launch `GNUNET_SCHEDULER_shutdown()` in the worker
+    thread, waiting for the scheduler to return.
+
+    Functions already scheduled via `GNUNET_WORKER_push_load()` that had no
+    time to be invoked will be immediately cancelled. If the user had passed an
+    `on_worker_end` routine during the creation of the worker, this will be
+    launched now.
+
+    This function can be invoked by any thread (including the worker thread as
+    well). Directly launching `GNUNET_SCHEDULER_shutdown()` from the worker
+    thread will have identical effects to launching this function from any
+    other thread (i.e., the memory previously allocated for the worker will be
+    destroyed).
+
+    Any return value different than `GNUNET_WORKER_ERR_SIGNAL` indicate that
+    the scheduler will eventually shut down. However only zero grants that the
+    scheduler is not running anymore when this function returns. In fact, any
+    error code different than zero makes this function behave like
+    `GNUNET_WORKER_asynch_destroy()`.
+
+    A return value of `GNUNET_WORKER_ERR_DOUBLE_FREE` indicates that another
+    thread has already triggered the worker's destruction (this includes having
+    invoked `GNUNET_SCHEDULER_shutdown()` from the scheduler itself). If this
+    happens, the caller's code is in a dangerous position: the next time,
+    instead of a handle in the process of being destroyed, an already destroyed
+    handle might be passed to this function, and that will cause undefined
+    behavior (probably a crash). This error must be handled exactly like a
+    double free or corruption error, and you should always pay attention that
+    no more than one thread can destroy the worker. You must not handle
+    `GNUNET_WORKER_ERR_DOUBLE_FREE` using runtime checks unless you are
+    debugging your program; the way to handle this error is by writing code
+    that does not destroy a worker twice. Please have a look at the
+    documentation of either `GNUNET_WORKER_adopt_running_scheduler()`,
+    `GNUNET_WORKER_start_serving()` or `GNUNET_WORKER_create()` for more
+    information on how to avoid that his happens. It is very likely that this
+    error code will be removed in the future and a call to `exit()` will appear
+    in its place.
+
+    A return value of `GNUNET_WORKER_ERR_UNKNOWN` can only be due to a
+    non-standard implementation of the `pthread_join()` and
+    `pthread_cond_wait()` functions currently in use.
+
+    A value of `GNUNET_WORKER_ERR_SIGNAL` indicates that it was not possible to
+    notify the worker about the shutdown (this error can be thrown only if this
+    function was not invoked from the worker thread). In this case there is not
+    much to do. The return value was caused by an error during `write()` into
+    the worker's beep channel (an eventfd or a pipe, depending on how the
+    library was configured). The only way to know whether the worker has
+    received the message or not is by passing an `on_worker_end` routine during
+    the creation of the worker and let it signal about the shutdown happening.
+    If no signal arrives it is possible to try and wake up the worker for the
+    shutdown by using `GNUNET_WORKER_ping()` or by invoking this function again.
+    A beep channel breaking is a very unlikely event to occur, and it might make
+    sense to ignore completely the possible `GNUNET_WORKER_ERR_SIGNAL` return
+    value, assume that the worker has been destroyed, and tolerate the rare
+    events of workers turned into zombies; or alternatively, it might be a good
+    idea to launch `exit()`, if a worker turns into a zombie.
+
+    A value of `GNUNET_WORKER_ERR_INTERNAL_BUG` should never be returned;
+    please fill a bug report if it happens.
+
+**/
+extern int GNUNET_WORKER_synch_destroy (
+    const GNUNET_WORKER_Handle worker
+);
+
+
+/**
+
+    @brief      Terminate a worker and free its memory, waiting for the
+                scheduler to complete the shutdown (synchronous), but only if
+                this happens within a certain time, otherwise it will be
+                completed in parallel (asynchronous)
+    @param      worker          The worker to destroy            [NON-NULLABLE]
+    @param      absolute_time   The absolute time to wait until  [NON-NULLABLE]
     @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
                 `GNUNET_WORKER_ERR_DOUBLE_FREE`, `GNUNET_WORKER_ERR_EXPIRED`,
                 `GNUNET_WORKER_ERR_INVALID_TIME`, `GNUNET_WORKER_ERR_UNKNOWN`
@@ -685,16 +1536,17 @@ extern int GNUNET_WORKER_synch_destroy (
     notify the worker about the shutdown (this error can be thrown only if this
     function was not invoked from the worker thread). In this case there is not
     much to do. The return value was caused by an error during `write()` into
-    the worker's pipe. The only way to know whether the worker has received the
-    message or not is by passing an `on_worker_end` routine during the creation
-    of the worker and let it signal about the shutdown happening. If no signal
-    arrives it is possible to try and wake up the worker for the shutdown by
-    using `GNUNET_WORKER_ping()` or by invoking this function again. A pipe
-    breaking is a very unlikely event to occur, and it might make sense to
-    ignore completely the possible `GNUNET_WORKER_ERR_SIGNAL` return value,
-    assume that the worker has been destroyed, and tolerate the rare events of
-    workers turned into zombies; or alternatively, it might be a good idea to
-    launch `exit()`, if a worker turns into a zombie.
+    the worker's beep channel (an eventfd or a pipe, depending on how the
+    library was configured). The only way to know whether the worker has
+    received the message or not is by passing an `on_worker_end` routine during
+    the creation of the worker and let it signal about the shutdown happening.
+    If no signal arrives it is possible to try and wake up the worker for the
+    shutdown by using `GNUNET_WORKER_ping()` or by invoking this function again.
+    A beep channel breaking is a very unlikely event to occur, and it might make
+    sense to ignore completely the possible `GNUNET_WORKER_ERR_SIGNAL` return
+    value, assume that the worker has been destroyed, and tolerate the rare
+    events of workers turned into zombies; or alternatively, it might be a good
+    idea to launch `exit()`, if a worker turns into a zombie.
 
     A value of `GNUNET_WORKER_ERR_INTERNAL_BUG` should never be returned;
     please fill a bug report if it happens.
@@ -771,6 +1623,493 @@ extern void * GNUNET_WORKER_get_data (
 );
 
 
+/**
+
+    @brief      Get the checked identifier of a worker
+    @param      worker          The worker to query              [NON-NULLABLE]
+    @return     The identifier of @p worker (never `0`)
+
+    Every worker receives an identifier when it is created. The identifier
+    can be passed around in place of the handle, and keeps being safe to use
+    after the worker has been freed: `GNUNET_WORKER_id_is_valid()` and
+    `GNUNET_WORKER_push_load_by_id()` will simply reject it. No other worker
+    will ever be mistaken for a freed one, until the same slot of the
+    identifier table has been reused four billion times.
+
+**/
+extern GNUNET_WORKER_Id GNUNET_WORKER_get_id (
+    const GNUNET_WORKER_Handle worker
+);
+
+
+/**
+
+    @brief      Check whether an identifier still refers to a worker
+    @param      worker_id       The identifier to check
+    @return     A boolean: `true` if the worker has not been freed yet and is
+                not being destroyed, `false` otherwise
+
+    The check costs one atomic load. Since the worker might be freed right
+    after this function has returned, the answer is useful only as a hint;
+    `GNUNET_WORKER_push_load_by_id()` performs the check and the push as one
+    safe operation.
+
+**/
+extern bool GNUNET_WORKER_id_is_valid (
+    const GNUNET_WORKER_Id worker_id
+);
+
+
+/**
+
+    @brief      Schedule a new function for a worker addressed by its
+                identifier, with a priority
+    @param      worker_id       The identifier of the worker
+    @param      job_priority    The priority of the task
+    @param      job_routine     The task to schedule             [NON-NULLABLE]
+    @param      job_data        Custom data to pass to the task      [NULLABLE]
+    @return     The same values as `GNUNET_WORKER_push_load_with_priority()`
+
+    This function behaves like `GNUNET_WORKER_push_load_with_priority()`, but
+    a stale identifier -- or the identifier of a worker that is being
+    destroyed -- is quietly rejected with `GNUNET_WORKER_ERR_INVALID_HANDLE`,
+    without any bookkeeping in the `on_worker_end` routine. While the push is
+    in progress the worker cannot be freed: whoever frees it waits for the
+    push to complete.
+
+**/
+extern int GNUNET_WORKER_push_load_by_id (
+    const GNUNET_WORKER_Id worker_id,
+    const enum GNUNET_SCHEDULER_Priority job_priority,
+    const GNUNET_CallbackRoutine job_routine,
+    void * const job_data
+);
+
+
+/**
+
+    @brief      Set the maximum number of spare job nodes a worker keeps for
+                reuse
+    @param      worker          The worker to configure          [NON-NULLABLE]
+    @param      max_spare_jobs  The pool's high-water mark (`0` disables the
+                                pool)
+
+    Every job pushed into a worker needs a small block of memory, which is
+    released after the job has run. Instead of returning these blocks to the
+    allocator, a worker keeps up to @p max_spare_jobs of them aside and hands
+    them back in batches to the threads that push new jobs, so that in a
+    steady state pushing a job does not need to invoke `malloc()` at all.
+    Blocks are never handed back to the allocator while jobs run, but only
+    when the pool would otherwise exceed this limit.
+
+    The bound applies per producer thread: a batch handed back to a thread
+    moves into that thread's own cache, which never holds more than
+    @p max_spare_jobs nodes and is consumed by the thread's next pushes into
+    any worker. Hence every thread that pushes jobs may keep up to that many
+    spare nodes besides those of the worker, and it keeps them until it exits
+    -- even after the worker has been destroyed.
+
+    The default size of the pool is 1024 nodes. This function can be invoked
+    from any thread at any moment of the worker's life.
+
+**/
+extern void GNUNET_WORKER_set_job_pool_size (
+    const GNUNET_WORKER_Handle worker,
+    const size_t max_spare_jobs
+);
+
+
+/**
+
+    @brief      Set the maximum number of jobs that can be pending in a worker
+    @param      worker          The worker to configure          [NON-NULLABLE]
+    @param      max_pending_jobs    The maximum number of jobs pushed and not
+                                    started yet (`0` for no limit)
+
+    By default a worker accepts any amount of jobs. If the worker's scheduler
+    stalls while producers keep pushing, memory grows without bounds. Once a
+    capacity is set, jobs that would exceed it are refused with
+    `GNUNET_WORKER_ERR_QUEUE_FULL` by `GNUNET_WORKER_push_load()`,
+    `GNUNET_WORKER_push_load_with_priority()`,
+    `GNUNET_WORKER_push_load_batch()` and `GNUNET_WORKER_try_push_load()`,
+    while `GNUNET_WORKER_wait_push_load()` and
+    `GNUNET_WORKER_timedwait_push_load()` wait for room.
+
+    A job stops counting against the capacity as soon as it is started. This
+    function can be invoked from any thread at any moment of the worker's
+    life; shrinking the capacity does not affect the jobs already pushed.
+
+**/
+extern void GNUNET_WORKER_set_capacity (
+    const GNUNET_WORKER_Handle worker,
+    const size_t max_pending_jobs
+);
+
+
+/**
+
+    @brief      Set how many jobs a dispatcher may run before yielding back to
+                the scheduler, or switch the dispatch mode off
+    @param      worker          The worker to configure          [NON-NULLABLE]
+    @param      jobs_per_slice  The maximum number of jobs run in a row by a
+                                dispatcher (`0` switches the dispatch mode off)
+
+    By default the dispatch mode is off and every job pushed into the worker
+    becomes a GNUnet task of its own. Under bursts of load this can flood the
+    scheduler's ready queue with thousands of tasks.
+
+    When the dispatch mode is switched on, a worker keeps its own FIFO queue
+    for each priority level and schedules one single task per priority (a
+    "dispatcher"), which runs up to @p jobs_per_slice jobs in a row and then
+    yields back to the scheduler, so that other tasks can run in between.
+
+    In both modes jobs are run according to their priority and, within the
+    same priority, in chronological order. This function can be invoked from
+    any thread at any moment of the worker's life; the new setting applies to
+    the jobs that the worker has not received yet.
+
+**/
+extern void GNUNET_WORKER_set_dispatch_budget (
+    const GNUNET_WORKER_Handle worker,
+    const unsigned int jobs_per_slice
+);
+
+
+/**
+
+    @brief      Get the number of jobs of a given priority that the worker
+                thread has received but not started yet
+    @param      worker          The worker to query              [NON-NULLABLE]
+    @param      priority        The priority level to query
+    @return     The number of jobs waiting in the worker thread (always `0` if
+                @p priority is out of range)
+
+    Jobs that have been pushed but that the worker thread has not noticed yet
+    are not counted. The value returned is only a snapshot and may already be
+    stale when this function returns.
+
+**/
+extern size_t GNUNET_WORKER_get_queue_depth (
+    const GNUNET_WORKER_Handle worker,
+    const enum GNUNET_SCHEDULER_Priority priority
+);
+
+
+/**
+
+    @brief      Get a snapshot of the statistics of a worker
+    @param      worker          The worker to query              [NON-NULLABLE]
+    @param      save_stats      A placeholder for storing the statistics
+                                                                 [NON-NULLABLE]
+
+    This function can be invoked from any thread, for as long as @p worker is
+    a valid handle. The counters are maintained with relaxed atomic operations
+    (the worker thread updates its own counters without read-modify-write
+    instructions), so keeping them costs only a few nanoseconds per push; in
+    exchange, the fields of the snapshot are read one by one and are not
+    guaranteed to be consistent with each other.
+
+    The jobs still pending when the worker shuts down are counted in
+    `GNUNET_WORKER_Stats::jobs_dropped` while the shutdown proceeds; the
+    `on_worker_end` routine is the last place where they can be observed.
+
+**/
+extern void GNUNET_WORKER_get_stats (
+    const GNUNET_WORKER_Handle worker,
+    GNUNET_WORKER_Stats * const save_stats
+);
+
+
+/**
+
+    @brief      Switch the tracking of the latencies of the jobs on or off
+    @param      worker          The worker to configure          [NON-NULLABLE]
+    @param      enabled         Whether the latencies must be tracked
+    @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`) and
+                `GNUNET_WORKER_ERR_NO_MEMORY`
+
+    When tracking is on, every job is stamped when it is pushed, when the
+    worker thread collects it and when its routine starts and ends, and the
+    latencies of the phases listed in `GNUNET_WORKER_LatencyKind` are
+    aggregated into one histogram per priority (see
+    `GNUNET_WORKER_get_latency_histogram()`). Tracking is off by default, and
+    while it is off no clock is read: pushing costs one more relaxed atomic
+    load and running a job one more comparison.
+
+    The histograms are allocated the first time tracking is switched on and
+    are never reset: switching tracking off only pauses them. Jobs pushed
+    while tracking was off are not counted, even if they run after it has
+    been switched on. This function can be invoked from any thread.
+
+**/
+extern int GNUNET_WORKER_set_latency_tracking (
+    const GNUNET_WORKER_Handle worker,
+    const bool enabled
+);
+
+
+/**
+
+    @brief      Get a snapshot of the histogram of a latency
+    @param      worker          The worker to query              [NON-NULLABLE]
+    @param      priority        The priority of the jobs to look at
+    @param      kind            The phase of the jobs to look at
+    @param      save_histogram  A placeholder for storing the histogram
+                                                                 [NON-NULLABLE]
+    @return     A boolean: `true` if the histogram has been stored, `false` if
+                tracking has never been switched on for @p worker or if
+                @p priority or @p kind are out of range
+
+    Like with `GNUNET_WORKER_get_stats()`, the buckets are read one by one
+    while the worker thread might be updating them.
+
+**/
+extern bool GNUNET_WORKER_get_latency_histogram (
+    const GNUNET_WORKER_Handle worker,
+    const enum GNUNET_SCHEDULER_Priority priority,
+    const GNUNET_WORKER_LatencyKind kind,
+    GNUNET_WORKER_Histogram * const save_histogram
+);
+
+
+/**
+
+    @brief      Get the highest latency that falls in a bucket of a
+                `GNUNET_WORKER_Histogram`
+    @param      bucket          The index of the bucket
+    @return     The highest latency of the bucket, in nanoseconds
+
+**/
+extern uint64_t GNUNET_WORKER_histogram_bucket_value (
+    const unsigned int bucket
+);
+
+
+/**
+
+    @brief      Get a percentile of a `GNUNET_WORKER_Histogram`
+    @param      histogram       The histogram to read            [NON-NULLABLE]
+    @param      percentile      The percentile wanted (e.g. `99.9`)
+    @return     The highest latency of the bucket where the percentile falls,
+                in nanoseconds, never more than
+                `GNUNET_WORKER_Histogram::max` (`0` for an empty histogram)
+
+**/
+extern uint64_t GNUNET_WORKER_histogram_percentile (
+    const GNUNET_WORKER_Histogram * const histogram,
+    const double percentile
+);
+
+
+/**
+
+    @brief      Switch the routine profiler of a worker on or off
+    @param      worker          The worker to configure          [NON-NULLABLE]
+    @param      flags           What must be measured (see
+                                `GNUNET_WORKER_ProfileFlags`), or
+                                `GNUNET_WORKER_PROFILE_OFF`
+    @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`) and
+                `GNUNET_WORKER_ERR_NO_MEMORY`
+
+    While the profiler is on, the worker thread measures every job routine it
+    invokes and accounts it to the routine's address (see
+    `GNUNET_WORKER_get_routine_profile()`). Time is read via
+    `CLOCK_MONOTONIC` and `CLOCK_THREAD_CPUTIME_ID`; the hardware counters are
+    read via `perf_event_open()`, costing two system calls per job, and are
+    opened by the worker thread at its first measured job. Where they cannot be
+    opened (on systems other than Linux, or when
+    `/proc/sys/kernel/perf_event_paranoid` forbids it) the cycles and the
+    instructions stay zero. Jobs invoked through `GNUNET_WORKER_call()` are
+    accounted to the routine passed to it.
+
+    The profile is allocated the first time the profiler is switched on and
+    is never reset: switching the profiler off only pauses it. The first 256
+    routines have an entry of their own, the following ones are accounted
+    together. This function can be invoked from any thread.
+
+**/
+extern int GNUNET_WORKER_set_routine_profiling (
+    const GNUNET_WORKER_Handle worker,
+    const unsigned int flags
+);
+
+
+/**
+
+    @brief      Get a snapshot of the routine profile of a worker
+    @param      worker          The worker to query              [NON-NULLABLE]
+    @param      save_profile    An array where the entries of the profile
+                                will be stored                   [NULLABLE]
+    @param      max_entries     The length of @p save_profile
+    @return     The number of entries of the profile, which might be larger
+                than @p max_entries (`0` if the profiler has never been
+                switched on)
+
+    The entries are stored in no particular order. Like with
+    `GNUNET_WORKER_get_stats()`, the counters are read one by one while the
+    worker thread might be updating them.
+
+**/
+extern size_t GNUNET_WORKER_get_routine_profile (
+    const GNUNET_WORKER_Handle worker,
+    GNUNET_WORKER_RoutineProfile * const save_profile,
+    const size_t max_entries
+);
+
+
+/**
+
+    @brief      Write the routine profile of a worker as a text table
+    @param      worker          The worker to query              [NON-NULLABLE]
+    @param      fd              The file descriptor where the table must be
+                                written
+    @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
+                `GNUNET_WORKER_ERR_NO_MEMORY` and `GNUNET_WORKER_ERR_UNKNOWN`
+                (writing to @p fd failed)
+
+    The routines are sorted by CPU time (or by wall time, or by cycles,
+    depending on what has been measured), and are named after their symbol
+    when a shared object exports it, otherwise after the object that contains
+    them and their offset within it, which `addr2line` can resolve.
+
+**/
+extern int GNUNET_WORKER_dump_routine_profile (
+    const GNUNET_WORKER_Handle worker,
+    const int fd
+);
+
+
+/**
+
+    @brief      Install or remove the process-wide tracer
+    @param      tracer          The tracer to install, or `NULL` for removing
+                                the current one                  [NULLABLE]
+
+    The tracer receives the lifecycle events of all the workers of the
+    process: jobs that are pushed, collected by the worker thread, started,
+    finished or cancelled, and every change of stage of a worker (see
+    `GNUNET_WORKER_TraceEvent`). Most events are reported by the worker
+    thread, but pushes and the changes of stage caused by the destroy
+    functions are reported by the thread that caused them, and the jobs
+    dropped by a shutdown might be reported by any of the threads involved;
+    hence the tracer must be thread-safe. It should also be fast, since the
+    thread that reports an event waits for it. The tracer must not invoke
+    this function.
+
+    The @p tracer structure is not copied: it must stay valid and unchanged
+    for as long as it is installed. This function returns only after all the
+    threads that were still reporting events to the previous tracer have
+    returned from it, so the previous tracer and its data can be freed right
+    afterwards (for this reason the tracer must not wait for a thread that
+    might be invoking this function). While no tracer is installed every event
+    costs one atomic load (a plain load on most CPUs) and no clock is read.
+    This function can be invoked from any thread.
+
+**/
+extern void GNUNET_WORKER_set_tracer (
+    const GNUNET_WORKER_Tracer * const tracer
+);
+
+
+/**
+
+    @brief      Start recording the timeline of all the workers
+    @param      fd              The file descriptor where the trace must be
+                                written
+    @return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
+                `GNUNET_WORKER_ERR_NOT_ALONE` (a recording is running already)
+                and `GNUNET_WORKER_ERR_THREAD_CREATE`
+
+    The recorder installs itself as the tracer of the process (see
+    `GNUNET_WORKER_set_tracer()`, which must not be used while recording) and
+    writes the events in the Chrome trace-event format (a JSON array), which
+    can be opened with `chrome://tracing` or with Perfetto. The execution of
+    every job appears as a span on the thread of its worker; the wait of every
+    job, from the push to the start of its routine, as an asynchronous span
+    that starts on the pushing thread; every collection of the jobs pushed by
+    other threads as a `drain` span; every change of stage of a worker as an
+    instant event. Routines exported by a shared object are named after their
+    symbol, the others after their address.
+
+    Every thread that reports an event copies it into a ring buffer of its
+    own, without locks; a background thread empties all the buffers every
+    50 milliseconds and writes them to @p fd. Events that do not fit in a full
+    buffer are dropped, and the number of the events dropped is written at the
+    end of the trace. @p fd is not closed when the recording stops.
+
+**/
+extern int GNUNET_WORKER_start_trace_recorder (
+    const int fd
+);
+
+
+/**
+
+    @brief      Stop recording the timeline of the workers
+    @return     A boolean: `true` if a recording has been stopped, `false` if
+                no recording was running
+
+    When this function returns the trace has been completely written. It
+    removes whatever tracer is installed.
+
+**/
+extern bool GNUNET_WORKER_stop_trace_recorder (void);
+
+
+/**
+
+    @brief      Dump the flight recorders of all the workers as text
+    @param      fd              The file descriptor where the dump must be
+                                written
+
+    Every worker, since its birth, remembers its last 1024 events (the start,
+    the end and the cancellation of its jobs, its collections of the jobs
+    pushed by other threads and its changes of stage) in a ring that costs a
+    few stores per event, its "flight recorder". The recorders of the workers
+    that have been freed are dumped too, until a new worker takes them over.
+    Routines are shown as addresses (`addr2line` or a debugger can name them).
+
+    This function is async-signal-safe and can be invoked from a signal
+    handler. The recorders are also readable from a core file: every recorder
+    is a memory mapping of its own and begins with the string
+    `"GNUNET_WORKER_FLIGHT_RECORDER"`.
+
+**/
+extern void GNUNET_WORKER_dump_flight_recorders (
+    const int fd
+);
+
+
+/**
+
+    @brief      Dump the flight recorders of all the workers when the process
+                receives a signal
+    @param      fd              The file descriptor where the dumps must be
+                                written
+    @param      dump_signal     A signal that dumps the recorders and lets the
+                                process go on (e.g. `SIGUSR1`), or `0`
+    @return     A boolean: `true` if all the handlers have been installed,
+                `false` otherwise (then no handler has been changed)
+
+    The recorders are also dumped when the process receives `SIGSEGV`,
+    `SIGBUS`, `SIGILL`, `SIGFPE` or `SIGABRT`. Then the action that was
+    installed for the signal before this function was invoked is restored and
+    the signal is handed over to it: a handler (e.g. a crash reporter or a
+    sanitizer) is invoked with the original information about the signal,
+    while the default action simply takes place. Handlers installed for these
+    signals after this function has been invoked replace the dump.
+
+    When the event loop of a worker is unexpectedly cut off (and the process
+    exits with `EINTR`), the recorder of that worker is dumped to @p fd, or to
+    the standard error if this function has never been invoked.
+
+**/
+extern bool GNUNET_WORKER_install_flight_recorder_dump (
+    const int fd,
+    const int dump_signal
+);
+
+
 /**
 
     @brief      Get the handle of the current worker if this is a worker thread
@@ -0,0 +1,308 @@
+/*  -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+
+/*\
+|*|
+|*| libgnunetworker/src/profile.c
+|*|
+|*| https://github.com/madmurphy/libgnunetworker
+|*|
+|*| Copyright (C) 2022 madmurphy <madmurphy333@gmail.com>
+|*|
+|*| **GNUnet Worker** is free software: you can redistribute it and/or modify
+|*| it under the terms of the GNU Affero General Public License as published by
+|*| the Free Software Foundation, either version 3 of the License, or (at your
+|*| option) any later version.
+|*|
+|*| **GNUnet Worker** is distributed in the hope that it will be useful, but
+|*| WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+|*| or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public
+|*| License for more details.
+|*|
+|*| You should have received a copy of the GNU Affero General Public License
+|*| along with this program. If not, see <http://www.gnu.org/licenses/>.
+|*|
+\*/
+
+
+/**
+
+	@file       profile.c
+	@brief      A readable report of the routine profile of a worker
+
+**/
+
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_scheduler_lib.h>
+#include "include/gnunet_worker_lib.h"
+
+
+
+		/*\
+		|*|
+		|*|     LOCAL ENVIRONMENT
+		|*|    ________________________________
+		\*/
+
+
+
+	/*  INLINED FUNCTIONS  */
+
+
+/**
+
+	@brief      Get the measure the entries of a profile are sorted by
+	@param      entry           The entry to look at             [NON-NULLABLE]
+	@param      sort_field      The field to use (see `profile_sort_field()`)
+	@return     The value of the measure
+
+**/
+static inline uint64_t profile_measure (
+	const GNUNET_WORKER_RoutineProfile * const entry,
+	const int sort_field
+) {
+	switch (sort_field) {
+		case 0: return entry->cpu_time;
+		case 1: return entry->wall_time;
+		case 2: return entry->cycles;
+		default: return entry->calls;
+	}
+}
+
+
+/**
+
+	@brief      Choose the most meaningful measure for sorting a profile
+	@param      profile         The entries of the profile       [NON-NULLABLE]
+	@param      length          The number of entries in @p profile
+	@return     `0` for the CPU time, `1` for the wall time, `2` for the cycles,
+	            `3` for the number of calls
+
+**/
+static inline int profile_sort_field (
+	const GNUNET_WORKER_RoutineProfile * const profile,
+	const size_t length
+) {
+	int sort_field = 3;
+	for (size_t idx = 0; idx < length; idx++) {
+		if (profile[idx].cpu_time) {
+			return 0;
+		}
+		if (profile[idx].wall_time) {
+			sort_field = 1;
+		} else if (profile[idx].cycles && sort_field > 2) {
+			sort_field = 2;
+		}
+	}
+	return sort_field;
+}
+
+
+/**
+
+	@brief      Write the name of a routine
+	@param      fd              The file descriptor to write to
+	@param      routine         The routine to name                  [NULLABLE]
+	@return     The return value of `dprintf()`
+
+	Routines without an exported symbol are named after the object that
+	contains them and their offset within it, the way `addr2line` wants them.
+
+**/
+static inline int routine_name_write (
+	const int fd,
+	const GNUNET_CallbackRoutine routine
+) {
+	const void * const address = (const void *) (uintptr_t) routine;
+	const char * object;
+	Dl_info info;
+	if (!address) {
+		return dprintf(fd, "(other routines)\n");
+	}
+	if (!dladdr(address, &info)) {
+		return dprintf(fd, "0x%" PRIxPTR "\n", (uintptr_t) address);
+	}
+	if (info.dli_sname && info.dli_saddr == address) {
+		return dprintf(fd, "%s\n", info.dli_sname);
+	}
+	if (info.dli_sname) {
+		return dprintf(
+			fd,
+			"%s+0x%" PRIxPTR "\n",
+			info.dli_sname,
+			(uintptr_t) address - (uintptr_t) info.dli_saddr
+		);
+	}
+	object = info.dli_fname ? strrchr(info.dli_fname, '/') : NULL;
+	return dprintf(
+		fd,
+		"%s+0x%" PRIxPTR "\n",
+		object ? object + 1 : info.dli_fname ? info.dli_fname : "?",
+		(uintptr_t) address - (uintptr_t) info.dli_fbase
+	);
+}
+
+
+
+	/*  FUNCTIONS  */
+
+
+/**
+
+	@brief      Define a `qsort()` comparator that puts the entries of a
+	            profile in descending order of one measure
+	@param      NAME            The name of the comparator
+	@param      SORT_FIELD      The measure (see `profile_sort_field()`)
+
+**/
+#define PROFILE_COMPARATOR(NAME, SORT_FIELD) \
+	static int NAME ( \
+		const void * const v_entry_a, \
+		const void * const v_entry_b \
+	) { \
+		const uint64_t \
+			measure_a = profile_measure(v_entry_a, SORT_FIELD), \
+			measure_b = profile_measure(v_entry_b, SORT_FIELD); \
+		return (measure_a < measure_b) - (measure_a > measure_b); \
+	}
+
+
+PROFILE_COMPARATOR(profile_compare_cpu_time, 0)
+PROFILE_COMPARATOR(profile_compare_wall_time, 1)
+PROFILE_COMPARATOR(profile_compare_cycles, 2)
+PROFILE_COMPARATOR(profile_compare_calls, 3)
+
+#undef PROFILE_COMPARATOR
+
+
+/**
+
+	@brief      The comparators of `profile_sort_field()`, in the same order
+
+**/
+static int (* const profile_comparators[])(const void *, const void *) = {
+	&profile_compare_cpu_time,
+	&profile_compare_wall_time,
+	&profile_compare_cycles,
+	&profile_compare_calls
+};
+
+
+
+		/*\
+		|*|
+		|*|     GLOBAL ENVIRONMENT
+		|*|    ________________________________
+		\*/
+
+
+
+	/*  Please see the public header for the complete documentation  */
+
+
+/**
+
+	@brief      Write the routine profile of a worker as a text table
+
+*/
+int GNUNET_WORKER_dump_routine_profile (
+	const GNUNET_WORKER_Handle worker,
+	const int fd
+) {
+
+	int retval = GNUNET_WORKER_SUCCESS;
+
+	/*  The profile might grow between the two calls  */
+
+	const size_t capacity =
+		GNUNET_WORKER_get_routine_profile(worker, NULL, 0) + 16;
+
+	GNUNET_WORKER_RoutineProfile * const profile =
+		malloc(capacity * sizeof(GNUNET_WORKER_RoutineProfile));
+
+	if (!profile) {
+
+		return GNUNET_WORKER_ERR_NO_MEMORY;
+
+	}
+
+	size_t length = GNUNET_WORKER_get_routine_profile(worker, profile, capacity);
+
+	if (length > capacity) {
+
+		length = capacity;
+
+	}
+
+	qsort(
+		profile,
+		length,
+		sizeof(GNUNET_WORKER_RoutineProfile),
+		profile_comparators[profile_sort_field(profile, length)]
+	);
+
+	if (
+		dprintf(
+			fd,
+			"%12s %14s %14s %16s %16s  %s\n",
+			"calls",
+			"wall ms",
+			"cpu ms",
+			"cycles",
+			"instructions",
+			"routine"
+		) < 0
+	) {
+
+		retval = GNUNET_WORKER_ERR_UNKNOWN;
+		goto free_and_exit;
+
+	}
+
+	for (size_t idx = 0; idx < length; idx++) {
+
+		if (
+			dprintf(
+				fd,
+				"%12" PRIu64 " %10" PRIu64 ".%03u %10" PRIu64 ".%03u %16"
+				PRIu64 " %16" PRIu64 "  ",
+				profile[idx].calls,
+				profile[idx].wall_time / 1000000,
+				(unsigned int) (profile[idx].wall_time / 1000 % 1000),
+				profile[idx].cpu_time / 1000000,
+				(unsigned int) (profile[idx].cpu_time / 1000 % 1000),
+				profile[idx].cycles,
+				profile[idx].instructions
+			) < 0 || routine_name_write(fd, profile[idx].routine) < 0
+		) {
+
+			retval = GNUNET_WORKER_ERR_UNKNOWN;
+			break;
+
+		}
+
+	}
+
+
+	/* \                                 /\
+	\ */     free_and_exit:             /* \
+	 \/     _______________________     \ */
+
+
+	free(profile);
+	return retval;
+
+}
+
+
+/*  EOF  */
+
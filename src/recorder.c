@@ -0,0 +1,873 @@
+/*  -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+
+/*\
+|*|
+|*| libgnunetworker/src/recorder.c
+|*|
+|*| https://github.com/madmurphy/libgnunetworker
+|*|
+|*| Copyright (C) 2022 madmurphy <madmurphy333@gmail.com>
+|*|
+|*| **GNUnet Worker** is free software: you can redistribute it and/or modify
+|*| it under the terms of the GNU Affero General Public License as published by
+|*| the Free Software Foundation, either version 3 of the License, or (at your
+|*| option) any later version.
+|*|
+|*| **GNUnet Worker** is distributed in the hope that it will be useful, but
+|*| WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+|*| or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public
+|*| License for more details.
+|*|
+|*| You should have received a copy of the GNU Affero General Public License
+|*| along with this program. If not, see <http://www.gnu.org/licenses/>.
+|*|
+\*/
+
+
+/**
+
+	@file       recorder.c
+	@brief      A tracer that writes the timeline of the workers in the Chrome
+	            trace-event format
+
+**/
+
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <dlfcn.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_scheduler_lib.h>
+#include "include/gnunet_worker_lib.h"
+#include "recorder.h"
+
+
+/*
+
+The recorder is made of three parts:
+
+* A tracer (see `GNUNET_WORKER_set_tracer()`) that copies every event into a
+  ring buffer owned by the thread that reports it, without locks and without
+  system calls
+* A flusher thread that periodically empties all the buffers, turns the events
+  into JSON and writes them to the file descriptor
+* The two public functions that start and stop a recording session
+
+Events reported after a session has been stopped might remain in the buffers;
+the next session recognizes them by their timestamp and drops them.
+
+*/
+
+
+
+		/*\
+		|*|
+		|*|     LOCAL ENVIRONMENT
+		|*|    ________________________________
+		\*/
+
+
+
+	/*  CONSTANTS AND VARIABLES  */
+
+
+/**
+
+	@brief      The names of the stages of `GNUNET_WORKER_LifeStage`
+
+**/
+static const char * const STAGE_NAMES[] = {
+	"alive",
+	"says bye",
+	"dying",
+	"zombie",
+	"dead"
+};
+
+
+/**
+
+	@brief      The recorder of the process
+
+**/
+static RecorderState recorder = {
+	.buffers = NULL,
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+	.wake_flusher = PTHREAD_COND_INITIALIZER,
+	.session = 0,
+	.recording = false
+};
+
+
+/**
+
+	@brief      The buffer owned by this thread, or `NULL`
+
+**/
+_Thread_local static RecorderBuffer * own_buffer = NULL;
+
+
+/**
+
+	@brief      A key whose destructor gives a thread's buffer back when the
+	            thread exits
+
+**/
+static pthread_key_t own_buffer_key;
+
+
+/**
+
+	@brief      Make sure that `own_buffer_key` is created only once
+
+**/
+static pthread_once_t own_buffer_key_once = PTHREAD_ONCE_INIT;
+
+
+
+	/*  INLINED FUNCTIONS  */
+
+
+/**
+
+	@brief      Read the monotonic clock
+	@return     The current time in nanoseconds
+
+**/
+static inline uint64_t recorder_now (void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+}
+
+
+/**
+
+	@brief      Get an identifier of the current thread that matches what the
+	            system tools show
+	@return     The thread id
+
+**/
+static inline long current_thread_id (void) {
+	#ifdef __linux__
+	return syscall(SYS_gettid);
+	#else
+	return (long) (uintptr_t) pthread_self();
+	#endif
+}
+
+
+/**
+
+	@brief      Write everything in `RecorderState::output` to the file
+	            descriptor (flusher thread only)
+
+	Write errors are ignored: the recording goes on, with a hole.
+
+**/
+static inline void output_flush (void) {
+	size_t written = 0;
+	ssize_t chunk;
+	while (written < recorder.output_length) {
+		chunk = write(
+			recorder.fd,
+			recorder.output + written,
+			recorder.output_length - written
+		);
+		if (chunk < 0 && errno == EINTR) {
+			continue;
+		}
+		if (chunk <= 0) {
+			break;
+		}
+		written += chunk;
+	}
+	recorder.output_length = 0;
+}
+
+
+/**
+
+	@brief      Append formatted text to `RecorderState::output` (flusher
+	            thread only)
+	@param      format          A `printf()` format              [NON-NULLABLE]
+	@param      ...             The arguments of @p format
+
+**/
+static inline void output_printf (
+	const char * const format,
+	...
+) {
+	va_list args;
+	int length;
+	for (int attempt = 0; attempt < 2; attempt++) {
+		va_start(args, format);
+		length = vsnprintf(
+			recorder.output + recorder.output_length,
+			RECORDER_OUTPUT_SIZE - recorder.output_length,
+			format,
+			args
+		);
+		va_end(args);
+		if (length < 0) {
+			return;
+		}
+		if ((size_t) length < RECORDER_OUTPUT_SIZE - recorder.output_length) {
+			recorder.output_length += length;
+			return;
+		}
+		output_flush();
+	}
+}
+
+
+/**
+
+	@brief      Append the name of a routine to `RecorderState::output` as a
+	            JSON string (flusher thread only)
+	@param      routine         The routine to name                  [NULLABLE]
+
+	Routines that are not exported by any shared object are named after their
+	address.
+
+**/
+static inline void output_routine_name (
+	const GNUNET_CallbackRoutine routine
+) {
+	const void * const address = (const void *) (uintptr_t) routine;
+	Dl_info info;
+	if (
+		address && dladdr(address, &info) && info.dli_sname &&
+		info.dli_saddr == address
+	) {
+		output_printf("\"%s\"", info.dli_sname);
+	} else {
+		output_printf("\"0x%" PRIxPTR "\"", (uintptr_t) address);
+	}
+}
+
+
+/**
+
+	@brief      Append the fields shared by all the trace events to
+	            `RecorderState::output` (flusher thread only)
+	@param      phase           The Chrome trace-event phase     [NON-NULLABLE]
+	@param      category        The category of the event        [NON-NULLABLE]
+	@param      timestamp       The timestamp, in nanoseconds
+	@param      process_id      The id of this process
+	@param      thread_id       The id of the thread of the event
+
+**/
+static inline void output_common_fields (
+	const char * const phase,
+	const char * const category,
+	const uint64_t timestamp,
+	const long process_id,
+	const long thread_id
+) {
+	output_printf(
+		",\"ph\":\"%s\",\"cat\":\"%s\",\"ts\":%" PRIu64 ".%03u,"
+		"\"pid\":%ld,\"tid\":%ld",
+		phase,
+		category,
+		timestamp / 1000,
+		(unsigned int) (timestamp % 1000),
+		process_id,
+		thread_id
+	);
+}
+
+
+/**
+
+	@brief      Append the beginning or the end of the execution of a job to
+	            `RecorderState::output` (flusher thread only)
+	@param      event           The event to append              [NON-NULLABLE]
+	@param      phase           `"B"` or `"E"`                   [NON-NULLABLE]
+	@param      process_id      The id of this process
+	@param      thread_id       The id of the thread that has reported it
+
+**/
+static inline void output_job_execution (
+	const RecorderEvent * const event,
+	const char * const phase,
+	const long process_id,
+	const long thread_id
+) {
+	output_printf("{\"name\":");
+	output_routine_name(event->routine);
+	output_common_fields(phase, "job", event->timestamp, process_id, thread_id);
+	output_printf(
+		",\"args\":{\"data\":\"0x%" PRIxPTR "\",\"priority\":%u}},\n",
+		(uintptr_t) event->data,
+		(unsigned int) event->priority
+	);
+}
+
+
+/**
+
+	@brief      Append one recorded event to `RecorderState::output` (flusher
+	            thread only)
+	@param      event           The event to append              [NON-NULLABLE]
+	@param      process_id      The id of this process
+	@param      thread_id       The id of the thread that has reported it
+
+	Job executions become duration events (`B`/`E`), queue waits become
+	asynchronous events (`b`/`e`) that start in the pushing thread and end in
+	the worker thread, drains become complete events (`X`) and changes of
+	stage become instant events (`i`).
+
+**/
+static inline void output_event (
+	const RecorderEvent * const event,
+	const long process_id,
+	const long thread_id
+) {
+	switch (event->event) {
+
+		case GNUNET_WORKER_TRACE_START:
+
+			/*  The wait ends where the first execution begins (a periodic job
+				is enqueued only once)  */
+
+			if (!event->rerun) {
+
+				output_printf("{\"name\":");
+				output_routine_name(event->routine);
+				output_common_fields(
+					"e",
+					"wait",
+					event->timestamp,
+					process_id,
+					thread_id
+				);
+				output_printf(
+					",\"id\":\"0x%" PRIxPTR "\"},\n",
+					(uintptr_t) event->job
+				);
+
+			}
+
+			output_job_execution(event, "B", process_id, thread_id);
+			return;
+
+		case GNUNET_WORKER_TRACE_FINISH:
+
+			output_job_execution(event, "E", process_id, thread_id);
+			return;
+
+		case GNUNET_WORKER_TRACE_ENQUEUE:
+		case GNUNET_WORKER_TRACE_CANCEL:
+
+			/*  The wait of a periodic job has ended with its first run  */
+
+			if (event->rerun) {
+
+				return;
+
+			}
+
+			output_printf("{\"name\":");
+			output_routine_name(event->routine);
+			output_common_fields(
+				event->event == GNUNET_WORKER_TRACE_ENQUEUE ? "b" : "e",
+				"wait",
+				event->timestamp,
+				process_id,
+				thread_id
+			);
+			output_printf(
+				",\"id\":\"0x%" PRIxPTR "\",\"args\":{\"priority\":%u%s}},\n",
+				(uintptr_t) event->job,
+				(unsigned int) event->priority,
+				event->event == GNUNET_WORKER_TRACE_CANCEL ?
+					",\"cancelled\":true"
+				:
+					""
+			);
+			return;
+
+		case GNUNET_WORKER_TRACE_DRAIN:
+
+			output_printf("{\"name\":\"drain\"");
+			output_common_fields(
+				"X",
+				"worker",
+				event->timestamp,
+				process_id,
+				thread_id
+			);
+			output_printf(
+				",\"dur\":%" PRIu64 ".%03u,\"args\":{\"jobs\":%zu}},\n",
+				event->duration / 1000,
+				(unsigned int) (event->duration % 1000),
+				event->job_count
+			);
+			return;
+
+		case GNUNET_WORKER_TRACE_STATE:
+
+			output_printf(
+				"{\"name\":\"%s\"",
+				event->stage < sizeof(STAGE_NAMES) / sizeof(*STAGE_NAMES) ?
+					STAGE_NAMES[event->stage]
+				:
+					"unknown stage"
+			);
+			output_common_fields(
+				"i",
+				"worker",
+				event->timestamp,
+				process_id,
+				thread_id
+			);
+			output_printf(
+				",\"s\":\"t\",\"args\":{\"worker\":\"0x%" PRIxPTR "\"}},\n",
+				(uintptr_t) event->worker
+			);
+			return;
+
+	}
+}
+
+
+
+	/*  FUNCTIONS  */
+
+
+/**
+
+	@brief      Give the buffer of a thread that is exiting back
+	@param      v_buffer        The thread's buffer, passed as `void *`
+	                                                             [NON-NULLABLE]
+
+**/
+static void own_buffer_release (
+	void * const v_buffer
+) {
+
+	atomic_store_explicit(
+		&((RecorderBuffer *) v_buffer)->owned,
+		false,
+		memory_order_release
+	);
+
+}
+
+
+/**
+
+	@brief      Create `own_buffer_key`
+
+**/
+static void own_buffer_key_create (void) {
+
+	pthread_key_create(&own_buffer_key, &own_buffer_release);
+
+}
+
+
+/**
+
+	@brief      Take a buffer for the current thread, either left empty by a
+	            thread that has exited or newly allocated
+	@return     The buffer, or `NULL` if no memory is available
+
+**/
+static RecorderBuffer * own_buffer_claim (void) {
+
+	RecorderBuffer * buffer;
+	bool expected;
+
+	pthread_once(&own_buffer_key_once, &own_buffer_key_create);
+
+	for (
+		buffer = atomic_load_explicit(&recorder.buffers, memory_order_acquire);
+		buffer;
+		buffer = buffer->next
+	) {
+
+		expected = false;
+
+		if (
+			atomic_load_explicit(&buffer->owned, memory_order_relaxed) ||
+			!atomic_compare_exchange_strong_explicit(
+				&buffer->owned,
+				&expected,
+				true,
+				memory_order_acquire,
+				memory_order_relaxed
+			)
+		) {
+
+			continue;
+
+		}
+
+		/*  Only empty buffers are reused, or the events of the previous owner
+			would be attributed to us  */
+
+		if (
+			atomic_load_explicit(&buffer->head, memory_order_relaxed) ==
+				atomic_load_explicit(&buffer->tail, memory_order_acquire)
+		) {
+
+			goto take_ownership;
+
+		}
+
+		atomic_store_explicit(&buffer->owned, false, memory_order_release);
+
+	}
+
+	if (!(buffer = calloc(1, sizeof(RecorderBuffer)))) {
+
+		return NULL;
+
+	}
+
+	atomic_init(&buffer->head, 0);
+	atomic_init(&buffer->tail, 0);
+	atomic_init(&buffer->dropped, 0);
+	atomic_init(&buffer->owned, true);
+	buffer->next = atomic_load_explicit(&recorder.buffers, memory_order_relaxed);
+
+	while (
+		!atomic_compare_exchange_weak_explicit(
+			&recorder.buffers,
+			&buffer->next,
+			buffer,
+			memory_order_release,
+			memory_order_relaxed
+		)
+	);
+
+
+	/* \                                 /\
+	\ */     take_ownership:            /* \
+	 \/     _______________________     \ */
+
+
+	/*  These are published to the flusher by the first event  */
+
+	buffer->thread_id = current_thread_id();
+	buffer->named_in = 0;
+
+	if (pthread_getname_np(pthread_self(), buffer->thread_name, 16)) {
+
+		*buffer->thread_name = '\0';
+
+	}
+
+	pthread_setspecific(own_buffer_key, buffer);
+	return own_buffer = buffer;
+
+}
+
+
+/**
+
+	@brief      The tracer installed while a session is running
+	@param      record          The event to record              [NON-NULLABLE]
+	@param      unused          Unused
+
+**/
+static void recorder_trace (
+	const GNUNET_WORKER_TraceRecord * const record,
+	void * const unused
+) {
+
+	RecorderBuffer * const buffer =
+		own_buffer ? own_buffer : own_buffer_claim();
+
+	if (!buffer) {
+
+		return;
+
+	}
+
+	const size_t head =
+		atomic_load_explicit(&buffer->head, memory_order_relaxed);
+
+	if (
+		head - atomic_load_explicit(&buffer->tail, memory_order_acquire) >=
+			RECORDER_BUFFER_SIZE
+	) {
+
+		atomic_fetch_add_explicit(&buffer->dropped, 1, memory_order_relaxed);
+		return;
+
+	}
+
+	RecorderEvent * const event =
+		buffer->events + (head & (RECORDER_BUFFER_SIZE - 1));
+
+	event->timestamp = record->timestamp;
+	event->duration = record->duration;
+	event->job = record->job;
+	event->routine = record->routine;
+	event->data = record->data;
+	event->worker = record->worker;
+	event->job_count = record->job_count;
+	event->event = record->event;
+	event->priority = record->priority;
+	event->stage = record->stage;
+	event->rerun = record->rerun;
+	atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+
+}
+
+
+/**
+
+	@brief      The tracer of the recorder
+
+**/
+static const GNUNET_WORKER_Tracer recorder_tracer = {
+	.trace = &recorder_trace,
+	.data = NULL
+};
+
+
+/**
+
+	@brief      Empty all the buffers into the file descriptor (flusher thread
+	            only)
+	@param      session         The current session
+	@param      started_at      When the current session began
+	@param      process_id      The id of this process
+	@return     The number of events dropped since the last flush
+
+**/
+static uint64_t buffers_flush (
+	const unsigned long session,
+	const uint64_t started_at,
+	const long process_id
+) {
+
+	RecorderBuffer * buffer;
+	size_t tail, head;
+	uint64_t dropped = 0;
+
+	for (
+		buffer = atomic_load_explicit(&recorder.buffers, memory_order_acquire);
+		buffer;
+		buffer = buffer->next
+	) {
+
+		dropped += atomic_exchange_explicit(
+			&buffer->dropped,
+			0,
+			memory_order_relaxed
+		);
+
+		tail = atomic_load_explicit(&buffer->tail, memory_order_relaxed);
+		head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+
+		if (head == tail) {
+
+			continue;
+
+		}
+
+		if (buffer->named_in != session) {
+
+			buffer->named_in = session;
+
+			output_printf(
+				"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,"
+				"\"tid\":%ld,\"args\":{\"name\":\"%s\"}},\n",
+				process_id,
+				buffer->thread_id,
+				*buffer->thread_name ? buffer->thread_name : "thread"
+			);
+
+		}
+
+		for (; tail != head; tail++) {
+
+			const RecorderEvent * const event =
+				buffer->events + (tail & (RECORDER_BUFFER_SIZE - 1));
+
+			if (event->timestamp >= started_at) {
+
+				output_event(event, process_id, buffer->thread_id);
+
+			}
+
+		}
+
+		atomic_store_explicit(&buffer->tail, tail, memory_order_release);
+
+	}
+
+	output_flush();
+	return dropped;
+
+}
+
+
+/**
+
+	@brief      The flusher thread
+	@param      unused          Unused
+	@return     Nothing
+
+**/
+static void * flusher_routine (
+	void * const unused
+) {
+
+	struct timespec wake_at;
+	uint64_t dropped = 0;
+	const long process_id = getpid();
+
+	pthread_mutex_lock(&recorder.mutex);
+
+	const unsigned long session = recorder.session;
+	const uint64_t started_at = recorder.started_at;
+
+	output_printf("[\n");
+
+	while (!recorder.stopping) {
+
+		clock_gettime(CLOCK_REALTIME, &wake_at);
+		wake_at.tv_nsec += RECORDER_FLUSH_INTERVAL * 1000000L;
+
+		if (wake_at.tv_nsec >= 1000000000L) {
+
+			wake_at.tv_sec++;
+			wake_at.tv_nsec -= 1000000000L;
+
+		}
+
+		pthread_cond_timedwait(
+			&recorder.wake_flusher,
+			&recorder.mutex,
+			&wake_at
+		);
+
+		pthread_mutex_unlock(&recorder.mutex);
+		dropped += buffers_flush(session, started_at, process_id);
+		pthread_mutex_lock(&recorder.mutex);
+
+	}
+
+	pthread_mutex_unlock(&recorder.mutex);
+	dropped += buffers_flush(session, started_at, process_id);
+
+	/*  The last event has no trailing comma  */
+
+	output_printf(
+		"{\"name\":\"events dropped\",\"ph\":\"i\",\"s\":\"g\","
+		"\"ts\":%" PRIu64 ",\"pid\":%ld,\"tid\":0,\"args\":{\"count\":%"
+		PRIu64 "}}\n]\n",
+		recorder_now() / 1000,
+		process_id,
+		dropped
+	);
+
+	output_flush();
+	return NULL;
+
+}
+
+
+
+		/*\
+		|*|
+		|*|     GLOBAL ENVIRONMENT
+		|*|    ________________________________
+		\*/
+
+
+
+	/*  Please see the public header for the complete documentation  */
+
+
+/**
+
+	@brief      Start recording the timeline of all the workers
+
+*/
+int GNUNET_WORKER_start_trace_recorder (
+	const int fd
+) {
+
+	pthread_mutex_lock(&recorder.mutex);
+
+	if (recorder.recording) {
+
+		pthread_mutex_unlock(&recorder.mutex);
+		return GNUNET_WORKER_ERR_NOT_ALONE;
+
+	}
+
+	recorder.fd = fd;
+	recorder.session++;
+	recorder.started_at = recorder_now();
+	recorder.stopping = false;
+	recorder.output_length = 0;
+
+	if (pthread_create(&recorder.flusher, NULL, &flusher_routine, NULL)) {
+
+		pthread_mutex_unlock(&recorder.mutex);
+		return GNUNET_WORKER_ERR_THREAD_CREATE;
+
+	}
+
+	recorder.recording = true;
+	GNUNET_WORKER_set_tracer(&recorder_tracer);
+	pthread_mutex_unlock(&recorder.mutex);
+	return GNUNET_WORKER_SUCCESS;
+
+}
+
+
+/**
+
+	@brief      Stop recording the timeline of the workers
+
+*/
+bool GNUNET_WORKER_stop_trace_recorder (void) {
+
+	pthread_mutex_lock(&recorder.mutex);
+
+	if (!recorder.recording || recorder.stopping) {
+
+		pthread_mutex_unlock(&recorder.mutex);
+		return false;
+
+	}
+
+	GNUNET_WORKER_set_tracer(NULL);
+	recorder.stopping = true;
+	pthread_cond_signal(&recorder.wake_flusher);
+	pthread_mutex_unlock(&recorder.mutex);
+	pthread_join(recorder.flusher, NULL);
+	pthread_mutex_lock(&recorder.mutex);
+	recorder.recording = false;
+	pthread_mutex_unlock(&recorder.mutex);
+	return true;
+
+}
+
+
+/*  EOF  */
+
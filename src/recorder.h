@@ -0,0 +1,186 @@
+/*  -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4 -*-  */
+
+/*\
+|*|
+|*| libgnunetworker/src/recorder.h
+|*|
+|*| https://github.com/madmurphy/libgnunetworker
+|*|
+|*| Copyright (C) 2022 madmurphy <madmurphy333@gmail.com>
+|*|
+|*| **GNUnet Worker** is free software: you can redistribute it and/or modify
+|*| it under the terms of the GNU Affero General Public License as published by
+|*| the Free Software Foundation, either version 3 of the License, or (at your
+|*| option) any later version.
+|*|
+|*| **GNUnet Worker** is distributed in the hope that it will be useful, but
+|*| WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+|*| or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public
+|*| License for more details.
+|*|
+|*| You should have received a copy of the GNU Affero General Public License
+|*| along with this program. If not, see <http://www.gnu.org/licenses/>.
+|*|
+\*/
+
+
+/**
+
+    @file       recorder.h
+    @brief      GNUnet Worker trace recorder private header
+
+**/
+
+
+#ifndef __GNUNET_WORKER_RECORDER_PRIVATE_HEADER__
+#define __GNUNET_WORKER_RECORDER_PRIVATE_HEADER__
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "include/gnunet_worker_lib.h"
+
+
+/**
+
+    @brief      The number of events every thread can buffer before the
+                flusher thread empties its buffer (must be a power of two)
+
+    Events that do not fit are dropped and counted.
+
+**/
+#define RECORDER_BUFFER_SIZE 8192
+
+
+/**
+
+    @brief      How often the flusher thread empties the buffers, in
+                milliseconds
+
+**/
+#define RECORDER_FLUSH_INTERVAL 50
+
+
+/**
+
+    @brief      The size of the text buffer of the flusher thread
+
+**/
+#define RECORDER_OUTPUT_SIZE 65536
+
+
+_Static_assert(
+    !(RECORDER_BUFFER_SIZE & (RECORDER_BUFFER_SIZE - 1)),
+    "RECORDER_BUFFER_SIZE must be a power of two"
+);
+
+
+/**
+
+    @brief      A compact copy of a `GNUNET_WORKER_TraceRecord`
+
+**/
+typedef struct RecorderEvent {
+    uint64_t
+        timestamp,                  /**< See `GNUNET_WORKER_TraceRecord` **/
+        duration;                   /**< See `GNUNET_WORKER_TraceRecord` **/
+    const void
+        * job;                      /**< See `GNUNET_WORKER_TraceRecord` **/
+    GNUNET_CallbackRoutine
+        routine;                    /**< See `GNUNET_WORKER_TraceRecord` **/
+    void
+        * data;                     /**< See `GNUNET_WORKER_TraceRecord` **/
+    GNUNET_WORKER_Handle
+        worker;                     /**< See `GNUNET_WORKER_TraceRecord` **/
+    size_t
+        job_count;                  /**< See `GNUNET_WORKER_TraceRecord` **/
+    uint8_t
+        event,                      /**< A `GNUNET_WORKER_TraceEvent` **/
+        priority,                   /**< An `enum GNUNET_SCHEDULER_Priority`
+                                         **/
+        stage;                      /**< A `GNUNET_WORKER_LifeStage` **/
+    bool
+        rerun;                      /**< See `GNUNET_WORKER_TraceRecord` **/
+} RecorderEvent;
+
+
+/**
+
+    @brief      The events recorded by one thread, waiting for the flusher
+
+    Every buffer is a single-producer single-consumer ring: only the thread
+    that owns it advances `::head`, only the flusher thread advances `::tail`.
+    Buffers are never freed: when a thread exits its buffer is left for the
+    next thread that needs one (see `RecorderBuffer::owned`).
+
+**/
+typedef struct RecorderBuffer {
+    struct RecorderBuffer
+        * next;                     /**< The next buffer in
+                                         `RecorderState::buffers` **/
+    atomic_size_t
+        head,                       /**< Atomic; the number of events ever
+                                         written **/
+        tail;                       /**< Atomic; the number of events ever
+                                         read **/
+    atomic_uint_fast64_t
+        dropped;                    /**< Atomic; the events that did not fit
+                                         **/
+    atomic_bool
+        owned;                      /**< Atomic; a thread is using the buffer
+                                         **/
+    long
+        thread_id;                  /**< The owner's thread id **/
+    char
+        thread_name[16];            /**< The owner's thread name **/
+    unsigned long
+        named_in;                   /**< The session in which the flusher has
+                                         written the name of the owner (flusher
+                                         thread only) **/
+    RecorderEvent
+        events[RECORDER_BUFFER_SIZE];   /**< The ring **/
+} RecorderBuffer;
+
+
+/**
+
+    @brief      The state of the (only) trace recorder of the process
+
+**/
+typedef struct RecorderState {
+    _Atomic(RecorderBuffer *)
+        buffers;                    /**< Atomic; every buffer ever allocated
+                                         (a lock-free stack) **/
+    pthread_mutex_t
+        mutex;                      /**< Protects all the fields below **/
+    pthread_cond_t
+        wake_flusher;               /**< Signalled when the recording stops **/
+    pthread_t
+        flusher;                    /**< The flusher thread **/
+    uint64_t
+        started_at;                 /**< When the session began; events
+                                         older than this are stale **/
+    unsigned long
+        session;                    /**< The number of sessions ever started
+                                         **/
+    int
+        fd;                         /**< Where the trace is written **/
+    bool
+        recording,                  /**< A session is running **/
+        stopping;                   /**< The session is being stopped **/
+    size_t
+        output_length;              /**< The bytes in `::output` (flusher
+                                         thread only) **/
+    char
+        output[RECORDER_OUTPUT_SIZE];   /**< The text waiting to be written
+                                             (flusher thread only) **/
+} RecorderState;
+
+
+#endif
+
+
+/*  EOF  */
+
@@ -27,7 +27,7 @@
 /**
 
 	@file       requirement.h
-	@brief      Blocking requirements using POSIX Threads
+	@brief      Blocking requirements using futexes (Linux) or POSIX Threads
 
 **/
 
@@ -36,28 +36,225 @@
 #define __REQUIREMENT_H__
 
 
+#ifdef __linux__
+#include <stdatomic.h>
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#else
+#include <errno.h>
 #include <pthread.h>
+#endif
+
+
+/**
+	@brief      Possible initialization values of a requirement
+**/
+enum REQUIREMENT_InitValue {
+	REQ_INIT_GREEN = 0,
+	REQ_INIT_RED = 1
+};
+
+
+#ifdef __linux__
+
+
+/**
+	@brief      The bit of `Requirement::req_word` that tells that someone is
+	            waiting for the requirement to become green
+**/
+#define REQ_WAITERS 0x80000000u
 
 
 /**
 	@brief      A `Requirement` is a data type that can be read or updated by
 	            one thread at a time, and can be unfulfilled to a variable
 	            degree (red) or fullfilled (green)
+
+	The whole requirement is one futex word: the lower 31 bits hold the
+	unfulfillment, the highest bit (`REQ_WAITERS`) is set by the threads that
+	go to sleep waiting for green, so that painting never enters the kernel
+	unless somebody waits.
 **/
 typedef struct Requirement {
-	pthread_cond_t req_cond;		/**< The requirement's condition **/
-	pthread_mutex_t req_mutex;		/**< The requirement's mutex **/
-	unsigned int req_unfulfillment;	/**< The requirement's unfulfillment **/
+	_Atomic uint32_t req_word;		/**< The requirement's unfulfillment and
+										 `REQ_WAITERS` **/
 } Requirement;
 
 
 /**
-	@brief      Possible initialization values of a requirement
+	@brief      Initialize a requirement
+	@param      requirement     The requirement to init
+	@param      initial_value   The initial value to assign to the requirement
 **/
-enum REQUIREMENT_InitValue {
-	REQ_INIT_GREEN = 0,
-	REQ_INIT_RED = 1
-};
+static inline void requirement_init (
+	Requirement * const requirement,
+	const enum REQUIREMENT_InitValue initial_value
+) {
+	atomic_init(&requirement->req_word, initial_value);
+}
+
+
+/**
+	@brief      Uninitialize a requirement
+	@param      requirement     The requirement to destroy
+**/
+static inline void requirement_uninit (
+	Requirement * const requirement
+) {
+	(void) requirement;
+}
+
+
+/**
+	@brief      Mark a requirement as "unfulfilled"
+	@param      requirement     The requirement to mark as unfulfilled
+**/
+static inline void requirement_paint_red (
+	Requirement * const requirement
+) {
+	atomic_fetch_add_explicit(&requirement->req_word, 1, memory_order_acq_rel);
+}
+
+
+/**
+	@brief      Mark a requirement as "fulfilled"
+	@param      requirement     The requirement to mark as fulfilled
+
+	Painting green a requirement that is green already has no effect.
+**/
+static inline void requirement_paint_green (
+	Requirement * const requirement
+) {
+	uint32_t old_word =
+		atomic_load_explicit(&requirement->req_word, memory_order_relaxed);
+	uint32_t new_word;
+	do {
+		if (!(old_word & ~REQ_WAITERS)) {
+			return;
+		}
+		new_word = old_word - 1;
+		if (!(new_word & ~REQ_WAITERS)) {
+			new_word = 0;
+		}
+	} while (
+		!atomic_compare_exchange_weak_explicit(
+			&requirement->req_word,
+			&old_word,
+			new_word,
+			memory_order_acq_rel,
+			memory_order_relaxed
+		)
+	);
+	if (!new_word && (old_word & REQ_WAITERS)) {
+		syscall(
+			SYS_futex,
+			&requirement->req_word,
+			FUTEX_WAKE_PRIVATE,
+			INT_MAX,
+			NULL,
+			NULL,
+			0
+		);
+	}
+}
+
+
+/**
+	@brief      Wait until a requirement is fulfilled, with an optional time
+	            limit
+	@param      requirement     The requirement to wait for
+	@param      absolute_time   The absolute time (`CLOCK_REALTIME`) to wait
+	                            until, or `NULL` for waiting indefinitely
+	@return     `0`, `ETIMEDOUT` or `EINVAL`, like
+	            `pthread_cond_timedwait()`
+**/
+static inline int requirement_futex_wait (
+	Requirement * const requirement,
+	const struct timespec * const absolute_time
+) {
+	uint32_t word;
+	while (
+		(
+			word = atomic_load_explicit(
+				&requirement->req_word,
+				memory_order_acquire
+			)
+		) & ~REQ_WAITERS
+	) {
+		if (
+			!(word & REQ_WAITERS) &&
+			!atomic_compare_exchange_weak_explicit(
+				&requirement->req_word,
+				&word,
+				word | REQ_WAITERS,
+				memory_order_relaxed,
+				memory_order_relaxed
+			)
+		) {
+			continue;
+		}
+		if (
+			syscall(
+				SYS_futex,
+				&requirement->req_word,
+				FUTEX_WAIT_BITSET_PRIVATE | FUTEX_CLOCK_REALTIME,
+				word | REQ_WAITERS,
+				absolute_time,
+				NULL,
+				FUTEX_BITSET_MATCH_ANY
+			) && (errno == ETIMEDOUT || errno == EINVAL)
+		) {
+			return errno;
+		}
+	}
+	return 0;
+}
+
+
+/**
+	@brief      Wait until a requirement is fulfilled
+	@param      requirement     The requirement to wait for
+	@return     `0`
+**/
+static inline int requirement_wait_for_green (
+	Requirement * const requirement
+) {
+	return requirement_futex_wait(requirement, NULL);
+}
+
+
+/**
+	@brief      Wait until a requirement is fulfilled, with a time limit
+	@param      requirement     The requirement to wait for
+	@param      absolute_time   The absolute time to wait until
+	@return     `0`, `ETIMEDOUT` or `EINVAL`, like `pthread_cond_timedwait()`
+**/
+static inline int requirement_timedwait_for_green (
+	Requirement * const requirement,
+	const struct timespec * const absolute_time
+) {
+	return requirement_futex_wait(requirement, absolute_time);
+}
+
+
+#else
+
+
+/**
+	@brief      A `Requirement` is a data type that can be read or updated by
+	            one thread at a time, and can be unfulfilled to a variable
+	            degree (red) or fullfilled (green)
+**/
+typedef struct Requirement {
+	pthread_cond_t req_cond;		/**< The requirement's condition **/
+	pthread_mutex_t req_mutex;		/**< The requirement's mutex **/
+	unsigned int req_unfulfillment;	/**< The requirement's unfulfillment **/
+} Requirement;
 
 
 /**
@@ -109,10 +306,10 @@ static inline void requirement_paint_green (
 ) {
 	pthread_mutex_lock(&requirement->req_mutex);
 	if (
-		requirement->req_unfulfillment < 1 ||
+		requirement->req_unfulfillment > 0 &&
 		--requirement->req_unfulfillment < 1
 	) {
-		pthread_cond_signal(&requirement->req_cond);
+		pthread_cond_broadcast(&requirement->req_cond);
 	}
 	pthread_mutex_unlock(&requirement->req_mutex);
 }
@@ -128,7 +325,7 @@ static inline int requirement_wait_for_green (
 ) {
 	int retval = 0;
 	pthread_mutex_lock(&requirement->req_mutex);
-	while (requirement->req_unfulfillment) {
+	while (!retval && requirement->req_unfulfillment) {
 		retval = pthread_cond_wait(
 			&requirement->req_cond,
 			&requirement->req_mutex
@@ -151,7 +348,7 @@ static inline int requirement_timedwait_for_green (
 ) {
 	int retval = 0;
 	pthread_mutex_lock(&requirement->req_mutex);
-	while (requirement->req_unfulfillment) {
+	while (!retval && requirement->req_unfulfillment) {
 		retval = pthread_cond_timedwait(
 			&requirement->req_cond,
 			&requirement->req_mutex,
@@ -166,5 +363,8 @@ static inline int requirement_timedwait_for_green (
 #endif
 
 
+#endif
+
+
 /*  EOF  */
 
@@ -0,0 +1,323 @@
+/*  -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*-  */
+
+/*\
+|*|
+|*| libgnunetworker/src/slots.c
+|*|
+|*| https://github.com/madmurphy/libgnunetworker
+|*|
+|*| Copyright (C) 2022 madmurphy <madmurphy333@gmail.com>
+|*|
+|*| **GNUnet Worker** is free software: you can redistribute it and/or modify
+|*| it under the terms of the GNU Affero General Public License as published by
+|*| the Free Software Foundation, either version 3 of the License, or (at your
+|*| option) any later version.
+|*|
+|*| **GNUnet Worker** is distributed in the hope that it will be useful, but
+|*| WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+|*| or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public
+|*| License for more details.
+|*|
+|*| You should have received a copy of the GNU Affero General Public License
+|*| along with this program. If not, see <http://www.gnu.org/licenses/>.
+|*|
+\*/
+
+
+/**
+
+	@file       slots.c
+	@brief      The process-wide table that turns worker identifiers into
+	            handles
+
+**/
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_scheduler_lib.h>
+#include "include/gnunet_worker_lib.h"
+#include "slots.h"
+
+
+/*
+
+The table is made of chunks of slots that are allocated when needed and never
+freed, so that looking up a slot takes no lock and a stale identifier can never
+lead to unmapped memory. Only assigning and giving back slots take the mutex of
+the table, which happens when workers are created and freed.
+
+A thread that uses a worker through its identifier "pins" the slot: the pin
+succeeds only if the generation of the slot still matches the identifier, and
+the slot cannot be given back while it is pinned.
+
+*/
+
+
+
+		/*\
+		|*|
+		|*|     LOCAL ENVIRONMENT
+		|*|    ________________________________
+		\*/
+
+
+
+	/*  CONSTANTS AND VARIABLES  */
+
+
+/**
+
+	@brief      The chunks of the table (`NULL` until allocated)
+
+**/
+static _Atomic(WorkerSlot *) slot_chunks[SLOTS_MAX_CHUNKS];
+
+
+/**
+
+	@brief      Protects `slot_chunk_count`, `first_free_slot` and
+	            `WorkerSlot::next_free`
+
+**/
+static pthread_mutex_t slots_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+/**
+
+	@brief      The number of chunks allocated
+
+**/
+static uint32_t slot_chunk_count = 0;
+
+
+/**
+
+	@brief      The index plus one of the first free slot, or `0`
+
+**/
+static uint32_t first_free_slot = 0;
+
+
+
+	/*  INLINED FUNCTIONS  */
+
+
+/**
+
+	@brief      Find the slot of an identifier
+	@param      worker_id       The identifier to look up
+	@return     The slot, or `NULL` if @p worker_id cannot exist
+
+**/
+static inline WorkerSlot * slot_lookup (
+	const GNUNET_WORKER_Id worker_id
+) {
+	const uint32_t index = (uint32_t) worker_id - 1;
+	if (!(uint32_t) worker_id || index / SLOTS_CHUNK_SIZE >= SLOTS_MAX_CHUNKS) {
+		return NULL;
+	}
+	WorkerSlot * const chunk = atomic_load_explicit(
+		slot_chunks + index / SLOTS_CHUNK_SIZE,
+		memory_order_acquire
+	);
+	return chunk ? chunk + (index & (SLOTS_CHUNK_SIZE - 1)) : NULL;
+}
+
+
+
+		/*\
+		|*|
+		|*|     SHARED ENVIRONMENT
+		|*|    ________________________________
+		\*/
+
+
+
+	/*  Please see `slots.h` for the complete documentation  */
+
+
+/**
+
+	@brief      Give a new worker a slot in the identifier table
+
+*/
+GNUNET_WORKER_Id GNUNET_WORKER_slot_assign (
+	const GNUNET_WORKER_Handle worker
+) {
+
+	WorkerSlot * slot;
+	uint32_t index;
+
+	pthread_mutex_lock(&slots_mutex);
+
+	if (!first_free_slot) {
+
+		if (slot_chunk_count >= SLOTS_MAX_CHUNKS) {
+
+			goto unlock_and_fail;
+
+		}
+
+		/*  All-zero bits are a valid initial state for lock-free atomics  */
+
+		WorkerSlot * const chunk = calloc(SLOTS_CHUNK_SIZE, sizeof(WorkerSlot));
+
+		if (!chunk) {
+
+			goto unlock_and_fail;
+
+		}
+
+		index = slot_chunk_count * SLOTS_CHUNK_SIZE;
+
+		for (uint32_t idx = 0; idx < SLOTS_CHUNK_SIZE - 1; idx++) {
+
+			chunk[idx].next_free = index + idx + 2;
+
+		}
+
+		first_free_slot = index + 1;
+
+		atomic_store_explicit(
+			slot_chunks + slot_chunk_count++,
+			chunk,
+			memory_order_release
+		);
+
+	}
+
+	index = first_free_slot - 1;
+	slot = slot_lookup(first_free_slot);
+	first_free_slot = slot->next_free;
+	pthread_mutex_unlock(&slots_mutex);
+
+	/*  Nobody can pin the slot before the identifier has been given away  */
+
+	atomic_store_explicit(&slot->worker, worker, memory_order_release);
+
+	return
+		(
+			atomic_load_explicit(&slot->state, memory_order_relaxed) &
+			~SLOT_PINS_MASK
+		) | (index + 1);
+
+
+	/* \                                 /\
+	\ */     unlock_and_fail:           /* \
+	 \/     _______________________     \ */
+
+
+	pthread_mutex_unlock(&slots_mutex);
+	return 0;
+
+}
+
+
+/**
+
+	@brief      Make all the identifiers of a worker stale and give its slot
+	            back
+
+*/
+void GNUNET_WORKER_slot_revoke (
+	const GNUNET_WORKER_Id worker_id
+) {
+
+	WorkerSlot * const slot = slot_lookup(worker_id);
+
+	atomic_fetch_add_explicit(
+		&slot->state,
+		SLOT_GENERATION_UNIT,
+		memory_order_acq_rel
+	);
+
+	/*  Pins last as long as one push, hence yielding is enough  */
+
+	while (
+		atomic_load_explicit(&slot->state, memory_order_acquire) &
+			SLOT_PINS_MASK
+	) {
+
+		sched_yield();
+
+	}
+
+	pthread_mutex_lock(&slots_mutex);
+	slot->next_free = first_free_slot;
+	first_free_slot = (uint32_t) worker_id;
+	pthread_mutex_unlock(&slots_mutex);
+
+}
+
+
+
+/**
+
+	@brief      Get the worker of an identifier and prevent it from being freed
+
+*/
+GNUNET_WORKER_Handle GNUNET_WORKER_slot_pin (
+	const GNUNET_WORKER_Id worker_id
+) {
+
+	WorkerSlot * const slot = slot_lookup(worker_id);
+
+	if (!slot) {
+
+		return NULL;
+
+	}
+
+	uint64_t state = atomic_load_explicit(&slot->state, memory_order_relaxed);
+
+	do {
+
+		if ((state ^ worker_id) & ~SLOT_PINS_MASK) {
+
+			/*  Stale identifier  */
+
+			return NULL;
+
+		}
+
+	} while (
+		!atomic_compare_exchange_weak_explicit(
+			&slot->state,
+			&state,
+			state + 1,
+			memory_order_acquire,
+			memory_order_relaxed
+		)
+	);
+
+	return atomic_load_explicit(&slot->worker, memory_order_acquire);
+
+}
+
+
+/**
+
+	@brief      Undo `GNUNET_WORKER_slot_pin()`
+
+*/
+void GNUNET_WORKER_slot_unpin (
+	const GNUNET_WORKER_Id worker_id
+) {
+
+	atomic_fetch_sub_explicit(
+		&slot_lookup(worker_id)->state,
+		1,
+		memory_order_release
+	);
+
+}
+
+
+/*  EOF  */
+
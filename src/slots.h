@@ -0,0 +1,172 @@
+/*  -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4 -*-  */
+
+/*\
+|*|
+|*| libgnunetworker/src/slots.h
+|*|
+|*| https://github.com/madmurphy/libgnunetworker
+|*|
+|*| Copyright (C) 2022 madmurphy <madmurphy333@gmail.com>
+|*|
+|*| **GNUnet Worker** is free software: you can redistribute it and/or modify
+|*| it under the terms of the GNU Affero General Public License as published by
+|*| the Free Software Foundation, either version 3 of the License, or (at your
+|*| option) any later version.
+|*|
+|*| **GNUnet Worker** is distributed in the hope that it will be useful, but
+|*| WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+|*| or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public
+|*| License for more details.
+|*|
+|*| You should have received a copy of the GNU Affero General Public License
+|*| along with this program. If not, see <http://www.gnu.org/licenses/>.
+|*|
+\*/
+
+
+/**
+
+    @file       slots.h
+    @brief      GNUnet Worker identifier table private header
+
+**/
+
+
+#ifndef __GNUNET_WORKER_SLOTS_PRIVATE_HEADER__
+#define __GNUNET_WORKER_SLOTS_PRIVATE_HEADER__
+
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "include/gnunet_worker_lib.h"
+
+
+/**
+
+    @brief      The number of slots allocated at once (must be a power of two)
+
+**/
+#define SLOTS_CHUNK_SIZE 1024
+
+
+/**
+
+    @brief      The maximum number of chunks of slots
+
+    The table can thus hold up to `SLOTS_CHUNK_SIZE * SLOTS_MAX_CHUNKS` workers
+    at once.
+
+**/
+#define SLOTS_MAX_CHUNKS 4096
+
+
+/**
+
+    @brief      The bits of `WorkerSlot::state` that count the pins
+
+**/
+#define SLOT_PINS_MASK UINT64_C(0xffffffff)
+
+
+/**
+
+    @brief      The amount added to `WorkerSlot::state` when its generation
+                changes
+
+**/
+#define SLOT_GENERATION_UNIT (UINT64_C(1) << 32)
+
+
+_Static_assert(
+    !(SLOTS_CHUNK_SIZE & (SLOTS_CHUNK_SIZE - 1)),
+    "SLOTS_CHUNK_SIZE must be a power of two"
+);
+
+
+/**
+
+    @brief      The entry of one worker in the identifier table
+
+    A `GNUNET_WORKER_Id` holds the generation of the slot in its upper 32 bits
+    and the index of the slot plus one in its lower 32 bits. When a worker is
+    freed the generation of its slot is increased, so that all its identifiers
+    become stale at once.
+
+**/
+typedef struct WorkerSlot {
+    atomic_uint_fast64_t
+        state;                      /**< Atomic; the generation in the upper
+                                         32 bits, the threads that are using
+                                         the worker ("pins") in the lower 32
+                                         bits **/
+    _Atomic(GNUNET_WORKER_Handle)
+        worker;                     /**< Atomic; the worker of the current
+                                         generation **/
+    uint32_t
+        next_free;                  /**< The index plus one of the next free
+                                         slot, or `0` (protected by the mutex
+                                         of the table) **/
+} WorkerSlot;
+
+
+/**
+
+    @brief      Give a new worker a slot in the identifier table
+    @param      worker          The new worker                   [NON-NULLABLE]
+    @return     The identifier of @p worker, or `0` if no memory is available
+
+**/
+extern GNUNET_WORKER_Id GNUNET_WORKER_slot_assign (
+    const GNUNET_WORKER_Handle worker
+);
+
+
+/**
+
+    @brief      Make all the identifiers of a worker stale and give its slot
+                back
+    @param      worker_id       The identifier of the worker that is being
+                                freed
+
+    The function waits until no thread has the worker pinned anymore (see
+    `GNUNET_WORKER_slot_pin()`).
+
+**/
+extern void GNUNET_WORKER_slot_revoke (
+    const GNUNET_WORKER_Id worker_id
+);
+
+
+
+/**
+
+    @brief      Get the worker of an identifier and prevent it from being freed
+    @param      worker_id       The identifier to look up
+    @return     The worker, or `NULL` if @p worker_id is stale or invalid
+
+    Every successful call must be followed as soon as possible by a call to
+    `GNUNET_WORKER_slot_unpin()`, since whoever frees the worker waits for it.
+
+**/
+extern GNUNET_WORKER_Handle GNUNET_WORKER_slot_pin (
+    const GNUNET_WORKER_Id worker_id
+);
+
+
+/**
+
+    @brief      Allow the worker of an identifier to be freed again
+    @param      worker_id       An identifier successfully passed to
+                                `GNUNET_WORKER_slot_pin()`
+
+**/
+extern void GNUNET_WORKER_slot_unpin (
+    const GNUNET_WORKER_Id worker_id
+);
+
+
+#endif
+
+
+/*  EOF  */
+
@@ -35,14 +35,28 @@
 #define _GNU_SOURCE
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <strings.h>
 #include <stdatomic.h>
 #include <time.h>
 #include <errno.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <sched.h>
 #include <libintl.h>
+#ifdef WORKER_USE_EVENTFD
+#include <sys/eventfd.h>
+#endif
+#ifdef WORKER_USE_SDT
+#include <sys/sdt.h>
+#endif
+#ifdef __linux__
+#include <linux/futex.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
 #include <gnunet/platform.h>
 #include <gnunet/gnunet_scheduler_lib.h>
 #include <gnunet/gnunet_network_lib.h>
@@ -82,6 +96,17 @@ Some rules of thumb:
 	/*  CONSTANTS AND VARIABLES  */
 
 
+#ifdef WORKER_USE_EVENTFD
+
+/**
+
+	@brief      A "beep" for notifying the worker (added to its eventfd counter)
+
+**/
+static const uint64_t BEEP_CODE = 1;
+
+#else
+
 /**
 
 	@brief      A "beep" for notifying the worker (any ASCII character will do)
@@ -89,6 +114,8 @@ Some rules of thumb:
 **/
 static const unsigned char BEEP_CODE = '\a';
 
+#endif
+
 
 /**
 
@@ -98,1698 +125,5353 @@ static const unsigned char BEEP_CODE = '\a';
 _Thread_local static GNUNET_WORKER_Handle currently_serving_as = NULL;
 
 
+/**
 
-	/*  INLINED FUNCTIONS  */
+	@brief      The spare job nodes owned by this thread
+
+	Nodes in here are ordinary heap blocks: they can be used for pushing load
+	into any worker, no matter which worker's pool they came from.
+
+**/
+_Thread_local static struct JobCache {
+	GNUNET_WORKER_JobList * spare;  /**< A chain of spare nodes **/
+	bool registered;                /**< `job_cache_key` has been set **/
+} job_cache = { NULL, false };
 
 
 /**
 
-	@brief      Create a detached thread
-	@param      start_routine   The routine to launch in a new detached thread
-	                                                             [NON-NULLABLE]
-	@param      data            The routine's argument               [NULLABLE]
+	@brief      A key whose destructor frees a thread's spare job nodes when
+	            the thread exits
 
 **/
-static inline int thread_create_detached (
-	const __thread_ftype__ start_routine,
-	void * const data
-) {
-	pthread_t thr;
-	pthread_attr_t tattr;
-	pthread_attr_init(&tattr);
-	pthread_attr_setdetachstate(&tattr, PTHREAD_CREATE_DETACHED);
-	const int retval = pthread_create(&thr, &tattr, start_routine, data);
-	pthread_attr_destroy(&tattr);
-	return retval;
-}
+static pthread_key_t job_cache_key;
 
 
 /**
 
-	@brief      Launch `GNUNET_SCHEDULER_cancel()` on a pointer to a scheduled
-	            task and set the pointer to `NULL`
-	@param      tsk_ptr         A pointer to a pointer to a scheduled task
-	                                                             [NON-NULLABLE]
-
-	The @p tsk_ptr paramenter cannot be `NULL`, however it can point to `NULL`.
-	If that is the case this function is no-op.
+	@brief      Make sure that `job_cache_key` is created only once
 
 **/
-static inline void clear_schedule (
-	struct GNUNET_SCHEDULER_Task ** const tsk_ptr
-) {
-	struct GNUNET_SCHEDULER_Task * const tmp = *tsk_ptr;
-	if (tmp) {
-		*tsk_ptr = NULL;
-		GNUNET_SCHEDULER_cancel(tmp);
-	}
-}
+static pthread_once_t job_cache_key_once = PTHREAD_ONCE_INIT;
 
 
 /**
 
-	@brief      Free a pointed `GNUNET_WORKER_JobList` and set the pointer to
+	@brief      The tracer installed via `GNUNET_WORKER_set_tracer()`, or
 	            `NULL`
-	@param      jlst_ptr        The pointer to set to `NULL`     [NON-NULLABLE]
-
-	The @p jlst_ptr paramenter cannot be `NULL`, however it can point to
-	`NULL`. If that is the case this function is no-op.
 
 **/
-static inline void job_list_clear_unlocked (
-	GNUNET_WORKER_JobList ** const jlst_ptr
-) {
-	GNUNET_WORKER_JobList * iter;
-	if ((iter = *jlst_ptr)) {
-		*jlst_ptr = NULL;
-		while (iter->next) {
-			free((iter = iter->next)->prev);
-		}
-		free(iter);
-	}
-}
+static _Atomic(const GNUNET_WORKER_Tracer *) current_tracer = NULL;
 
 
 /**
 
-	@brief      Lock a mutex, free a pointed `GNUNET_WORKER_JobList`, set the
-	            pointer to `NULL` and unlock the mutex
-	@param      jlst_ptr        The pointer to set to `NULL`     [NON-NULLABLE]
-	@param      mutex_ptr       The mutex to lock and unlock     [NON-NULLABLE]
-
-	The @p jlst_ptr paramenter cannot be `NULL`, however it can point to
-	`NULL`. If that is the case this function is no-op.
+	@brief      Incremented by `GNUNET_WORKER_set_tracer()` every time it
+	            installs a tracer; its parity tells the threads that are
+	            entering a tracer which of `tracer_calls` they must use
 
 **/
-static inline void job_list_clear_locked (
-	GNUNET_WORKER_JobList ** const jlst_ptr,
-	pthread_mutex_t * const mutex_ptr
-) {
-	pthread_mutex_lock(mutex_ptr);
-	job_list_clear_unlocked(jlst_ptr);
-	pthread_mutex_unlock(mutex_ptr);
-}
+static atomic_uint tracer_epoch = 0;
 
 
 /**
 
-	@brief      Undo what `GNUNET_WORKER_allocate()` did
-	@param      worker          The worker to free               [NON-NULLABLE]
-
-	@note   The two linked lists `GNUNET_WORKER_Instance::schedules` and
-	        `GNUNET_WORKER_Instance::wishlist` must be freed separately before
-	        calling this function.
+	@brief      The threads that are inside a tracer, for each parity of
+	            `tracer_epoch` (see `tracer_enter()`)
 
 **/
-static inline void GNUNET_WORKER_unallocate (
-	const GNUNET_WORKER_Handle worker
-) {
-	close(worker->beep_fd[0]);
-	close(worker->beep_fd[1]);
-	GNUNET_NETWORK_fdset_destroy(worker->beep_fds);
-	requirement_uninit(&worker->scheduler_has_returned);
-	requirement_uninit(&worker->worker_is_disposable);
-	pthread_mutex_destroy(&worker->wishes_mutex);
-	pthread_mutex_destroy(&worker->kill_mutex);
-	free(worker);
-}
+static atomic_uint tracer_calls[2];
 
 
 /**
 
-	@brief      Clear the environment and undo what `GNUNET_WORKER_allocate()`
-	            did
-	@param      worker          The worker to dispose            [NON-NULLABLE]
+	@brief      Serializes `GNUNET_WORKER_set_tracer()`
 
-	Please lock the `worker->kill_mutex` mutex before calling this function and
-	never unlock it.
+**/
+static pthread_mutex_t tracer_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-	The worker thread must not paint `worker->worker_is_disposable` red before
-	invoking this function, or it will hang forever.
 
-	@note   The two linked lists `GNUNET_WORKER_Instance::schedules` and
-	        `GNUNET_WORKER_Instance::wishlist` must be freed separately before
-	        calling this function.
+
+#ifndef __linux__
+
+/**
+
+	@brief      The mutex used for waiting for synchronous calls where futexes
+	            are not available
 
 **/
-static inline void GNUNET_WORKER_dispose (
-	const GNUNET_WORKER_Handle worker
-) {
-	requirement_paint_green(&worker->scheduler_has_returned);
-	requirement_wait_for_green(&worker->worker_is_disposable);
-	currently_serving_as = NULL;
-	pthread_mutex_unlock(&worker->kill_mutex);
-	GNUNET_WORKER_unallocate(worker);
-}
+static pthread_mutex_t calls_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 
 /**
 
-	@brief      Clear the environment and undo what `GNUNET_WORKER_allocate()`
-	            did, but only if the worker was installed into a pre-existing
-	            scheduler via `GNUNET_WORKER_adopt_running_scheduler()`.
-	@param      worker          The worker to dispose            [NON-NULLABLE]
+	@brief      The condition broadcast every time a synchronous call completes
+	            where futexes are not available
 
-	Please lock the `worker->kill_mutex` mutex before calling this function and
-	never unlock it.
+**/
+static pthread_cond_t calls_cond = PTHREAD_COND_INITIALIZER;
 
-	If the worker is not a guest worker `GNUNET_WORKER_dispose()` will be
-	invoked later by `scheduler_launcher()`.
 
-	The worker thread must not paint `worker->worker_is_disposable` red before
-	invoking this function, or it might hang forever.
+/**
 
-	@note   The two linked lists `GNUNET_WORKER_Instance::schedules` and
-	        `GNUNET_WORKER_Instance::wishlist` must be freed separately before
-	        calling this function.
+	@brief      The mutex used by the disposers for waiting for the public
+	            calls in flight where futexes are not available
 
 **/
-static inline void GNUNET_WORKER_dispose_if_guest (
-	const GNUNET_WORKER_Handle worker
-) {
-	if (worker->flags & WORKER_FLAG_IS_GUEST) {
-		GNUNET_WORKER_dispose(worker);
-	}
-}
+static pthread_mutex_t leavers_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 
 /**
 
-	@brief      Terminate a worker
-	@param      worker          The worker to terminate          [NON-NULLABLE]
+	@brief      The condition broadcast when the last public call in flight
+	            leaves a worker that is being disposed, where futexes are not
+	            available
 
 **/
-static inline void GNUNET_WORKER_terminate (
-	const GNUNET_WORKER_Handle worker
-) {
-	if (worker->on_terminate) {
-		worker->on_terminate(worker->data);
-	}
-	atomic_store(&worker->state, WORKER_IS_DEAD);
-}
+static pthread_cond_t leavers_cond = PTHREAD_COND_INITIALIZER;
 
+#endif
 
 
-	/*  FUNCTIONS  */
+	/*  INLINED FUNCTIONS  */
 
 
 /**
 
-	@brief      Cancel all the tasks in a pointed `GNUNET_WORKER_JobList`, free
-	            the memory and set the pointer to `NULL`
-	@param      jlst_ptr        The pointer to set to `NULL`     [NON-NULLABLE]
-
-	The @p jlst_ptr paramenter cannot be `NULL`, however it can point to
-	`NULL`. If that is the case this function is no-op.
+	@brief      Increase a statistics counter that other threads can update
+	            too
+	@param      counter         The counter to increase          [NON-NULLABLE]
+	@param      amount          The amount to add
 
 **/
-static void job_list_unschedule_and_clear (
-	GNUNET_WORKER_JobList ** const jlst_ptr
+static inline void counter_add (
+	atomic_uint_fast64_t * const counter,
+	const uint64_t amount
 ) {
-
-	GNUNET_WORKER_JobList * iter;
-
-	if ((iter = *jlst_ptr)) {
-
-		*jlst_ptr = NULL;
+	atomic_fetch_add_explicit(counter, amount, memory_order_relaxed);
+}
 
 
-		/* \                                 /\
-		\ */     unschedule_task:           /* \
-		 \/     _______________________     \ */
+/**
 
+	@brief      Increase a statistics counter written by one thread only
+	@param      counter         The counter to increase          [NON-NULLABLE]
+	@param      amount          The amount to add
 
-		GNUNET_SCHEDULER_cancel(iter->scheduled_as);
+	No read-modify-write instruction is needed here: other threads only read
+	the counter.
 
-		if (iter->next) {
+**/
+static inline void counter_bump (
+	atomic_uint_fast64_t * const counter,
+	const uint64_t amount
+) {
+	atomic_store_explicit(
+		counter,
+		atomic_load_explicit(counter, memory_order_relaxed) + amount,
+		memory_order_relaxed
+	);
+}
 
-			free((iter = iter->next)->prev);
-			goto unschedule_task;
 
-		}
+/**
 
-		free(iter);
+	@brief      Raise a high-water mark written by one thread only
+	@param      counter         The high-water mark to update    [NON-NULLABLE]
+	@param      value           The value just observed
 
+**/
+static inline void counter_raise (
+	atomic_uint_fast64_t * const counter,
+	const uint64_t value
+) {
+	if (value > atomic_load_explicit(counter, memory_order_relaxed)) {
+		atomic_store_explicit(counter, value, memory_order_relaxed);
 	}
-
 }
 
 
 /**
 
-	@brief      Handler added via `GNUNET_SCHEDULER_add_shutdown()` when the
-	            shutdown is triggered by some of our functions
-	@param      v_worker        The worker in which to trigger the scheduler's
-	                            shutdown, passed as `void *`     [NON-NULLABLE]
+	@brief      Check whether a priority can be used for a job
+	@param      priority        The priority to check
+	@return     A boolean: `true` if @p priority indexes a bucket, `false`
+	            otherwise (`GNUNET_SCHEDULER_PRIORITY_KEEP` included)
 
 **/
-static void attended_shutdown_handler (
-	void * const v_worker
+static inline bool priority_is_valid (
+	const enum GNUNET_SCHEDULER_Priority priority
 ) {
+	return
+		(int) priority > GNUNET_SCHEDULER_PRIORITY_KEEP &&
+		(int) priority < GNUNET_SCHEDULER_PRIORITY_COUNT;
+}
 
-	#define worker ((GNUNET_WORKER_Handle) v_worker)
-
-	/*  `worker->kill_mutex` will be unlocked by `GNUNET_WORKER_dispose()`
-		either now or later...  */
 
-	pthread_mutex_lock(&worker->kill_mutex);
-	worker->shutdown_schedule = NULL;
-	GNUNET_WORKER_terminate(worker);
-	GNUNET_WORKER_dispose_if_guest(worker);
+/**
 
-	#undef worker
+	@brief      Read the monotonic clock
+	@return     The current time in nanoseconds
 
+**/
+static inline uint64_t monotonic_now (void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
 }
 
 
 /**
 
-	@brief      Handler added via `GNUNET_SCHEDULER_add_shutdown()` when the
-	            shutdown is triggered without invoking our functions
-	@param      v_worker        The worker in which to trigger the scheduler's
-	                            shutdown, passed as `void *`     [NON-NULLABLE]
+	@brief      Get the bucket of a `GNUNET_WORKER_Histogram` a latency falls
+	            in
+	@param      latency         The latency to look up, in nanoseconds
+	@return     The index of the bucket
 
 **/
-static void unattended_shutdown_handler (
-	void * const v_worker
+static inline unsigned int histogram_index (
+	const uint64_t latency
 ) {
+	if (latency < (1u << WORKER_HISTOGRAM_SUB_BITS)) {
+		return latency;
+	}
+	const unsigned int msb = 63 - __builtin_clzll(latency);
+	if (msb >= WORKER_HISTOGRAM_MAX_BITS) {
+		return GNUNET_WORKER_HISTOGRAM_SIZE - 1;
+	}
+	const unsigned int shift = msb - (WORKER_HISTOGRAM_SUB_BITS - 1);
+	return
+		(1u << WORKER_HISTOGRAM_SUB_BITS) +
+		((shift - 1) << (WORKER_HISTOGRAM_SUB_BITS - 1)) +
+		(latency >> shift) - (1u << (WORKER_HISTOGRAM_SUB_BITS - 1));
+}
 
-	#define worker ((GNUNET_WORKER_Handle) v_worker)
-
-	pthread_mutex_lock(&worker->kill_mutex);
 
-	if (
-		atomic_load(&worker->state) == WORKER_IS_ALIVE &&
-		(worker->flags & WORKER_FLAG_OWN_THREAD)
-	) {
+/**
 
-		pthread_detach(worker->worker_thread);
+	@brief      Add a sample to a latency histogram (worker thread only)
+	@param      worker          The worker the job belongs to    [NON-NULLABLE]
+	@param      priority        The priority of the job
+	@param      kind            The phase the sample refers to
+	@param      latency         The sample, in nanoseconds
 
+**/
+static inline void latency_record (
+	const GNUNET_WORKER_Handle worker,
+	const enum GNUNET_SCHEDULER_Priority priority,
+	const GNUNET_WORKER_LatencyKind kind,
+	const uint64_t latency
+) {
+	GNUNET_WORKER_LatencyHistogram * const histogram =
+		atomic_load_explicit(&worker->latencies, memory_order_acquire);
+	if (!histogram) {
+		return;
 	}
+	GNUNET_WORKER_LatencyHistogram * const target =
+		histogram + priority * GNUNET_WORKER_LATENCY_KIND_COUNT + kind;
+	counter_bump(target->counts + histogram_index(latency), 1);
+	counter_bump(&target->total, 1);
+	counter_bump(&target->sum, latency);
+	counter_raise(&target->max, latency);
+}
 
-	atomic_store(
-		&worker->state,
-		worker->on_terminate ?
-			WORKER_SAYS_BYE
-		:
-			WORKER_IS_DYING
-	);
 
-	clear_schedule(&worker->listener_schedule);
-	job_list_unschedule_and_clear(&worker->schedules);
-	job_list_clear_locked(&worker->wishlist, &worker->wishes_mutex);
-	worker->shutdown_schedule = NULL;
-	GNUNET_WORKER_terminate(worker);
-	GNUNET_WORKER_dispose_if_guest(worker);
+/**
 
-	/*  `worker->kill_mutex` will be unlocked by `GNUNET_WORKER_dispose()`
-		either now or later...  */
+	@brief      Open the hardware counters of the calling thread for the
+	            routine profiler (worker thread only)
+	@param      worker          The worker the thread serves     [NON-NULLABLE]
 
-	#undef worker
+	If the counters cannot be opened they are marked as unavailable and no
+	other attempt is made.
 
+**/
+static inline void perf_counters_open (
+	const GNUNET_WORKER_Handle worker
+) {
+	#ifdef __linux__
+	static const uint64_t events[WORKER_PERF_COUNTERS] = {
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS
+	};
+	struct perf_event_attr attr = {
+		.size = sizeof(struct perf_event_attr),
+		.type = PERF_TYPE_HARDWARE,
+		.read_format = PERF_FORMAT_GROUP,
+		.exclude_kernel = 1,
+		.exclude_hv = 1
+	};
+	for (int idx = 0; idx < WORKER_PERF_COUNTERS; idx++) {
+		attr.config = events[idx];
+		/*  The first counter leads the group, so that one read gets all  */
+		worker->perf_fd[idx] = syscall(
+			SYS_perf_event_open,
+			&attr,
+			0,
+			-1,
+			idx ? worker->perf_fd[0] : -1,
+			PERF_FLAG_FD_CLOEXEC
+		);
+		if (worker->perf_fd[idx] < 0) {
+			while (idx--) {
+				close(worker->perf_fd[idx]);
+			}
+			break;
+		}
+	}
+	if (worker->perf_fd[WORKER_PERF_COUNTERS - 1] >= 0) {
+		return;
+	}
+	#endif
+	for (int idx = 0; idx < WORKER_PERF_COUNTERS; worker->perf_fd[idx++] = -2);
 }
 
 
 /**
 
-	@brief      Perform a task and clean up afterwards
-	@param      v_job           The member of
-	                            `GNUNET_WORKER_Instance::schedules` to run,
-	                            passed as `void *`               [NON-NULLABLE]
+	@brief      Close the hardware counters of a worker, if open
+	@param      worker          The worker to update             [NON-NULLABLE]
 
 **/
-static void call_and_unlist_handler (
-	void * const v_job
+static inline void perf_counters_close (
+	const GNUNET_WORKER_Handle worker
 ) {
+	for (int idx = 0; idx < WORKER_PERF_COUNTERS; idx++) {
+		if (worker->perf_fd[idx] >= 0) {
+			close(worker->perf_fd[idx]);
+		}
+	}
+}
 
-	#define job ((GNUNET_WORKER_JobList *) v_job)
 
-	if (job->assigned_to->schedules == job) {
+/**
 
-		/*  This is the first job in the list  */
+	@brief      Read what the routine profiler measures (worker thread only)
+	@param      worker          The worker whose thread is measured
+	                                                             [NON-NULLABLE]
+	@param      flags           What must be read (see
+	                            `GNUNET_WORKER_ProfileFlags`)
+	@param      save_sample     A placeholder for storing the reading
+	                                                             [NON-NULLABLE]
 
-		job->assigned_to->schedules = job->next;
+**/
+static inline void profile_sample (
+	const GNUNET_WORKER_Handle worker,
+	const unsigned int flags,
+	GNUNET_WORKER_ProfileSample * const save_sample
+) {
+	struct timespec now;
+	if (flags & GNUNET_WORKER_PROFILE_TIMES) {
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+		save_sample->cpu_time =
+			(uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+		save_sample->wall_time = monotonic_now();
+	}
+	if (flags & GNUNET_WORKER_PROFILE_HARDWARE) {
+		uint64_t group[WORKER_PERF_COUNTERS + 1];
+		if (worker->perf_fd[0] == -1) {
+			perf_counters_open(worker);
+		}
+		/*  With `PERF_FORMAT_GROUP` the values follow the number of counters  */
+		if (
+			worker->perf_fd[0] < 0 ||
+			read(worker->perf_fd[0], group, sizeof(group)) != sizeof(group)
+		) {
+			group[1] = group[2] = 0;
+		}
+		for (int idx = 0; idx < WORKER_PERF_COUNTERS; idx++) {
+			save_sample->counters[idx] = group[idx + 1];
+		}
+	}
+}
 
-	} else if (job->prev) {
 
-		/*  This is **not** the first job in the list  */
+/**
 
-		job->prev->next = job->next;
+	@brief      Find the entry of a routine in a routine profile, creating it if
+	            needed (worker thread only)
+	@param      table           The profile to search            [NON-NULLABLE]
+	@param      routine         The address of the routine
+	@return     The entry of @p routine, or `GNUNET_WORKER_RoutineTable::others`
+	            if the table is full
 
+**/
+static inline GNUNET_WORKER_RoutineCounters * profile_entry (
+	GNUNET_WORKER_RoutineTable * const table,
+	const uintptr_t routine
+) {
+	const size_t hash =
+		(size_t) (((uint64_t) routine * UINT64_C(0x9E3779B97F4A7C15)) >> 32);
+	for (size_t probe = 0; probe < WORKER_PROFILE_SIZE; probe++) {
+		GNUNET_WORKER_RoutineCounters * const entry =
+			table->routines + ((hash + probe) & (WORKER_PROFILE_SIZE - 1));
+		const uintptr_t owner =
+			atomic_load_explicit(&entry->routine, memory_order_relaxed);
+		if (owner == routine) {
+			return entry;
+		}
+		if (!owner) {
+			atomic_store_explicit(&entry->routine, routine, memory_order_release);
+			return entry;
+		}
 	}
+	return &table->others;
+}
 
-	if (job->next) {
+
+/**
+
+	@brief      Account what a routine has spent to the routine profile
+	            (worker thread only)
+	@param      worker          The worker that has run the routine
+	                                                             [NON-NULLABLE]
+	@param      routine         The address the routine is accounted to
+	@param      flags           What has been measured (see
+	                            `GNUNET_WORKER_ProfileFlags`)
+	@param      before          The reading taken before the routine
+	                                                             [NON-NULLABLE]
+	@param      after           The reading taken after the routine
+	                                                             [NON-NULLABLE]
+
+**/
+static inline void profile_record (
+	const GNUNET_WORKER_Handle worker,
+	const uintptr_t routine,
+	const unsigned int flags,
+	const GNUNET_WORKER_ProfileSample * const before,
+	const GNUNET_WORKER_ProfileSample * const after
+) {
+	GNUNET_WORKER_RoutineTable * const table =
+		atomic_load_explicit(&worker->routine_table, memory_order_acquire);
+	if (!table) {
+		return;
+	}
+	GNUNET_WORKER_RoutineCounters * const entry = profile_entry(table, routine);
+	counter_bump(&entry->calls, 1);
+	if (flags & GNUNET_WORKER_PROFILE_TIMES) {
+		counter_bump(&entry->wall_time, after->wall_time - before->wall_time);
+		counter_bump(&entry->cpu_time, after->cpu_time - before->cpu_time);
+	}
+	if (flags & GNUNET_WORKER_PROFILE_HARDWARE) {
+		counter_bump(&entry->cycles, after->counters[0] - before->counters[0]);
+		counter_bump(
+			&entry->instructions,
+			after->counters[1] - before->counters[1]
+		);
+	}
+}
+
+
+/**
+
+	@brief      Get the current tracer, if any, and declare that it is about to
+	            be used
+	@param      save_slot       A placeholder for the value to pass to
+	                            `tracer_leave()`                 [NON-NULLABLE]
+	@return     The tracer (then `tracer_leave()` must be invoked after having
+	            used it), or `NULL` if no tracer is installed
+
+	While no tracer is installed this costs one atomic load. Otherwise the
+	thread registers in the slot of `tracer_calls` of the current epoch, and
+	checks that the epoch has not changed meanwhile: so once the epoch has
+	changed, `GNUNET_WORKER_set_tracer()` only has to wait for the slot of the
+	previous epoch to become empty, while new calls go to the other slot.
+
+**/
+static inline const GNUNET_WORKER_Tracer * tracer_enter (
+	unsigned int * const save_slot
+) {
+	if (!atomic_load_explicit(&current_tracer, memory_order_relaxed)) {
+		return NULL;
+	}
+	unsigned int slot;
+	for (;;) {
+		const unsigned int epoch = atomic_load(&tracer_epoch);
+		slot = epoch & 1;
+		atomic_fetch_add(tracer_calls + slot, 1);
+		if (atomic_load(&tracer_epoch) == epoch) {
+			break;
+		}
+		atomic_fetch_sub(tracer_calls + slot, 1);
+	}
+	const GNUNET_WORKER_Tracer * const tracer = atomic_load(&current_tracer);
+	if (!tracer) {
+		atomic_fetch_sub_explicit(tracer_calls + slot, 1, memory_order_release);
+		return NULL;
+	}
+	*save_slot = slot;
+	return tracer;
+}
+
+
+/**
+
+	@brief      Declare that a tracer obtained via `tracer_enter()` is not
+	            used anymore
+	@param      slot            The value stored by `tracer_enter()`
+
+**/
+static inline void tracer_leave (
+	const unsigned int slot
+) {
+	atomic_fetch_sub_explicit(tracer_calls + slot, 1, memory_order_release);
+}
+
+
+/**
+
+	@brief      Remember an event concerning one job in the flight recorder
+	            and report it to the tracer, if any
+	@param      worker          The worker the job belongs to    [NON-NULLABLE]
+	@param      event           The event to report
+	@param      job             The job concerned                [NON-NULLABLE]
+
+**/
+static inline void trace_job (
+	const GNUNET_WORKER_Handle worker,
+	const GNUNET_WORKER_TraceEvent event,
+	const GNUNET_WORKER_JobList * const job
+) {
+	flight_record(
+		worker->flight_recorder,
+		event,
+		job->routine,
+		job->data,
+		job->priority
+	);
+	unsigned int tracer_slot;
+	const GNUNET_WORKER_Tracer * const tracer = tracer_enter(&tracer_slot);
+	if (!tracer) {
+		return;
+	}
+	const GNUNET_WORKER_TraceRecord record = {
+		.worker = worker,
+		.event = event,
+		.job = job,
+		.routine = job->routine,
+		.data = job->data,
+		.timestamp = monotonic_now(),
+		.priority = job->priority,
+		.rerun = job->rerun
+	};
+	tracer->trace(&record, tracer->data);
+	tracer_leave(tracer_slot);
+}
+
+
+/**
+
+	@brief      Remember in the flight recorder and report to the tracer, if
+	            any, that a job has finished
+	@param      worker          The worker the job belonged to   [NON-NULLABLE]
+	@param      recorder        The flight recorder of @p worker [NON-NULLABLE]
+	@param      job             The job that has finished        [NON-NULLABLE]
+	@param      routine         The job's routine                [NON-NULLABLE]
+	@param      data            The job's data                       [NULLABLE]
+	@param      priority        The job's priority
+
+	The routine might have dismissed or destroyed the worker, so neither
+	@p worker nor @p job are dereferenced: everything is collected before the
+	routine starts.
+
+**/
+static inline void trace_finish (
+	const GNUNET_WORKER_Handle worker,
+	FlightRecorder * const recorder,
+	const GNUNET_WORKER_JobList * const job,
+	const GNUNET_CallbackRoutine routine,
+	void * const data,
+	const enum GNUNET_SCHEDULER_Priority priority
+) {
+	flight_record(recorder, GNUNET_WORKER_TRACE_FINISH, routine, data, priority);
+	unsigned int tracer_slot;
+	const GNUNET_WORKER_Tracer * const tracer = tracer_enter(&tracer_slot);
+	if (!tracer) {
+		return;
+	}
+	const GNUNET_WORKER_TraceRecord record = {
+		.worker = worker,
+		.event = GNUNET_WORKER_TRACE_FINISH,
+		.job = job,
+		.routine = routine,
+		.data = data,
+		.timestamp = monotonic_now(),
+		.priority = priority
+	};
+	tracer->trace(&record, tracer->data);
+	tracer_leave(tracer_slot);
+}
+
+
+/**
+
+	@brief      Report an event concerning a chain of new jobs to the tracer,
+	            if any, with one single clock reading
+
+	The chains are reported by the pushing threads: to keep producers from
+	fighting over the flight recorder, these events are left out of it.
+	@param      worker          The worker the jobs belong to    [NON-NULLABLE]
+	@param      event           The event to report
+	@param      jlst            The first member of a chain linked only via
+	                            `GNUNET_WORKER_JobList::next`    [NON-NULLABLE]
+
+**/
+static inline void trace_job_chain (
+	const GNUNET_WORKER_Handle worker,
+	const GNUNET_WORKER_TraceEvent event,
+	const GNUNET_WORKER_JobList * jlst
+) {
+	unsigned int tracer_slot;
+	const GNUNET_WORKER_Tracer * const tracer = tracer_enter(&tracer_slot);
+	if (!tracer) {
+		return;
+	}
+	GNUNET_WORKER_TraceRecord record = {
+		.worker = worker,
+		.event = event,
+		.timestamp = monotonic_now()
+	};
+	do {
+		record.job = jlst;
+		record.routine = jlst->routine;
+		record.data = jlst->data;
+		record.priority = jlst->priority;
+		tracer->trace(&record, tracer->data);
+	} while ((jlst = jlst->next));
+	tracer_leave(tracer_slot);
+}
+
+
+/**
+
+	@brief      Read the monotonic clock, but only if a tracer is installed
+	@return     The current time in nanoseconds, or `0` if no tracer is
+	            installed
+
+**/
+static inline uint64_t trace_clock (void) {
+	return
+		atomic_load_explicit(&current_tracer, memory_order_relaxed) ?
+			monotonic_now()
+		:
+			0;
+}
+
+
+/**
+
+	@brief      Remember in the flight recorder and report to the tracer, if
+	            any, that the worker thread has collected the jobs pushed by
+	            other threads
+	@param      worker          The worker that has collected the jobs
+	                                                             [NON-NULLABLE]
+	@param      job_count       The number of jobs collected
+	@param      started_at      When the collection began, as returned by
+	                            `trace_clock()`
+
+**/
+static inline void trace_drain (
+	const GNUNET_WORKER_Handle worker,
+	const size_t job_count,
+	const uint64_t started_at
+) {
+	flight_record(
+		worker->flight_recorder,
+		GNUNET_WORKER_TRACE_DRAIN,
+		NULL,
+		NULL,
+		job_count
+	);
+	unsigned int tracer_slot;
+	const GNUNET_WORKER_Tracer * const tracer = tracer_enter(&tracer_slot);
+	if (!tracer) {
+		return;
+	}
+	const uint64_t now = monotonic_now();
+	/*  The tracer might have been installed while the drain was running  */
+	const GNUNET_WORKER_TraceRecord record = {
+		.worker = worker,
+		.event = GNUNET_WORKER_TRACE_DRAIN,
+		.timestamp = started_at ? started_at : now,
+		.duration = started_at ? now - started_at : 0,
+		.priority = WORKER_LISTENER_PRIORITY,
+		.job_count = job_count
+	};
+	tracer->trace(&record, tracer->data);
+	tracer_leave(tracer_slot);
+}
+
+
+/**
+
+	@brief      Move a worker to a new state, remembering it in the flight
+	            recorder and reporting it to the tracer, if any
+	@param      worker          The worker to update             [NON-NULLABLE]
+	@param      state           The new state of the worker
+
+	The event is reported before the state is stored, since once the worker is
+	dead another thread might dispose of it at any moment.
+
+**/
+static inline void worker_set_state (
+	const GNUNET_WORKER_Handle worker,
+	const enum GNUNET_WORKER_State state
+) {
+	flight_record(
+		worker->flight_recorder,
+		GNUNET_WORKER_TRACE_STATE,
+		NULL,
+		NULL,
+		state
+	);
+	unsigned int tracer_slot;
+	const GNUNET_WORKER_Tracer * const tracer = tracer_enter(&tracer_slot);
+	if (tracer) {
+		const GNUNET_WORKER_TraceRecord record = {
+			.worker = worker,
+			.event = GNUNET_WORKER_TRACE_STATE,
+			.timestamp = monotonic_now(),
+			.priority = GNUNET_SCHEDULER_PRIORITY_DEFAULT,
+			.stage = (GNUNET_WORKER_LifeStage) state
+		};
+		tracer->trace(&record, tracer->data);
+		tracer_leave(tracer_slot);
+	}
+	WORKER_PROBE3(
+		state,
+		worker,
+		state,
+		atomic_load_explicit(&worker->future_plans, memory_order_relaxed)
+	);
+	atomic_store(&worker->state, state);
+}
+
+
+/**
+
+	@brief      Create a detached thread
+	@param      start_routine   The routine to launch in a new detached thread
+	                                                             [NON-NULLABLE]
+	@param      data            The routine's argument               [NULLABLE]
+
+**/
+static inline int thread_create_detached (
+	const __thread_ftype__ start_routine,
+	void * const data
+) {
+	pthread_t thr;
+	pthread_attr_t tattr;
+	pthread_attr_init(&tattr);
+	pthread_attr_setdetachstate(&tattr, PTHREAD_CREATE_DETACHED);
+	const int retval = pthread_create(&thr, &tattr, start_routine, data);
+	pthread_attr_destroy(&tattr);
+	return retval;
+}
+
+
+/**
+
+	@brief      Launch `GNUNET_SCHEDULER_cancel()` on a pointer to a scheduled
+	            task and set the pointer to `NULL`
+	@param      tsk_ptr         A pointer to a pointer to a scheduled task
+	                                                             [NON-NULLABLE]
+
+	The @p tsk_ptr paramenter cannot be `NULL`, however it can point to `NULL`.
+	If that is the case this function is no-op.
+
+**/
+static inline void clear_schedule (
+	struct GNUNET_SCHEDULER_Task ** const tsk_ptr
+) {
+	struct GNUNET_SCHEDULER_Task * const tmp = *tsk_ptr;
+	if (tmp) {
+		*tsk_ptr = NULL;
+		GNUNET_SCHEDULER_cancel(tmp);
+	}
+}
+
+
+/**
+
+	@brief      Open the channel through which a worker is beeped
+	@param      fds             An array of `WORKER_BEEP_FDS` file descriptors
+	                            to populate                      [NON-NULLABLE]
+	@return     Zero on success, a negative number otherwise
+
+**/
+static inline int beep_channel_open (
+	int * const fds
+) {
+	#ifdef WORKER_USE_EVENTFD
+	return (fds[0] = eventfd(0, EFD_NONBLOCK)) < 0 ? -1 : 0;
+	#else
+	return pipe2(fds, O_NONBLOCK);
+	#endif
+}
+
+
+/**
+
+	@brief      Send a "beep" to a worker
+	@param      worker          The worker to notify             [NON-NULLABLE]
+	@return     `true` if the worker is going to wake up, `false` otherwise
+
+	A channel that is full (`EAGAIN`) counts as a successful notification,
+	since the worker has not read the previous beeps yet and will wake up
+	anyway.
+
+**/
+static inline bool worker_beep (
+	const GNUNET_WORKER_Handle worker
+) {
+	if (
+		write(
+			worker->beep_fd[WORKER_BEEP_FDS - 1],
+			&BEEP_CODE,
+			sizeof(BEEP_CODE)
+		) == sizeof(BEEP_CODE)
+	) {
+		counter_add(&worker->counters.beeps_sent, 1);
+		WORKER_PROBE2(beep_write, worker, 1);
+		return true;
+	}
+	if (errno == EAGAIN) {
+		WORKER_PROBE2(beep_write, worker, 1);
+		return true;
+	}
+	counter_add(&worker->counters.beeps_failed, 1);
+	WORKER_PROBE2(beep_write, worker, 0);
+	return false;
+}
+
+
+/**
+
+	@brief      Consume all the beeps a worker has received so far
+	@param      worker          The worker that was beeped       [NON-NULLABLE]
+	@return     `true` if at least one beep was read, `false` otherwise
+
+	An eventfd coalesces any number of beeps into one counter, which a single
+	read resets; a pipe is drained in chunks instead.
+
+**/
+static inline bool worker_beep_flush (
+	const GNUNET_WORKER_Handle worker
+) {
+	#ifdef WORKER_USE_EVENTFD
+	uint64_t beeps;
+	if (read(worker->beep_fd[0], &beeps, sizeof(beeps)) != sizeof(beeps)) {
+		return false;
+	}
+	counter_bump(&worker->counters.beeps_received, beeps);
+	WORKER_PROBE2(beep_read, worker, beeps);
+	return true;
+	#else
+	unsigned char beeps[32];
+	const ssize_t beep_count = read(worker->beep_fd[0], beeps, sizeof(beeps));
+	if (beep_count < 1) {
+		return false;
+	}
+	counter_bump(&worker->counters.beeps_received, beep_count);
+	WORKER_PROBE2(beep_read, worker, beep_count);
+	return *beeps == BEEP_CODE;
+	#endif
+}
+
+
+/**
+
+	@brief      Free a chain of `GNUNET_WORKER_JobList` members linked only via
+	            `GNUNET_WORKER_JobList::next` that no ticket refers to (spare
+	            nodes or wishes that have never been published)
+	@param      jlst            The first member of the chain        [NULLABLE]
+
+**/
+static inline void job_chain_free (
+	GNUNET_WORKER_JobList * jlst
+) {
+	GNUNET_WORKER_JobList * next;
+	while (jlst) {
+		next = jlst->next;
+		free(jlst);
+		jlst = next;
+	}
+}
+
+
+/**
+
+	@brief      Declare that a public function is using a worker, so that the
+	            worker is not freed under its feet
+	@param      worker          The worker to use                [NON-NULLABLE]
+
+	This costs one uncontended atomic increment: the disposer of the worker
+	does not need to be notified unless it is waiting (see
+	`worker_wait_for_leavers()`).
+
+**/
+static inline void worker_enter (
+	const GNUNET_WORKER_Handle worker
+) {
+	atomic_fetch_add_explicit(&worker->calls_in_flight, 1, memory_order_seq_cst);
+}
+
+
+/**
+
+	@brief      Declare that a public function has stopped using a worker
+	@param      worker          The worker to leave              [NON-NULLABLE]
+
+	After the decrement the worker might be freed at any moment: like for
+	`call_complete()`, waking up the disposer needs only the address of the
+	counter.
+
+**/
+static inline void worker_leave (
+	const GNUNET_WORKER_Handle worker
+) {
+	if (
+		atomic_fetch_sub_explicit(
+			&worker->calls_in_flight,
+			1,
+			memory_order_release
+		) != WORKER_DISPOSER_WAITS + 1
+	) {
+		return;
+	}
+#ifdef __linux__
+	syscall(
+		SYS_futex,
+		&worker->calls_in_flight,
+		FUTEX_WAKE_PRIVATE,
+		1,
+		NULL,
+		NULL,
+		0
+	);
+#else
+	pthread_mutex_lock(&leavers_mutex);
+	pthread_cond_broadcast(&leavers_cond);
+	pthread_mutex_unlock(&leavers_mutex);
+#endif
+}
+
+
+/**
+
+	@brief      Wait until no public function is using a worker anymore
+	@param      worker          The worker that is about to be freed
+	                                                             [NON-NULLABLE]
+
+	Only one thread (the owner of `worker->kill_mutex`) can invoke this
+	function.
+
+**/
+static inline void worker_wait_for_leavers (
+	const GNUNET_WORKER_Handle worker
+) {
+	unsigned int in_flight =
+		atomic_fetch_or_explicit(
+			&worker->calls_in_flight,
+			WORKER_DISPOSER_WAITS,
+			memory_order_seq_cst
+		) | WORKER_DISPOSER_WAITS;
+	if (in_flight == WORKER_DISPOSER_WAITS) {
+		return;
+	}
+#ifdef __linux__
+	do {
+		syscall(
+			SYS_futex,
+			&worker->calls_in_flight,
+			FUTEX_WAIT_PRIVATE,
+			in_flight,
+			NULL,
+			NULL,
+			0
+		);
+	} while (
+		(
+			in_flight = atomic_load_explicit(
+				&worker->calls_in_flight,
+				memory_order_acquire
+			)
+		) != WORKER_DISPOSER_WAITS
+	);
+#else
+	pthread_mutex_lock(&leavers_mutex);
+	while (
+		atomic_load_explicit(&worker->calls_in_flight, memory_order_acquire) !=
+			WORKER_DISPOSER_WAITS
+	) {
+		pthread_cond_wait(&leavers_cond, &leavers_mutex);
+	}
+	pthread_mutex_unlock(&leavers_mutex);
+#endif
+}
+
+
+/**
+
+	@brief      Set the final state of a synchronous call and wake up the
+	            caller
+	@param      call            The call to complete             [NON-NULLABLE]
+	@param      final_state     `CALL_IS_DONE` or `CALL_IS_DROPPED`
+
+	After this function has set the state the caller may return at any moment,
+	so @p call must not be touched anymore (waking up a futex needs only its
+	address).
+
+**/
+static inline void call_complete (
+	GNUNET_WORKER_Call * const call,
+	const enum GNUNET_WORKER_CallState final_state
+) {
+#ifdef __linux__
+	atomic_store_explicit(&call->state, final_state, memory_order_release);
+	syscall(SYS_futex, &call->state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+	pthread_mutex_lock(&calls_mutex);
+	atomic_store_explicit(&call->state, final_state, memory_order_release);
+	pthread_cond_broadcast(&calls_cond);
+	pthread_mutex_unlock(&calls_mutex);
+#endif
+}
+
+
+/**
+
+	@brief      Wait until a synchronous call is completed
+	@param      call            The call to wait for             [NON-NULLABLE]
+	@param      absolute_time   The absolute time to wait until, or `NULL` for
+	                            waiting indefinitely                 [NULLABLE]
+	@return     `0` if the call has been completed, `ETIMEDOUT` if the time has
+	            expired, `EINVAL` if @p absolute_time is invalid
+
+**/
+static inline int call_wait (
+	GNUNET_WORKER_Call * const call,
+	const struct timespec * const absolute_time
+) {
+#ifdef __linux__
+	while (
+		atomic_load_explicit(&call->state, memory_order_acquire) ==
+			CALL_IS_PENDING
+	) {
+		if (
+			syscall(
+				SYS_futex,
+				&call->state,
+				FUTEX_WAIT_BITSET_PRIVATE | FUTEX_CLOCK_REALTIME,
+				CALL_IS_PENDING,
+				absolute_time,
+				NULL,
+				FUTEX_BITSET_MATCH_ANY
+			) && (errno == ETIMEDOUT || errno == EINVAL)
+		) {
+			return errno;
+		}
+	}
+	return 0;
+#else
+	int retval = 0;
+	pthread_mutex_lock(&calls_mutex);
+	while (
+		!retval &&
+		atomic_load_explicit(&call->state, memory_order_acquire) ==
+			CALL_IS_PENDING
+	) {
+		retval =
+			absolute_time ?
+				pthread_cond_timedwait(&calls_cond, &calls_mutex, absolute_time)
+			:
+				pthread_cond_wait(&calls_cond, &calls_mutex);
+	}
+	pthread_mutex_unlock(&calls_mutex);
+	return
+		atomic_load_explicit(&call->state, memory_order_acquire) ==
+			CALL_IS_PENDING ?
+			retval
+		:
+			0;
+#endif
+}
+
+
+/**
+
+	@brief      The job routine that carries a synchronous call
+	@param      v_call          The call to perform, passed as `void *`
+	                                                             [NON-NULLABLE]
+
+**/
+static void call_trampoline (
+	void * const v_call
+) {
+
+	#define call ((GNUNET_WORKER_Call *) v_call)
+
+	call->result = call->routine(call->data);
+	call_complete(call, CALL_IS_DONE);
+
+	#undef call
+
+}
+
+
+/**
+
+	@brief      Free the spare job nodes of a thread that is exiting
+	@param      v_cache         The thread's `job_cache`, passed as `void *`
+	                                                             [NON-NULLABLE]
+
+**/
+static void job_cache_destructor (
+	void * const v_cache
+) {
+	job_chain_free(((struct JobCache *) v_cache)->spare);
+}
+
+
+/**
+
+	@brief      Create `job_cache_key` (invoked via `pthread_once()`)
+
+**/
+static void job_cache_key_create (void) {
+	pthread_key_create(&job_cache_key, &job_cache_destructor);
+}
+
+
+/**
+
+	@brief      Get a new job node, possibly without invoking the allocator
+	@param      worker          The worker the job is destined to
+	                                                             [NON-NULLABLE]
+	@return     A job node, or `NULL` if no memory is available
+
+	The current thread's `job_cache` is used first; when that is empty it is
+	refilled at once with the nodes that @p worker has recycled so far, up to
+	the high-water mark of its pool (the surplus is freed, so that no thread
+	keeps more nodes than that). Only when both are empty `malloc()` is
+	invoked.
+
+**/
+static inline GNUNET_WORKER_JobList * job_alloc (
+	const GNUNET_WORKER_Handle worker
+) {
+	GNUNET_WORKER_JobList * job = job_cache.spare;
+	if (!job) {
+		if (
+			!atomic_load_explicit(&worker->spare_jobs, memory_order_relaxed) ||
+			!(
+				job = atomic_exchange_explicit(
+					&worker->spare_jobs,
+					NULL,
+					memory_order_acquire
+				)
+			)
+		) {
+			return malloc(sizeof(GNUNET_WORKER_JobList));
+		}
+		atomic_store_explicit(&worker->spare_jobs_count, 0, memory_order_relaxed);
+		size_t room = atomic_load_explicit(
+			&worker->job_pool_size,
+			memory_order_relaxed
+		);
+		GNUNET_WORKER_JobList * last = job;
+		while (room-- > 1 && last->next) {
+			last = last->next;
+		}
+		job_chain_free(last->next);
+		last->next = NULL;
+		if (!job_cache.registered) {
+			pthread_once(&job_cache_key_once, &job_cache_key_create);
+			pthread_setspecific(job_cache_key, &job_cache);
+			job_cache.registered = true;
+		}
+	}
+	job_cache.spare = job->next;
+	return job;
+}
+
+
+/**
+
+	@brief      Put a job node that is no longer needed aside for reuse (worker
+	            thread only)
+	@param      worker          The worker that has run the job  [NON-NULLABLE]
+	@param      job             The job node to recycle          [NON-NULLABLE]
+
+	The node will be handed over to the other threads at the next drain of the
+	wishlist (see `recycled_jobs_flush()`).
+
+**/
+static inline void job_recycle (
+	const GNUNET_WORKER_Handle worker,
+	GNUNET_WORKER_JobList * const job
+) {
+	if (!(job->next = worker->recycled_jobs)) {
+		worker->recycled_jobs_tail = job;
+	}
+	worker->recycled_jobs = job;
+	worker->recycled_jobs_count++;
+}
+
+
+/**
+
+	@brief      Drop the worker's reference to a job node
+	@param      job             The job node to release          [NON-NULLABLE]
+	@return     A boolean: `true` if the node must be disposed of, `false` if a
+	            ticket still refers to it
+
+**/
+static inline bool job_unref (
+	GNUNET_WORKER_JobList * const job
+) {
+	return
+		!job->ticketed ||
+		atomic_fetch_sub_explicit(&job->refs, 1, memory_order_acq_rel) == 1;
+}
+
+
+/**
+
+	@brief      Mark a job as started, unless it has been cancelled
+	@param      job             The job that is about to start   [NON-NULLABLE]
+	@return     A boolean: `true` if the job's routine must be invoked, `false`
+	            if the job has been cancelled
+
+**/
+static inline bool job_start (
+	GNUNET_WORKER_JobList * const job
+) {
+	int expected = JOB_IS_PENDING;
+	return
+		!job->ticketed ||
+		atomic_compare_exchange_strong(&job->status, &expected, JOB_HAS_STARTED);
+}
+
+
+/**
+
+	@brief      Hand a job node back to the caller that owns it
+	@param      job             The job node to hand back        [NON-NULLABLE]
+	@param      has_run         Whether the job's routine has run
+
+	See `GNUNET_WORKER_push_job()`. The node is not touched anymore after the
+	ownership has been given back, since the caller may push it again at once.
+
+**/
+static inline void job_complete (
+	GNUNET_WORKER_JobList * const job,
+	const bool has_run
+) {
+	const GNUNET_WORKER_JobCompletion on_complete = job->on_complete;
+	atomic_store_explicit(&job->refs, 0, memory_order_release);
+	on_complete((GNUNET_WORKER_Job *) job, has_run);
+}
+
+
+/**
+
+	@brief      Release a job node that the worker thread has done with
+	@param      worker          The worker that owned the job    [NON-NULLABLE]
+	@param      job             The job node to release          [NON-NULLABLE]
+
+	If the worker is still served by the current thread the node is recycled,
+	otherwise it is freed (the worker might have been dismissed or destroyed by
+	the job itself); in both cases only if no ticket refers to it anymore. A
+	node owned by the caller is handed back instead.
+
+**/
+static inline void job_retire (
+	const GNUNET_WORKER_Handle worker,
+	GNUNET_WORKER_JobList * const job
+) {
+	if (!job_unref(job)) {
+		return;
+	}
+	if (job->on_complete) {
+		job_complete(job, true);
+	} else if (currently_serving_as == worker) {
+		job_recycle(worker, job);
+	} else {
+		free(job);
+	}
+}
+
+
+/**
+
+	@brief      Free a job node that will never run
+	@param      job             The job node to discard          [NON-NULLABLE]
+
+	If a ticket still refers to the node, the node only learns that it has
+	been discarded and will be freed when the ticket is released. A node owned
+	by the caller is handed back instead.
+
+**/
+static inline void job_discard (
+	GNUNET_WORKER_JobList * const job
+) {
+	if (job->ticketed) {
+		int expected = JOB_IS_PENDING;
+		if (
+			atomic_compare_exchange_strong(
+				&job->status,
+				&expected,
+				JOB_IS_DISCARDED
+			) && job->routine == &call_trampoline
+		) {
+			/*  The caller of a synchronous call is waiting for us  */
+			call_complete(job->data, CALL_IS_DROPPED);
+		}
+		job->scheduled_as = NULL;
+	}
+	trace_job(job->assigned_to, GNUNET_WORKER_TRACE_CANCEL, job);
+	WORKER_PROBE3(job_cancel, job->assigned_to, job->routine, job->data);
+	counter_add(&job->assigned_to->counters.jobs_dropped, 1);
+	if (!job_unref(job)) {
+		return;
+	}
+	if (job->on_complete) {
+		job_complete(job, false);
+	} else {
+		free(job);
+	}
+}
+
+
+/**
+
+	@brief      Discard a chain of `GNUNET_WORKER_JobList` members linked only
+	            via `GNUNET_WORKER_JobList::next` that will never run
+	@param      jlst            The first member of the chain        [NULLABLE]
+	@return     The number of jobs discarded
+
+**/
+static inline size_t job_chain_discard (
+	GNUNET_WORKER_JobList * jlst
+) {
+	GNUNET_WORKER_JobList * next;
+	size_t job_count = 0;
+	while (jlst) {
+		next = jlst->next;
+		job_discard(jlst);
+		jlst = next;
+		job_count++;
+	}
+	return job_count;
+}
+
+
+/**
+
+	@brief      Hand the job nodes recycled by the worker thread over to the
+	            other threads in one single batch (worker thread only)
+	@param      worker          The worker whose recycled nodes must be
+	                            flushed                          [NON-NULLABLE]
+
+	Nodes that would make the pool exceed its high-water mark
+	(`GNUNET_WORKER_Instance::job_pool_size`) are freed instead.
+
+**/
+static inline void recycled_jobs_flush (
+	const GNUNET_WORKER_Handle worker
+) {
+	GNUNET_WORKER_JobList * iter;
+	const size_t
+		spare_count = atomic_load_explicit(
+			&worker->spare_jobs_count,
+			memory_order_relaxed
+		),
+		pool_size = atomic_load_explicit(
+			&worker->job_pool_size,
+			memory_order_relaxed
+		);
+	while (
+		worker->recycled_jobs &&
+		spare_count + worker->recycled_jobs_count > pool_size
+	) {
+		iter = worker->recycled_jobs;
+		worker->recycled_jobs = iter->next;
+		worker->recycled_jobs_count--;
+		free(iter);
+	}
+	if (!worker->recycled_jobs) {
+		return;
+	}
+	worker->recycled_jobs_tail->next =
+		atomic_load_explicit(&worker->spare_jobs, memory_order_relaxed);
+	while (
+		!atomic_compare_exchange_weak_explicit(
+			&worker->spare_jobs,
+			&worker->recycled_jobs_tail->next,
+			worker->recycled_jobs,
+			memory_order_release,
+			memory_order_relaxed
+		)
+	);
+	atomic_fetch_add_explicit(
+		&worker->spare_jobs_count,
+		worker->recycled_jobs_count,
+		memory_order_relaxed
+	);
+	worker->recycled_jobs = NULL;
+	worker->recycled_jobs_count = 0;
+}
+
+
+/**
+
+	@brief      Try to reserve room for new jobs in a worker
+	@param      worker          The worker to reserve room in    [NON-NULLABLE]
+	@param      job_count       The number of jobs to make room for
+	@return     A boolean: `true` if the room has been reserved, `false` if the
+	            worker has reached its capacity
+
+**/
+static inline bool jobs_reserve (
+	const GNUNET_WORKER_Handle worker,
+	const size_t job_count
+) {
+	const size_t capacity = atomic_load(&worker->capacity);
+	if (!capacity) {
+		atomic_fetch_add(&worker->pending_jobs, job_count);
+		return true;
+	}
+	size_t pending = atomic_load(&worker->pending_jobs);
+	do {
+		if (job_count > capacity || pending > capacity - job_count) {
+			return false;
+		}
+	} while (
+		!atomic_compare_exchange_weak(
+			&worker->pending_jobs,
+			&pending,
+			pending + job_count
+		)
+	);
+	return true;
+}
+
+
+/**
+
+	@brief      Wake up all the threads that are waiting for room in a worker
+	@param      worker          The worker to announce           [NON-NULLABLE]
+
+**/
+static inline void producers_wake (
+	const GNUNET_WORKER_Handle worker
+) {
+	pthread_mutex_lock(&worker->room_mutex);
+	pthread_cond_broadcast(&worker->room_cond);
+	pthread_mutex_unlock(&worker->room_mutex);
+}
+
+
+/**
+
+	@brief      Give back the room reserved for jobs that have been started or
+	            will never be
+	@param      worker          The worker to make room in       [NON-NULLABLE]
+	@param      job_count       The number of jobs that have left
+
+	The counter is decremented before looking for waiting producers, while
+	producers register themselves before looking at the counter: thus at least
+	one of the two sides always sees the other (see `jobs_wait_for_room()`).
+
+**/
+static inline void jobs_release (
+	const GNUNET_WORKER_Handle worker,
+	const size_t job_count
+) {
+	atomic_fetch_sub(&worker->pending_jobs, job_count);
+	if (atomic_load(&worker->blocked_producers)) {
+		producers_wake(worker);
+	}
+}
+
+
+/**
+
+	@brief      Atomically detach the whole `GNUNET_WORKER_Instance::wishlist`
+	            and discard it
+	@param      worker          The worker whose wishlist must be cleared
+	                                                             [NON-NULLABLE]
+
+**/
+static inline void wishlist_clear (
+	const GNUNET_WORKER_Handle worker
+) {
+	counter_add(
+		&worker->counters.jobs_drained,
+		job_chain_discard(atomic_exchange(&worker->wishlist, NULL))
+	);
+}
+
+
+/**
+
+	@brief      Atomically detach the whole
+	            `GNUNET_WORKER_Instance::cancellations` stack and release its
+	            tickets
+	@param      worker          The worker whose cancellations must be cleared
+	                                                             [NON-NULLABLE]
+
+**/
+static inline void cancellations_clear (
+	const GNUNET_WORKER_Handle worker
+) {
+	GNUNET_WORKER_JobList
+		* iter = atomic_exchange(&worker->cancellations, NULL),
+		* ticket;
+	while ((ticket = iter)) {
+		iter = ticket->next_cancelled;
+		GNUNET_WORKER_release_ticket(ticket);
+	}
+}
+
+
+/**
+
+	@brief      Undo what `GNUNET_WORKER_allocate()` did
+	@param      worker          The worker to free               [NON-NULLABLE]
+
+	@note   The linked list `GNUNET_WORKER_Instance::schedules` must be freed
+	        separately before calling this function. Whatever is left in
+	        `GNUNET_WORKER_Instance::wishlist` (jobs pushed by other threads
+	        while the worker was shutting down) is freed here, together with
+	        the worker's pool of spare job nodes and the tickets left in
+	        `GNUNET_WORKER_Instance::cancellations`.
+	        The identifier of the worker must have been revoked (see
+	        `GNUNET_WORKER_slot_revoke()`) before the worker is considered
+	        dead, so that no push by identifier can reach it anymore.
+
+**/
+static inline void GNUNET_WORKER_unallocate (
+	const GNUNET_WORKER_Handle worker
+) {
+	WORKER_PROBE1(dispose, worker);
+	wishlist_clear(worker);
+	cancellations_clear(worker);
+	GNUNET_WORKER_flight_recorder_close(worker->flight_recorder);
+	job_chain_free(atomic_load(&worker->spare_jobs));
+	job_chain_free(worker->recycled_jobs);
+	free(atomic_load(&worker->latencies));
+	free(atomic_load(&worker->routine_table));
+	perf_counters_close(worker);
+	for (int idx = 0; idx < WORKER_BEEP_FDS; close(worker->beep_fd[idx++]));
+	GNUNET_NETWORK_fdset_destroy(worker->beep_fds);
+	requirement_uninit(&worker->scheduler_has_returned);
+	pthread_mutex_destroy(&worker->kill_mutex);
+	pthread_mutex_destroy(&worker->room_mutex);
+	pthread_cond_destroy(&worker->room_cond);
+	free(worker);
+}
+
+
+/**
+
+	@brief      Clear the environment and undo what `GNUNET_WORKER_allocate()`
+	            did
+	@param      worker          The worker to dispose            [NON-NULLABLE]
+
+	Please lock the `worker->kill_mutex` mutex before calling this function and
+	never unlock it.
+
+	The worker thread must not enter the worker (see `worker_enter()`) before
+	invoking this function, or it will hang forever.
+
+	@note   The linked list `GNUNET_WORKER_Instance::schedules` must be freed
+	        separately before calling this function.
+
+**/
+static inline void GNUNET_WORKER_dispose (
+	const GNUNET_WORKER_Handle worker
+) {
+	/*  Pushes by identifier must not find the worker anymore  */
+	GNUNET_WORKER_slot_revoke(worker->id);
+	requirement_paint_green(&worker->scheduler_has_returned);
+	/*  Producers waiting for room must see that the worker is dead  */
+	producers_wake(worker);
+	worker_wait_for_leavers(worker);
+	currently_serving_as = NULL;
+	pthread_mutex_unlock(&worker->kill_mutex);
+	GNUNET_WORKER_unallocate(worker);
+}
+
+
+/**
+
+	@brief      Clear the environment and undo what `GNUNET_WORKER_allocate()`
+	            did, but only if the worker was installed into a pre-existing
+	            scheduler via `GNUNET_WORKER_adopt_running_scheduler()`.
+	@param      worker          The worker to dispose            [NON-NULLABLE]
+
+	Please lock the `worker->kill_mutex` mutex before calling this function and
+	never unlock it.
+
+	If the worker is not a guest worker `GNUNET_WORKER_dispose()` will be
+	invoked later by `scheduler_launcher()`.
+
+	The worker thread must not enter the worker (see `worker_enter()`) before
+	invoking this function, or it might hang forever.
+
+	@note   The linked list `GNUNET_WORKER_Instance::schedules` must be freed
+	        separately before calling this function.
+
+**/
+static inline void GNUNET_WORKER_dispose_if_guest (
+	const GNUNET_WORKER_Handle worker
+) {
+	if (worker->flags & WORKER_FLAG_IS_GUEST) {
+		GNUNET_WORKER_dispose(worker);
+	}
+}
+
+
+/**
+
+	@brief      Terminate a worker
+	@param      worker          The worker to terminate          [NON-NULLABLE]
+
+**/
+static inline void GNUNET_WORKER_terminate (
+	const GNUNET_WORKER_Handle worker
+) {
+	if (worker->on_terminate) {
+		worker->on_terminate(worker->data);
+	}
+	worker_set_state(worker, WORKER_IS_DEAD);
+}
+
+
+
+	/*  FUNCTIONS  */
+
+
+/**
+
+	@brief      Cancel all the tasks in a pointed `GNUNET_WORKER_JobList`, free
+	            the memory and set the pointer to `NULL`
+	@param      jlst_ptr        The pointer to set to `NULL`     [NON-NULLABLE]
+
+	The @p jlst_ptr paramenter cannot be `NULL`, however it can point to
+	`NULL`. If that is the case this function is no-op.
+
+**/
+static void job_list_unschedule_and_clear (
+	GNUNET_WORKER_JobList ** const jlst_ptr
+) {
+
+	GNUNET_WORKER_JobList * iter;
+
+	if ((iter = *jlst_ptr)) {
+
+		*jlst_ptr = NULL;
+
+
+		/* \                                 /\
+		\ */     unschedule_task:           /* \
+		 \/     _______________________     \ */
+
+
+		GNUNET_SCHEDULER_cancel(iter->scheduled_as);
+
+		if (iter->next) {
+
+			job_discard((iter = iter->next)->prev);
+			goto unschedule_task;
+
+		}
+
+		job_discard(iter);
+
+	}
+
+}
+
+
+/**
+
+	@brief      Cancel all the dispatchers of a worker, free the jobs left in
+	            its buckets and reset their depths
+	@param      worker          The worker whose buckets must be cleared
+	                                                             [NON-NULLABLE]
+
+**/
+static void buckets_unschedule_and_clear (
+	const GNUNET_WORKER_Handle worker
+) {
+
+	GNUNET_WORKER_Bucket * bucket;
+
+	/*  Only the busy buckets can have a dispatcher or jobs  */
+
+	while (worker->busy_buckets) {
+
+		bucket = worker->buckets + ffs(worker->busy_buckets) - 1;
+		worker->busy_buckets &= worker->busy_buckets - 1;
+		clear_schedule(&bucket->dispatcher);
+		job_chain_discard(bucket->head);
+		bucket->head = NULL;
+		bucket->tail = NULL;
+
+	}
+
+	for (int idx = 0; idx < GNUNET_SCHEDULER_PRIORITY_COUNT; idx++) {
+
+		atomic_store_explicit(
+			&worker->buckets[idx].depth,
+			0,
+			memory_order_relaxed
+		);
+
+	}
+
+}
+
+
+/**
+
+	@brief      Handler added via `GNUNET_SCHEDULER_add_shutdown()` when the
+	            shutdown is triggered by some of our functions
+	@param      v_worker        The worker in which to trigger the scheduler's
+	                            shutdown, passed as `void *`     [NON-NULLABLE]
+
+**/
+static void attended_shutdown_handler (
+	void * const v_worker
+) {
+
+	#define worker ((GNUNET_WORKER_Handle) v_worker)
+
+	/*  `worker->kill_mutex` will be unlocked by `GNUNET_WORKER_dispose()`
+		either now or later...  */
+
+	pthread_mutex_lock(&worker->kill_mutex);
+	worker->shutdown_schedule = NULL;
+	GNUNET_WORKER_terminate(worker);
+	GNUNET_WORKER_dispose_if_guest(worker);
+
+	#undef worker
+
+}
+
+
+/**
+
+	@brief      Handler added via `GNUNET_SCHEDULER_add_shutdown()` when the
+	            shutdown is triggered without invoking our functions
+	@param      v_worker        The worker in which to trigger the scheduler's
+	                            shutdown, passed as `void *`     [NON-NULLABLE]
+
+**/
+static void unattended_shutdown_handler (
+	void * const v_worker
+) {
+
+	#define worker ((GNUNET_WORKER_Handle) v_worker)
+
+	pthread_mutex_lock(&worker->kill_mutex);
+
+	if (
+		atomic_load(&worker->state) == WORKER_IS_ALIVE &&
+		(worker->flags & WORKER_FLAG_OWN_THREAD)
+	) {
+
+		pthread_detach(worker->worker_thread);
+
+	}
+
+	worker_set_state(
+		worker,
+		worker->on_terminate ?
+			WORKER_SAYS_BYE
+		:
+			WORKER_IS_DYING
+	);
+
+	clear_schedule(&worker->listener_schedule);
+	job_list_unschedule_and_clear(&worker->schedules);
+	buckets_unschedule_and_clear(worker);
+	wishlist_clear(worker);
+	worker->shutdown_schedule = NULL;
+	GNUNET_WORKER_terminate(worker);
+	GNUNET_WORKER_dispose_if_guest(worker);
+
+	/*  `worker->kill_mutex` will be unlocked by `GNUNET_WORKER_dispose()`
+		either now or later...  */
+
+	#undef worker
+
+}
+
+
+/**
+
+	@brief      Remove a job from `GNUNET_WORKER_Instance::schedules` and from
+	            the count of the jobs waiting in the worker thread
+	@param      worker          The worker the job belongs to    [NON-NULLABLE]
+	@param      job             The job to remove                [NON-NULLABLE]
+
+**/
+static void job_unlist (
+	const GNUNET_WORKER_Handle worker,
+	GNUNET_WORKER_JobList * const job
+) {
+
+	if (worker->schedules == job) {
+
+		/*  This is the first job in the list  */
+
+		worker->schedules = job->next;
+
+	} else if (job->prev) {
+
+		/*  This is **not** the first job in the list  */
+
+		job->prev->next = job->next;
+
+	}
+
+	if (job->next) {
 
 		/*  This is **not** the last job in the list  */
 
-		job->next->prev = job->prev;
+		job->next->prev = job->prev;
+
+	}
+
+	job->scheduled_as = NULL;
+
+	atomic_fetch_sub_explicit(
+		&worker->buckets[job->priority].depth,
+		1,
+		memory_order_relaxed
+	);
+
+	jobs_release(worker, 1);
+
+}
+
+
+/**
+
+	@brief      Add a job to `GNUNET_WORKER_Instance::schedules` and to the
+	            count of the jobs waiting in the worker thread (the reverse of
+	            `job_unlist()`, except for the capacity)
+	@param      worker          The worker the job belongs to    [NON-NULLABLE]
+	@param      job             The job to add                   [NON-NULLABLE]
+
+**/
+static void job_list (
+	const GNUNET_WORKER_Handle worker,
+	GNUNET_WORKER_JobList * const job
+) {
+
+	job->prev = NULL;
+
+	if ((job->next = worker->schedules)) {
+
+		worker->schedules->prev = job;
+
+	}
+
+	worker->schedules = job;
+
+	atomic_fetch_add_explicit(
+		&worker->buckets[job->priority].depth,
+		1,
+		memory_order_relaxed
+	);
+
+}
+
+
+/**
+
+	@brief      Remove a cancelled job from the scheduler at once (worker thread
+	            only)
+	@param      worker          The worker the job belongs to    [NON-NULLABLE]
+	@param      job             The ticketed job that has been cancelled
+	                                                             [NON-NULLABLE]
+
+	Nothing happens if the job is not a GNUnet task of its own, or is not one
+	anymore: the worker thread drops it as soon as it meets it, or has already
+	done so. The ticket's reference is left untouched.
+
+**/
+static void job_unschedule_cancelled (
+	const GNUNET_WORKER_Handle worker,
+	GNUNET_WORKER_JobList * const job
+) {
+
+	if (!job->scheduled_as) {
+
+		return;
+
+	}
+
+	GNUNET_SCHEDULER_cancel(job->scheduled_as);
+	job_unlist(worker, job);
+
+	trace_job(worker, GNUNET_WORKER_TRACE_CANCEL, job);
+	WORKER_PROBE3(job_cancel, worker, job->routine, job->data);
+
+	/*  This drops the worker's reference, the ticket still holds one  */
+
+	job_unref(job);
+
+}
+
+
+/**
+
+	@brief      Remove from the scheduler the jobs that other threads have
+	            cancelled and release their tickets (worker thread only)
+	@param      worker          The worker whose cancellations must be applied
+	                                                             [NON-NULLABLE]
+
+	The cancelled jobs that are still in the wishlist are not affected: they
+	are dropped when the wishlist is detached.
+
+**/
+static void cancellations_apply (
+	const GNUNET_WORKER_Handle worker
+) {
+
+	GNUNET_WORKER_JobList
+		* iter = atomic_exchange(&worker->cancellations, NULL),
+		* ticket;
+
+	while ((ticket = iter)) {
+
+		iter = ticket->next_cancelled;
+		job_unschedule_cancelled(worker, ticket);
+		GNUNET_WORKER_release_ticket(ticket);
+
+	}
+
+}
+
+
+/**
+
+	@brief      Hand a job cancelled by another thread over to its worker
+	            thread, together with its ticket
+	@param      ticket          The ticket of the job, whose status has just
+	                            been set to `JOB_IS_CANCELLED`   [NON-NULLABLE]
+	@return     A boolean: `true` if the ticket now belongs to the worker,
+	            `false` if the worker is not alive anymore (its shutdown drops
+	            the job anyway) and the ticket is still the caller's
+
+	The handle stored in the job might be dangling at this point, so the worker
+	is reached via its checked identifier. If the worker cannot be woken up
+	the job is removed at its next awakening, or by its shutdown.
+
+**/
+static bool cancellation_post (
+	GNUNET_WORKER_JobList * const ticket
+) {
+
+	/*  Once posted the ticket might be released at any moment  */
+
+	const GNUNET_WORKER_Id worker_id = ticket->worker_id;
+	const GNUNET_WORKER_Handle worker = GNUNET_WORKER_slot_pin(worker_id);
+
+	if (!worker) {
+
+		return false;
+
+	}
+
+	const bool posted = atomic_load(&worker->state) == WORKER_IS_ALIVE;
+
+	if (posted) {
+
+		GNUNET_WORKER_JobList * old_head =
+			atomic_load_explicit(&worker->cancellations, memory_order_relaxed);
+
+		do {
+
+			ticket->next_cancelled = old_head;
+
+		} while (
+			!atomic_compare_exchange_weak_explicit(
+				&worker->cancellations,
+				&old_head,
+				ticket,
+				memory_order_release,
+				memory_order_relaxed
+			)
+		);
+
+		/*  Only who finds the stack empty has to beep  */
+
+		if (!old_head) {
+
+			worker_beep(worker);
+
+		}
+
+	}
+
+	GNUNET_WORKER_slot_unpin(worker_id);
+	return posted;
+
+}
+
+
+/**
+
+	@brief      Invoke the routine of a job that has started, tracking its
+	            latencies if the job was stamped at push time
+	@param      worker          The worker the job belongs to    [NON-NULLABLE]
+	@param      job             The job to run                   [NON-NULLABLE]
+
+	The wait of timed jobs is not tracked, since they are not meant to start
+	as soon as possible.
+
+**/
+static inline void job_run (
+	const GNUNET_WORKER_Handle worker,
+	GNUNET_WORKER_JobList * const job
+) {
+
+	const GNUNET_CallbackRoutine routine = job->routine;
+	void * const data = job->data;
+	const enum GNUNET_SCHEDULER_Priority priority = job->priority;
+	FlightRecorder * const recorder = worker->flight_recorder;
+	const unsigned int profile_flags =
+		atomic_load_explicit(&worker->profile_flags, memory_order_relaxed);
+
+	counter_bump(&worker->counters.jobs_executed, 1);
+	trace_job(worker, GNUNET_WORKER_TRACE_START, job);
+	WORKER_PROBE4(job_start, worker, routine, data, priority);
+
+	if (!job->pushed_at && !profile_flags) {
+
+		routine(data);
+		trace_finish(worker, recorder, job, routine, data, priority);
+		WORKER_PROBE4(job_finish, worker, routine, data, priority);
+		return;
+
+	}
+
+	GNUNET_WORKER_ProfileSample profile_before, profile_after;
+
+	/*  Synchronous calls are accounted to the routine they carry, which must
+		be looked up before the call completes  */
+
+	const uintptr_t profiled_routine =
+		routine == &call_trampoline ?
+			(uintptr_t) ((GNUNET_WORKER_Call *) data)->routine
+		:
+			(uintptr_t) routine;
+
+	const uint64_t started_at = job->pushed_at ? monotonic_now() : 0;
+
+	if (job->pushed_at && !job->due.abs_value_us) {
+
+		latency_record(
+			worker,
+			priority,
+			GNUNET_WORKER_LATENCY_WAIT,
+			started_at - job->pushed_at
+		);
+
+	}
+
+	if (profile_flags) {
+
+		profile_sample(worker, profile_flags, &profile_before);
+
+	}
+
+	routine(data);
+
+	/*  The routine might have dismissed or destroyed the worker  */
+
+	const bool still_serving = currently_serving_as == worker;
+
+	if (profile_flags && still_serving) {
+
+		profile_sample(worker, profile_flags, &profile_after);
+
+	}
+
+	trace_finish(worker, recorder, job, routine, data, priority);
+	WORKER_PROBE4(job_finish, worker, routine, data, priority);
+
+	if (!still_serving) {
+
+		return;
+
+	}
+
+	if (started_at) {
+
+		latency_record(
+			worker,
+			priority,
+			GNUNET_WORKER_LATENCY_RUN,
+			monotonic_now() - started_at
+		);
+
+	}
+
+	if (profile_flags) {
+
+		profile_record(
+			worker,
+			profiled_routine,
+			profile_flags,
+			&profile_before,
+			&profile_after
+		);
+
+	}
+
+}
+
+
+/**
+
+	@brief      Perform a task and clean up afterwards
+	@param      v_job           The member of
+	                            `GNUNET_WORKER_Instance::schedules` to run,
+	                            passed as `void *`               [NON-NULLABLE]
+
+**/
+static void call_and_unlist_handler (
+	void * const v_job
+) {
+
+	#define job ((GNUNET_WORKER_JobList *) v_job)
+
+	const GNUNET_WORKER_Handle worker = job->assigned_to;
+
+	job_unlist(worker, job);
+
+	/*  A job cancelled by another thread after it had been scheduled  */
+
+	if (!job_start(job)) {
+
+		trace_job(worker, GNUNET_WORKER_TRACE_CANCEL, job);
+		WORKER_PROBE3(job_cancel, worker, job->routine, job->data);
+
+		job_retire(worker, job);
+		return;
+
+	}
+
+	job_run(worker, job);
+
+	int expected = JOB_HAS_STARTED;
+
+	if (
+		!job->period.rel_value_us ||
+		currently_serving_as != worker ||
+		atomic_load(&worker->state) != WORKER_IS_ALIVE ||
+		!atomic_compare_exchange_strong(&job->status, &expected, JOB_IS_PENDING)
+	) {
+
+		/*  A one-shot job, a worker that is going away or a periodic job that
+			has been cancelled while it was running  */
+
+		job_retire(worker, job);
+		return;
+
+	}
+
+	/*  Periodic job: the same node is scheduled again; missed runs are
+		skipped rather than fired in a row  */
+
+	job->rerun = true;
+	job->due = GNUNET_TIME_absolute_add(job->due, job->period);
+
+	if (!GNUNET_TIME_absolute_get_remaining(job->due).rel_value_us) {
+
+		job->due = GNUNET_TIME_relative_to_absolute(job->period);
+
+	}
+
+	/*  The job had already been admitted, capacity limits do not apply  */
+
+	atomic_fetch_add(&worker->pending_jobs, 1);
+	job_list(worker, job);
+
+	job->scheduled_as = GNUNET_SCHEDULER_add_at_with_priority(
+		job->due,
+		job->priority,
+		&call_and_unlist_handler,
+		v_job
+	);
+
+	#undef job
+
+}
+
+
+/**
+
+	@brief      Run a slice of the jobs queued in a bucket, then yield back to
+	            the scheduler
+	@param      v_bucket        The member of `GNUNET_WORKER_Instance::buckets`
+	                            to serve, passed as `void *`     [NON-NULLABLE]
+
+**/
+static void dispatch_handler (
+	void * const v_bucket
+) {
+
+	#define bucket ((GNUNET_WORKER_Bucket *) v_bucket)
+
+	const GNUNET_WORKER_Handle worker = bucket->owner;
+	GNUNET_WORKER_JobList * job;
+
+	unsigned int budget =
+		atomic_load_explicit(&worker->dispatch_budget, memory_order_relaxed);
+
+	/*  If the dispatch mode has been switched off in the meanwhile, the jobs
+		still queued are served one per run  */
+
+	if (!budget) {
+
+		budget = 1;
+
+	}
+
+	/*  The bucket stays busy while the dispatcher runs, so that jobs pushed
+		meanwhile do not schedule a second dispatcher  */
+
+	bucket->dispatcher = NULL;
+
+	while ((job = bucket->head)) {
+
+		if (!(bucket->head = job->next)) {
+
+			bucket->tail = NULL;
+
+		}
+
+		atomic_fetch_sub_explicit(&bucket->depth, 1, memory_order_relaxed);
+		jobs_release(worker, 1);
+
+		if (!job_start(job)) {
+
+			/*  The job has been cancelled, it does not consume the budget  */
+
+			trace_job(worker, GNUNET_WORKER_TRACE_CANCEL, job);
+			WORKER_PROBE3(job_cancel, worker, job->routine, job->data);
+
+			job_retire(worker, job);
+			continue;
+
+		}
+
+		job_run(worker, job);
+		job_retire(worker, job);
+
+		/*  The routine might have dismissed or destroyed the worker  */
+
+		if (currently_serving_as != worker) {
+
+			return;
+
+		}
+
+		if (!--budget || atomic_load(&worker->state) != WORKER_IS_ALIVE) {
+
+			break;
+
+		}
+
+	}
+
+	if (!bucket->head) {
+
+		worker->busy_buckets &= ~(1u << bucket->priority);
+
+	} else if (atomic_load(&worker->state) == WORKER_IS_ALIVE) {
+
+		bucket->dispatcher = GNUNET_SCHEDULER_add_with_priority(
+			bucket->priority,
+			&dispatch_handler,
+			v_bucket
+		);
+
+	}
+
+	/*  Otherwise the bucket stays busy and the jobs will be freed by the
+		shutdown  */
+
+	#undef bucket
+
+}
+
+
+/**
+
+	@brief      Hand a chain of new jobs over to the scheduler (worker thread
+	            only)
+	@param      worker          The worker the jobs belong to    [NON-NULLABLE]
+	@param      last_job        The newest job of a chain linked via
+	                            `GNUNET_WORKER_JobList::next` from the newest
+	                            to the oldest job                [NON-NULLABLE]
+	@return     The number of jobs in the chain
+
+	The chain is split into one batch per priority level in one single pass.
+	In dispatch mode (see `GNUNET_WORKER_set_dispatch_budget()`) every batch
+	is appended to the queue of its bucket in `GNUNET_WORKER_Instance::buckets`
+	and at most one dispatcher per bucket is scheduled; otherwise every job
+	becomes a GNUnet task of its own and is listed in
+	`GNUNET_WORKER_Instance::schedules`. Jobs with a due time always go to the
+	scheduler's timer queue, in either mode.
+
+**/
+static size_t jobs_schedule (
+	const GNUNET_WORKER_Handle worker,
+	GNUNET_WORKER_JobList * const last_job
+) {
+
+	GNUNET_WORKER_JobList
+		* heads[GNUNET_SCHEDULER_PRIORITY_COUNT],
+		* tails[GNUNET_SCHEDULER_PRIORITY_COUNT],
+		* job,
+		* iter = last_job;
+
+	size_t counts[GNUNET_SCHEDULER_PRIORITY_COUNT], job_count = 0;
+	unsigned int batches = 0, prio;
+	uint64_t collected_at = 0;
+
+	/*  The chain goes from the newest job to the oldest one, so prepending
+		every job to the batch of its priority leaves each batch in
+		chronological order (no separate reversal is needed)  */
+
+	do {
+
+		job = iter;
+		iter = job->next;
+		job_count++;
+
+		if (
+			job->ticketed &&
+			atomic_load_explicit(&job->status, memory_order_relaxed) ==
+				JOB_IS_CANCELLED
+		) {
+
+			/*  Cancelled before the worker thread could even see it  */
+
+			trace_job(worker, GNUNET_WORKER_TRACE_CANCEL, job);
+			WORKER_PROBE3(job_cancel, worker, job->routine, job->data);
+
+			jobs_release(worker, 1);
+			job_retire(worker, job);
+			continue;
+
+		}
+
+		if (job->pushed_at) {
+
+			/*  Latency tracking: one clock reading for the whole chain  */
+
+			if (!collected_at) {
+
+				collected_at = monotonic_now();
+
+			}
+
+			latency_record(
+				worker,
+				job->priority,
+				GNUNET_WORKER_LATENCY_PICKUP,
+				collected_at - job->pushed_at
+			);
+
+		}
+
+		if (job->due.abs_value_us) {
+
+			/*  Timed jobs go straight to the scheduler's timer queue  */
+
+			job_list(worker, job);
+
+			job->scheduled_as = GNUNET_SCHEDULER_add_at_with_priority(
+				job->due,
+				job->priority,
+				&call_and_unlist_handler,
+				job
+			);
+
+			continue;
+
+		}
+
+		prio = job->priority;
+		job->prev = NULL;
+
+		if (batches & (1u << prio)) {
+
+			heads[prio]->prev = job;
+			job->next = heads[prio];
+			counts[prio]++;
+
+		} else {
+
+			job->next = NULL;
+			tails[prio] = job;
+			counts[prio] = 1;
+			batches |= 1u << prio;
+
+		}
+
+		heads[prio] = job;
+
+	} while (iter);
+
+	const bool dispatch_mode =
+		atomic_load_explicit(&worker->dispatch_budget, memory_order_relaxed);
+
+	GNUNET_WORKER_Bucket * bucket;
+
+	while (batches) {
+
+		prio = ffs(batches) - 1;
+		batches &= batches - 1;
+		bucket = worker->buckets + prio;
+
+		atomic_fetch_add_explicit(
+			&bucket->depth,
+			counts[prio],
+			memory_order_relaxed
+		);
+
+		if (dispatch_mode) {
+
+			if (bucket->tail) {
+
+				bucket->tail->next = heads[prio];
+
+			} else {
+
+				bucket->head = heads[prio];
+
+			}
+
+			bucket->tail = tails[prio];
+
+			if (!(worker->busy_buckets & (1u << prio))) {
+
+				worker->busy_buckets |= 1u << prio;
+
+				bucket->dispatcher = GNUNET_SCHEDULER_add_with_priority(
+					bucket->priority,
+					&dispatch_handler,
+					bucket
+				);
+
+			}
+
+			continue;
+
+		}
+
+		iter = heads[prio];
+
+		do {
+
+			iter->scheduled_as = GNUNET_SCHEDULER_add_with_priority(
+				iter->priority,
+				&call_and_unlist_handler,
+				iter
+			);
+
+		} while ((iter = iter->next));
+
+		/*  `worker->schedules` is not kept in chronological order  */
+
+		if (worker->schedules) {
+
+			tails[prio]->next = worker->schedules;
+			worker->schedules->prev = tails[prio];
+
+		}
+
+		worker->schedules = heads[prio];
+
+	}
+
+	size_t scheduled = 0;
+
+	for (prio = 0; prio < GNUNET_SCHEDULER_PRIORITY_COUNT; prio++) {
+
+		scheduled += atomic_load_explicit(
+			&worker->buckets[prio].depth,
+			memory_order_relaxed
+		);
+
+	}
+
+	counter_raise(&worker->counters.scheduled_peak, scheduled);
+	return job_count;
+
+}
+
+
+/**
+
+	@brief      A routine that is woken up by a beep and schedules new tasks
+	            requested by other threads
+	@param      v_worker        The worker this listener routine belongs to,
+	                            passed as `void *`               [NON-NULLABLE]
+
+**/
+static void load_request_handler (
+	void * const v_worker
+) {
+
+	#define worker ((GNUNET_WORKER_Handle) v_worker)
+
+	counter_bump(&worker->counters.wakeups, 1);
+
+	/*  Flush the beeps (this must happen before the wishlist is detached, or a
+		beep sent for a job pushed right after the detachment could get lost)  */
+
+	if (!worker_beep_flush(worker) && worker->listener_schedule) {
+
+		GNUNET_log(
+			GNUNET_ERROR_TYPE_WARNING,
+			_("Unable to read the notification sent to the worker thread\n")
+		);
+
+	}
+
+	/*  One single atomic swap detaches everything other threads have pushed so
+		far; `::future_plans` must be read only afterwards (see the comments in
+		`GNUNET_WORKER_asynch_destroy()`)  */
+
+	WORKER_PROBE1(drain_start, worker);
+
+	const uint64_t drain_started_at = trace_clock();
+
+	GNUNET_WORKER_JobList * const last_wish =
+		atomic_exchange(&worker->wishlist, NULL);
+
+	const int what_to_do = atomic_load(&worker->future_plans);
+
+	if (what_to_do != GNUNET_WORKER_LONG_LIFE) {
+
+		/*  Worker must die (possibly shutting down the scheduler)  */
+
+		pthread_mutex_lock(&worker->kill_mutex);
+		worker->listener_schedule = NULL;
+		counter_add(
+			&worker->counters.jobs_drained,
+			job_chain_discard(last_wish)
+		);
+		clear_schedule(&worker->shutdown_schedule);
+		job_list_unschedule_and_clear(&worker->schedules);
+		buckets_unschedule_and_clear(worker);
+		GNUNET_WORKER_terminate(worker);
+
+		/*  `worker->kill_mutex` will be unlocked by `GNUNET_WORKER_dispose()`
+			either now or later...  */
+
+		if (what_to_do == GNUNET_WORKER_DISMISSAL) {
+
+			GNUNET_WORKER_dispose(worker);
+			return;
+
+		}
+
+		/*  `what_to_do` equals `GNUNET_WORKER_DESTRUCTION`  */
+
+		GNUNET_WORKER_dispose_if_guest(worker);
+		GNUNET_SCHEDULER_shutdown();
+		return;
+
+	}
+
+	/*  Worker must live  */
+
+	recycled_jobs_flush(worker);
+
+	if (last_wish) {
+
+		const size_t wish_count = jobs_schedule(worker, last_wish);
+
+		counter_add(&worker->counters.jobs_drained, wish_count);
+		counter_raise(&worker->counters.wishlist_peak, wish_count);
+		trace_drain(worker, wish_count, drain_started_at);
+		WORKER_PROBE2(drain_end, worker, wish_count);
+
+	} else {
+
+		WORKER_PROBE2(drain_end, worker, 0);
+
+	}
+
+	/*  The cancellations too must be detached only after the beeps have been
+		flushed  */
+
+	cancellations_apply(worker);
+
+	/*  To the next awakening...  */
+
+	worker->listener_schedule =
+		atomic_load(&worker->state) == WORKER_IS_ALIVE ?
+			GNUNET_SCHEDULER_add_select(
+				WORKER_LISTENER_PRIORITY,
+				GNUNET_TIME_UNIT_FOREVER_REL,
+				worker->beep_fds,
+				NULL,
+				&load_request_handler,
+				v_worker
+			)
+		:
+			NULL;
+
+	#undef worker
+
+}
+
+
+/**
+
+	@brief      The scheduler's main task that initializes a worker
+	@param      v_worker        The worker this is the main routine of, passed
+	                            as `void *`                      [NON-NULLABLE]
+
+**/
+static void worker_main_routine (
+	void * const v_worker
+) {
+
+	#define worker ((GNUNET_WORKER_Handle) v_worker)
+
+	const GNUNET_WORKER_LifeInstructions destiny =
+		worker->on_start ?
+			worker->on_start(worker->data)
+		:
+			GNUNET_WORKER_LONG_LIFE;
+
+	if (destiny != GNUNET_WORKER_LONG_LIFE) {
+
+		pthread_mutex_lock(&worker->kill_mutex);
+
+		if (
+			atomic_load(&worker->state) == WORKER_IS_ALIVE &&
+			(worker->flags & WORKER_FLAG_OWN_THREAD)
+		) {
+
+			pthread_detach(worker->worker_thread);
+
+		}
+
+		worker_set_state(worker, WORKER_IS_DYING);
+		/*  Other threads might have started populating the wishlist before the
+			scheduler had even time to start...  */
+		wishlist_clear(worker);
+		GNUNET_WORKER_terminate(worker);
+
+		if (destiny == GNUNET_WORKER_DISMISSAL) {
+
+			/*  Worker must be dismissed  */
+
+			GNUNET_WORKER_dispose(worker);
+			return;
+
+		}
+
+		/*  `worker->on_start()` has returned `GNUNET_WORKER_DESTRUCTION`  */
+
+		GNUNET_WORKER_dispose_if_guest(worker);
+		GNUNET_SCHEDULER_shutdown();
+		return;
+
+		/*  `worker->kill_mutex` will be unlocked by `GNUNET_WORKER_dispose()`
+			either now or later...  */
+
+	}
+
+	worker->shutdown_schedule = GNUNET_SCHEDULER_add_shutdown(
+		&unattended_shutdown_handler,
+		v_worker
+	);
+
+	worker->listener_schedule = GNUNET_SCHEDULER_add_select(
+		WORKER_LISTENER_PRIORITY,
+		GNUNET_TIME_UNIT_FOREVER_REL,
+		worker->beep_fds,
+		NULL,
+		&load_request_handler,
+		v_worker
+	);
+
+	#undef worker
+
+}
+
+
+/**
+
+	@brief      The routine that is run in a new thread and invokes the
+	            worker's master for `GNUNET_WORKER_start_serving()` or
+	            `GNUNET_WORKER_adopt_running_scheduler()`
+	@param      v_worker        The worker in need of a master, passed as
+	                            `void *`                         [NON-NULLABLE]
+	@return     Nothing
+
+**/
+static void * master_launcher (
+	void * v_worker
+) {
+
+	#define worker ((GNUNET_WORKER_Handle) v_worker)
+
+	currently_serving_as = NULL;
+	worker->master(worker, worker->data);
+	return NULL;
+
+	#undef worker
+
+}
+
+
+/**
+
+	@brief      The routine that launches the GNUnet scheduler (often invoked
+	            via `pthread_create()`)
+	@param      v_worker        The worker in need of a running scheduler,
+	                            passed as `void *`               [NON-NULLABLE]
+	@return     Nothing
+
+**/
+static void * scheduler_launcher (
+	void * v_worker
+) {
+
+	#define worker ((GNUNET_WORKER_Handle) v_worker)
+
+	currently_serving_as = worker;
+	GNUNET_SCHEDULER_run(&worker_main_routine, v_worker);
+
+	if (!currently_serving_as) {
+
+		/*  The user has launched `GNUNET_WORKER_dismiss()`  */
+
+		return NULL;
+
+	}
+
+	if (atomic_load(&worker->state) != WORKER_IS_DEAD) {
+
+		/*  If we ended up here `GNUNET_SCHEDULER_add_shutdown()` has a bug  */
+
+		GNUNET_log(
+			GNUNET_ERROR_TYPE_ERROR,
+			_(
+				"The worker thread's event loop has been unexpectedly cut off "
+				"- the scheduler is down\n"
+			)
+		);
+
+		GNUNET_WORKER_flight_recorder_dump(
+			worker->flight_recorder,
+			GNUNET_WORKER_flight_recorder_fd()
+		);
+
+		exit(EINTR);
+
+	}
+
+	GNUNET_WORKER_dispose(worker);
+	return NULL;
+
+	#undef worker
+
+}
+
+
+/**
+
+	@brief      Allocate the memory necessary for a new worker
+    @param      save_handle         A placeholder for storing a handle for the
+                                    new worker created               [NULLABLE]
+    @param      master_routine      A master function to call in a new detached
+                                    thread                           [NULLABLE]
+	@param      on_worker_start     The first routine invoked by the worker,
+	                                with @p worker_data passed as argument; the
+	                                return value of this function determines
+	                                the destiny of the worker        [NULLABLE]
+	@param      on_worker_end       The last routine invoked by the worker,
+	                                with @p worker_data passed as argument
+	                                                                 [NULLABLE]
+    @param      worker_data         Custom user data retrievable at any moment
+	                                                                 [NULLABLE]
+	@param      worker_flags        The worker's flags
+	@return     A newly allocated (but not running) worker
+
+**/
+int GNUNET_WORKER_allocate (
+	GNUNET_WORKER_Handle * const save_handle,
+	const GNUNET_WORKER_MasterRoutine master_routine,
+	const GNUNET_WORKER_LifeRoutine on_worker_start,
+	const GNUNET_CallbackRoutine on_worker_end,
+	void * const worker_data,
+	const unsigned int worker_flags
+) {
+
+	const GNUNET_WORKER_Handle
+		new_worker = aligned_alloc(
+			_Alignof(GNUNET_WORKER_Instance),
+			sizeof(GNUNET_WORKER_Instance)
+		);
+
+	if (!new_worker) {
+
+		return GNUNET_WORKER_ERR_NO_MEMORY;
+
+	}
+
+	if (
+		!(
+			*((GNUNET_WORKER_Id *) &new_worker->id) =
+				GNUNET_WORKER_slot_assign(new_worker)
+		)
+	) {
+
+		free(new_worker);
+		return GNUNET_WORKER_ERR_NO_MEMORY;
+
+	}
+
+	if (
+		!(
+			*((FlightRecorder **) &new_worker->flight_recorder) =
+				GNUNET_WORKER_flight_recorder_open(new_worker)
+		)
+	) {
+
+		GNUNET_WORKER_slot_revoke(new_worker->id);
+		free(new_worker);
+		return GNUNET_WORKER_ERR_NO_MEMORY;
+
+	}
+
+	if (beep_channel_open((int *) new_worker->beep_fd) < 0) {
+
+		GNUNET_WORKER_flight_recorder_close(new_worker->flight_recorder);
+		GNUNET_WORKER_slot_revoke(new_worker->id);
+		free(new_worker);
+		return GNUNET_WORKER_ERR_SIGNAL;
+
+	}
+
+	requirement_init(&new_worker->scheduler_has_returned, REQ_INIT_RED);
+	atomic_init(&new_worker->calls_in_flight, 0);
+	pthread_mutex_init(&new_worker->kill_mutex, NULL);
+	pthread_mutex_init(&new_worker->room_mutex, NULL);
+	pthread_cond_init(&new_worker->room_cond, NULL);
+	atomic_init(&new_worker->wishlist, NULL);
+	atomic_init(&new_worker->cancellations, NULL);
+	atomic_init(&new_worker->spare_jobs, NULL);
+	atomic_init(&new_worker->spare_jobs_count, 0);
+	atomic_init(&new_worker->job_pool_size, WORKER_DEFAULT_JOB_POOL_SIZE);
+	atomic_init(&new_worker->pending_jobs, 0);
+	atomic_init(&new_worker->capacity, 0);
+	atomic_init(&new_worker->blocked_producers, 0);
+	new_worker->schedules = NULL;
+	new_worker->recycled_jobs = NULL;
+	new_worker->recycled_jobs_count = 0;
+	for (int idx = 0; idx < GNUNET_SCHEDULER_PRIORITY_COUNT; idx++) {
+		new_worker->buckets[idx].head = NULL;
+		new_worker->buckets[idx].tail = NULL;
+		new_worker->buckets[idx].dispatcher = NULL;
+		new_worker->buckets[idx].owner = new_worker;
+		atomic_init(&new_worker->buckets[idx].depth, 0);
+		new_worker->buckets[idx].priority = idx;
+	}
+	new_worker->busy_buckets = 0;
+	atomic_init(&new_worker->dispatch_budget, WORKER_DEFAULT_DISPATCH_BUDGET);
+	atomic_init(&new_worker->counters.jobs_pushed_locally, 0);
+	atomic_init(&new_worker->counters.jobs_pushed_remotely, 0);
+	atomic_init(&new_worker->counters.jobs_drained, 0);
+	atomic_init(&new_worker->counters.jobs_executed, 0);
+	atomic_init(&new_worker->counters.jobs_dropped, 0);
+	atomic_init(&new_worker->counters.beeps_sent, 0);
+	atomic_init(&new_worker->counters.beeps_failed, 0);
+	atomic_init(&new_worker->counters.beeps_received, 0);
+	atomic_init(&new_worker->counters.wakeups, 0);
+	atomic_init(&new_worker->counters.wishlist_peak, 0);
+	atomic_init(&new_worker->counters.scheduled_peak, 0);
+	atomic_init(&new_worker->latencies, NULL);
+	atomic_init(&new_worker->track_latency, false);
+	atomic_init(&new_worker->routine_table, NULL);
+	atomic_init(&new_worker->profile_flags, GNUNET_WORKER_PROFILE_OFF);
+	for (int idx = 0; idx < WORKER_PERF_COUNTERS; new_worker->perf_fd[idx++] = -1);
+	new_worker->listener_schedule = NULL;
+	new_worker->shutdown_schedule = NULL;
+	*((GNUNET_WORKER_MasterRoutine *) &new_worker->master) = master_routine;
+	*((GNUNET_WORKER_LifeRoutine *) &new_worker->on_start) = on_worker_start;
+	*((GNUNET_CallbackRoutine *) &new_worker->on_terminate) = on_worker_end;
+	*((void **) &new_worker->data) = worker_data;
+	*((struct GNUNET_NETWORK_FDSet **) &new_worker->beep_fds) =
+		GNUNET_NETWORK_fdset_create();
+	atomic_init(&new_worker->state, WORKER_IS_ALIVE);
+	atomic_init(&new_worker->future_plans, GNUNET_WORKER_LONG_LIFE);
+	*((unsigned int *) &new_worker->flags) = worker_flags;
+
+	/*  Fields left undefined: `::worker_thread`, `::recycled_jobs_tail`  */
+
+	GNUNET_NETWORK_fdset_set_native(
+		new_worker->beep_fds,
+		new_worker->beep_fd[0]
+	);
+
+	/*  `::state` has been initialized already, this only reports the birth
+		of the worker to the tracer  */
+
+	worker_set_state(new_worker, WORKER_IS_ALIVE);
+	*save_handle = new_worker;
+	return GNUNET_WORKER_SUCCESS;
+
+}
+
+
+
+		/*\
+		|*|
+		|*|     GLOBAL ENVIRONMENT
+		|*|    ________________________________
+		\*/
+
+
+
+	/*  Please see the public header for the complete documentation  */
+
+
+/**
+
+	@brief      Terminate a worker and free its memory, without waiting for the
+	            scheduler to return -- this will be completed in parallel
+	            (asynchronous)
+
+*/
+int GNUNET_WORKER_asynch_destroy (
+	const GNUNET_WORKER_Handle worker
+) {
+
+	int retval = GNUNET_WORKER_SUCCESS;
+
+	worker_enter(worker);
+
+	switch (atomic_load(&worker->state)) {
+
+		case WORKER_IS_ZOMBIE:
+
+			if (currently_serving_as == worker) {
+
+				/*  The zombie will be unzombified...  */
+
+				goto asynch_self_destroy;
+
+			}
+
+			if (worker_beep(worker)) {
+
+				/*  The zombie will be unzombified...  */
+
+				goto leave_and_exit;
+
+			}
+
+			retval = GNUNET_WORKER_ERR_SIGNAL;
+			goto leave_and_exit;
+
+		case WORKER_IS_ALIVE:
+
+			if (pthread_mutex_trylock(&worker->kill_mutex)) {
+
+				if (worker->on_terminate) {
+
+		case WORKER_SAYS_BYE:
+
+					/*  It was still safe to call this function...  */
+
+					goto leave_and_exit;
+
+				}
+
+		default:
+
+				GNUNET_WORKER_log(
+					GNUNET_ERROR_TYPE_ERROR,
+					_("Double free detected\n")
+				);
+
+				retval = GNUNET_WORKER_ERR_DOUBLE_FREE;
+				goto leave_and_exit;
+
+			}
+
+	}
+
+	worker_set_state(
+		worker,
+		worker->on_terminate ?
+			WORKER_SAYS_BYE
+		:
+			WORKER_IS_DYING
+	);
+
+	if (currently_serving_as == worker) {
+
+		/*  The user has called this function from the worker thread  */
+
+		if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+
+			pthread_detach(worker->worker_thread);
+
+		}
+
+
+		/* \                                 /\
+		\ */     asynch_self_destroy:       /* \
+		 \/     _______________________     \ */
+
+
+		clear_schedule(&worker->listener_schedule);
+		job_list_unschedule_and_clear(&worker->schedules);
+		buckets_unschedule_and_clear(worker);
+		wishlist_clear(worker);
+		GNUNET_SCHEDULER_cancel(worker->shutdown_schedule);
+
+		worker->shutdown_schedule = GNUNET_SCHEDULER_add_shutdown(
+			&attended_shutdown_handler,
+			worker
+		);
+
+		pthread_mutex_unlock(&worker->kill_mutex);
+		worker_leave(worker);
+		GNUNET_SCHEDULER_shutdown();
+		return GNUNET_WORKER_SUCCESS;
+
+	}
+
+	/*  The user has **not** called this function from the worker thread  */
+
+	if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+
+		pthread_detach(worker->worker_thread);
+
+	}
+
+	atomic_store(&worker->future_plans, GNUNET_WORKER_DESTRUCTION);
+
+	/*
+
+	A non-empty wishlist means that a beep is already on its way. Since the
+	worker detaches the wishlist first and reads `::future_plans` only
+	afterwards, if we still see a job in the wishlist here the worker is
+	guaranteed to see our plans the next time it wakes up.
+
+	*/
+
+	if (!atomic_load(&worker->wishlist) && !worker_beep(worker)) {
+
+		/*  Beep channel is down...  */
+
+		worker_set_state(worker, WORKER_IS_ZOMBIE);
+		retval = GNUNET_WORKER_ERR_SIGNAL;
+
+	} else {
+
+		retval = GNUNET_WORKER_SUCCESS;
+
+	}
+
+	pthread_mutex_unlock(&worker->kill_mutex);
+
+
+	/* \                                 /\
+	\ */     leave_and_exit:            /* \
+	 \/     _______________________     \ */
+
+
+	worker_leave(worker);
+	return retval;
+
+}
+
+
+/**
+
+	@brief      Uninstall and destroy a worker without shutting down its
+	            scheduler
+
+*/
+int GNUNET_WORKER_dismiss (
+	const GNUNET_WORKER_Handle worker
+) {
+
+	int retval = GNUNET_WORKER_SUCCESS;
+
+	worker_enter(worker);
+
+	switch (atomic_load(&worker->state)) {
+
+		case WORKER_IS_ZOMBIE:
+
+			if (currently_serving_as == worker) {
+
+				/*  The zombie will be unzombified...  */
+
+				goto self_dismiss;
+
+			}
+
+			if (worker_beep(worker)) {
+
+				/*  The zombie will be unzombified...  */
+
+				goto leave_and_exit;
+
+			}
+
+			retval = GNUNET_WORKER_ERR_SIGNAL;
+			goto leave_and_exit;
+
+		case WORKER_IS_ALIVE:
+
+			if (pthread_mutex_trylock(&worker->kill_mutex)) {
+
+				if (worker->on_terminate) {
+
+		case WORKER_SAYS_BYE:
+
+					/*  It was still safe to call this function...  */
+
+					goto leave_and_exit;
+
+				}
+
+		default:
+
+				GNUNET_WORKER_log(
+					GNUNET_ERROR_TYPE_ERROR,
+					_("Double free detected\n")
+				);
+
+				retval = GNUNET_WORKER_ERR_DOUBLE_FREE;
+				goto leave_and_exit;
+
+			}
+
+	}
+
+	worker_set_state(
+		worker,
+		worker->on_terminate ?
+			WORKER_SAYS_BYE
+		:
+			WORKER_IS_DYING
+	);
+
+	if (currently_serving_as == worker) {
+
+		/*  The user has called this function from the worker thread  */
+
+		if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+
+			pthread_detach(worker->worker_thread);
+
+		}
+
+
+		/* \                                 /\
+		\ */     self_dismiss:              /* \
+		 \/     _______________________     \ */
+
+
+		clear_schedule(&worker->shutdown_schedule);
+		clear_schedule(&worker->listener_schedule);
+		wishlist_clear(worker);
+		job_list_unschedule_and_clear(&worker->schedules);
+		buckets_unschedule_and_clear(worker);
+		GNUNET_WORKER_terminate(worker);
+		worker_leave(worker);
+		/*  `GNUNET_WORKER_dispose()` will unlock `worker->kill_mutex`...  */
+		GNUNET_WORKER_dispose(worker);
+		return GNUNET_WORKER_SUCCESS;
+
+	}
+
+	/*  The user has **not** called this function from the worker thread  */
+
+	if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+
+		pthread_detach(worker->worker_thread);
+
+	}
+
+	atomic_store(&worker->future_plans, GNUNET_WORKER_DISMISSAL);
+
+	/*  See the comments in `GNUNET_WORKER_asynch_destroy()`  */
+
+	if (!atomic_load(&worker->wishlist) && !worker_beep(worker)) {
+
+		/*  Beep channel is down...  */
+
+		worker_set_state(worker, WORKER_IS_ZOMBIE);
+		retval = GNUNET_WORKER_ERR_SIGNAL;
+
+	} else {
+
+		retval = GNUNET_WORKER_SUCCESS;
+
+	}
+
+	pthread_mutex_unlock(&worker->kill_mutex);
+
+
+	/* \                                 /\
+	\ */     leave_and_exit:            /* \
+	 \/     _______________________     \ */
+
+
+	worker_leave(worker);
+	return retval;
+
+}
+
+
+/**
+
+	@brief      Terminate a worker and free its memory, waiting for the
+	            scheduler to complete the shutdown (synchronous)
+
+*/
+int GNUNET_WORKER_synch_destroy (
+	const GNUNET_WORKER_Handle worker
+) {
+
+	worker_enter(worker);
+
+	switch (atomic_load(&worker->state)) {
+
+		case WORKER_IS_ZOMBIE:
+
+			if (currently_serving_as == worker) {
+
+				/*  The zombie will be unzombified...  */
+
+				goto synch_self_destroy;
+
+			}
+
+			if (worker_beep(worker)) {
+
+				/*  The zombie will be unzombified...  */
+
+				worker_leave(worker);
+				return GNUNET_WORKER_SUCCESS;
+
+			}
+
+			worker_leave(worker);
+			return GNUNET_WORKER_ERR_SIGNAL;
+
+		case WORKER_IS_ALIVE:
+
+			if (pthread_mutex_trylock(&worker->kill_mutex)) {
+
+				if (worker->on_terminate) {
+
+		case WORKER_SAYS_BYE:
+
+					/*  It was still safe to call this function...  */
+
+					worker_leave(worker);
+					return GNUNET_WORKER_ERR_NOT_ALONE;
+
+				}
+
+		default:
+
+				GNUNET_WORKER_log(
+					GNUNET_ERROR_TYPE_ERROR,
+					_("Double free detected\n")
+				);
+
+				worker_leave(worker);
+				return GNUNET_WORKER_ERR_DOUBLE_FREE;
+
+			}
+
+	}
+
+	worker_set_state(
+		worker,
+		worker->on_terminate ?
+			WORKER_SAYS_BYE
+		:
+			WORKER_IS_DYING
+	);
+
+	if (currently_serving_as == worker) {
+
+		/*  The user has called this function from the worker thread  */
+
+		if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+
+			pthread_detach(worker->worker_thread);
+
+		}
+
+
+		/* \                                 /\
+		\ */     synch_self_destroy:        /* \
+		 \/     _______________________     \ */
+
+
+		clear_schedule(&worker->shutdown_schedule);
+		clear_schedule(&worker->listener_schedule);
+		wishlist_clear(worker);
+		job_list_unschedule_and_clear(&worker->schedules);
+		buckets_unschedule_and_clear(worker);
+		GNUNET_WORKER_terminate(worker);
+		worker_leave(worker);
+		GNUNET_WORKER_dispose_if_guest(worker);
+		GNUNET_SCHEDULER_shutdown();
+		return GNUNET_WORKER_SUCCESS;
+
+		/*  `worker->kill_mutex` will be unlocked by `GNUNET_WORKER_dispose()`
+			either now or later...  */
+
+	}
+
+	/*  The user has **not** called this function from the worker thread  */
+
+	atomic_store(&worker->future_plans, GNUNET_WORKER_DESTRUCTION);
+
+	/*  See the comments in `GNUNET_WORKER_asynch_destroy()`  */
+
+	int tempval = !atomic_load(&worker->wishlist) && !worker_beep(worker);
+
+	if (tempval) {
+
+		/*  Beep channel is down...  */
+
+		if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+
+			pthread_detach(worker->worker_thread);
+
+		}
+
+		worker_set_state(worker, WORKER_IS_ZOMBIE);
+		pthread_mutex_unlock(&worker->kill_mutex);
+		worker_leave(worker);
+		return GNUNET_WORKER_ERR_SIGNAL;
+
+	}
+
+	pthread_mutex_unlock(&worker->kill_mutex);
+
+	if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+
+		/*  We started the scheduler's thread: it must be joined  */
+
+		pthread_t thread_ref_copy = worker->worker_thread;
+		worker_leave(worker);
+		tempval = pthread_join(thread_ref_copy, NULL);
+
+		if (tempval) {
+
+			pthread_detach(thread_ref_copy);
+
+		}
+
+		switch (tempval) {
+
+			case __EOK__: return GNUNET_WORKER_SUCCESS;
+
+			case EDEADLK: case EINVAL: case EPERM: case ESRCH:
+
+				GNUNET_log(
+					GNUNET_ERROR_TYPE_WARNING,
+					_(
+						"`%s` has returned `%d`, possibly due to a bug in the "
+						"GNUnet Worker module\n"
+					),
+					"pthread_join()",
+					tempval
+				);
+
+				return GNUNET_WORKER_ERR_INTERNAL_BUG;
+
+		}
+
+		/*  This should not happen with a decent C library...  */
+
+		GNUNET_log(
+			GNUNET_ERROR_TYPE_WARNING,
+			_(
+				"`%s` has returned `%d` (unknown code) while waiting for the "
+				"worker thread to terminate\n"
+			),
+			"pthread_join()",
+			tempval
+		);
+
+		return GNUNET_WORKER_ERR_UNKNOWN;
+
+	}
+
+	/*  We did not start the scheduler's thread: it must live  */
+
+	tempval = requirement_wait_for_green(&worker->scheduler_has_returned);
+	worker_leave(worker);
+
+	switch (tempval) {
+
+		case __EOK__: return GNUNET_WORKER_SUCCESS;
+
+		case EINVAL: case EPERM:
+
+			GNUNET_log(
+				GNUNET_ERROR_TYPE_WARNING,
+				_(
+					"`%s` has returned `%d`, possibly due to a bug in the "
+					"GNUnet Worker module\n"
+				),
+				"pthread_cond_wait()",
+				tempval
+			);
+
+			return GNUNET_WORKER_ERR_INTERNAL_BUG;
+
+	}
+
+	/*  This should not happen with a decent C library...  */
+
+	GNUNET_log(
+		GNUNET_ERROR_TYPE_WARNING,
+		_(
+			"`%s` has returned `%d` (unknown code) while waiting for the "
+			"worker thread to terminate\n"
+		),
+		"pthread_cond_wait()",
+		tempval
+	);
+
+	return GNUNET_WORKER_ERR_UNKNOWN;
+
+}
+
+
+/**
+
+	@brief      Terminate a worker and free its memory, waiting for the
+	            scheduler to complete the shutdown (synchronous), but only if
+	            this happens within a certain time, otherwise it will be
+	            completed in parallel (asynchronous)
+
+*/
+int GNUNET_WORKER_timedsynch_destroy (
+	const GNUNET_WORKER_Handle worker,
+	const struct timespec * const absolute_time
+) {
+
+	worker_enter(worker);
+
+	switch (atomic_load(&worker->state)) {
+
+		case WORKER_IS_ZOMBIE:
+
+			if (currently_serving_as == worker) {
+
+				/*  The zombie will be unzombified...  */
+
+				goto synch_self_destroy;
+
+			}
+
+			if (worker_beep(worker)) {
+
+				/*  The zombie will be unzombified...  */
+
+				worker_leave(worker);
+				return GNUNET_WORKER_SUCCESS;
+
+			}
+
+			worker_leave(worker);
+			return GNUNET_WORKER_ERR_SIGNAL;
+
+		case WORKER_IS_ALIVE:
+
+			if (pthread_mutex_trylock(&worker->kill_mutex)) {
+
+				if (worker->on_terminate) {
+
+		case WORKER_SAYS_BYE:
+
+					/*  It was still safe to call this function...  */
+
+					worker_leave(worker);
+					return GNUNET_WORKER_ERR_NOT_ALONE;
+
+				}
+
+		default:
+
+				GNUNET_WORKER_log(
+					GNUNET_ERROR_TYPE_ERROR,
+					_("Double free detected\n")
+				);
+
+				worker_leave(worker);
+				return GNUNET_WORKER_ERR_DOUBLE_FREE;
+
+			}
+
+	}
+
+	worker_set_state(
+		worker,
+		worker->on_terminate ?
+			WORKER_SAYS_BYE
+		:
+			WORKER_IS_DYING
+	);
+
+	if (currently_serving_as == worker) {
+
+		/*  The user has called this function from the worker thread  */
+
+		if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+
+			pthread_detach(worker->worker_thread);
+
+		}
+
+
+		/* \                                 /\
+		\ */     synch_self_destroy:        /* \
+		 \/     _______________________     \ */
+
+
+		clear_schedule(&worker->shutdown_schedule);
+		clear_schedule(&worker->listener_schedule);
+		wishlist_clear(worker);
+		job_list_unschedule_and_clear(&worker->schedules);
+		buckets_unschedule_and_clear(worker);
+		GNUNET_WORKER_terminate(worker);
+		worker_leave(worker);
+		GNUNET_WORKER_dispose_if_guest(worker);
+		GNUNET_SCHEDULER_shutdown();
+		return GNUNET_WORKER_SUCCESS;
+
+		/*  `worker->kill_mutex` will be unlocked by `GNUNET_WORKER_dispose()`
+			either now or later...  */
+
+	}
+
+	/*  The user has **not** called this function from the worker thread  */
+
+	atomic_store(&worker->future_plans, GNUNET_WORKER_DESTRUCTION);
+
+	/*  See the comments in `GNUNET_WORKER_asynch_destroy()`  */
+
+	int tempval = !atomic_load(&worker->wishlist) && !worker_beep(worker);
+
+	if (tempval) {
+
+		/*  Beep channel is down...  */
+
+		if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+
+			pthread_detach(worker->worker_thread);
+
+		}
+
+		worker_set_state(worker, WORKER_IS_ZOMBIE);
+		pthread_mutex_unlock(&worker->kill_mutex);
+		worker_leave(worker);
+		return GNUNET_WORKER_ERR_SIGNAL;
+
+	}
+
+	pthread_mutex_unlock(&worker->kill_mutex);
+
+	if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+
+		/*  We started the scheduler's thread: it must be joined  */
+
+		pthread_t thread_ref_copy = worker->worker_thread;
+		worker_leave(worker);
+		tempval = pthread_timedjoin_np(thread_ref_copy, NULL, absolute_time);
+
+		if (tempval) {
+
+			pthread_detach(thread_ref_copy);
+
+		}
+
+		switch (tempval) {
+
+			case __EOK__: return GNUNET_WORKER_SUCCESS;
+
+			case EDEADLK: case EPERM: case ESRCH:
+
+				GNUNET_log(
+					GNUNET_ERROR_TYPE_WARNING,
+					_(
+						"`%s` has returned `%d`, possibly due to a bug in the "
+						"GNUnet Worker module\n"
+					),
+					"pthread_timedjoin_np()",
+					tempval
+				);
+
+				return GNUNET_WORKER_ERR_INTERNAL_BUG;
+
+			case ETIMEDOUT: return GNUNET_WORKER_ERR_EXPIRED;
+
+			case EINVAL: return GNUNET_WORKER_ERR_INVALID_TIME;
+
+		}
+
+		/*  This should not happen with a decent C library...  */
+
+		GNUNET_log(
+			GNUNET_ERROR_TYPE_WARNING,
+			_(
+				"`%s` has returned `%d` (unknown code) while waiting for the "
+				"worker thread to terminate\n"
+			),
+			"pthread_timedjoin_np()",
+			tempval
+		);
+
+		return GNUNET_WORKER_ERR_UNKNOWN;
+
+	}
+
+	/*  We did not start the scheduler's thread: it must live  */
+
+	tempval = requirement_timedwait_for_green(
+		&worker->scheduler_has_returned,
+		absolute_time
+	);
+
+	worker_leave(worker);
+
+	switch (tempval) {
+
+		case __EOK__: return GNUNET_WORKER_SUCCESS;
+
+		case ETIMEDOUT: return GNUNET_WORKER_ERR_EXPIRED;
+
+		case EINVAL: return GNUNET_WORKER_ERR_INVALID_TIME;
+
+		case EPERM:
+
+			GNUNET_log(
+				GNUNET_ERROR_TYPE_WARNING,
+				_(
+					"`%s` has returned `%d`, possibly due to a bug in the "
+					"GNUnet Worker module\n"
+				),
+				"pthread_cond_timedwait()",
+				tempval
+			);
+
+			return GNUNET_WORKER_ERR_INTERNAL_BUG;
+
+	}
+
+	/*  This should not happen with a decent C library...  */
+
+	GNUNET_log(
+		GNUNET_ERROR_TYPE_WARNING,
+		_(
+			"`%s` has returned `%d` (unknown code) while waiting for the "
+			"worker thread to terminate\n"
+		),
+		"pthread_cond_timedwait()",
+		tempval
+	);
+
+	return GNUNET_WORKER_ERR_UNKNOWN;
+
+}
+
+
+/**
+
+	@brief      Wait until there is room for new jobs in a worker and reserve it
+	@param      worker          The worker to reserve room in    [NON-NULLABLE]
+	@param      job_count       The number of jobs to make room for
+	@param      absolute_time   The absolute time to wait until, or `NULL` for
+	                            waiting indefinitely                 [NULLABLE]
+	@return     Possible return values are `GNUNET_WORKER_SUCCESS` (`0`),
+	            `GNUNET_WORKER_ERR_QUEUE_FULL` (the jobs would never fit),
+	            `GNUNET_WORKER_ERR_EXPIRED`, `GNUNET_WORKER_ERR_INVALID_TIME`
+	            and `GNUNET_WORKER_ERR_UNKNOWN`
+
+	If the worker stops being alive while we wait, the room is reserved anyway:
+	the jobs will be cancelled by the shutdown, like those of any other thread
+	that pushes them too late.
+
+**/
+static int jobs_wait_for_room (
+	const GNUNET_WORKER_Handle worker,
+	const size_t job_count,
+	const struct timespec * const absolute_time
+) {
+
+	int retval = GNUNET_WORKER_SUCCESS, tempval;
+	size_t capacity;
+
+	pthread_mutex_lock(&worker->room_mutex);
+
+	/*  This must happen before we look at `worker->pending_jobs` (see
+		`jobs_release()`)  */
+
+	atomic_fetch_add(&worker->blocked_producers, 1);
+
+	while (!jobs_reserve(worker, job_count)) {
+
+		capacity = atomic_load_explicit(&worker->capacity, memory_order_relaxed);
+
+		if (capacity && job_count > capacity) {
+
+			retval = GNUNET_WORKER_ERR_QUEUE_FULL;
+			goto stop_waiting;
+
+		}
+
+		switch (atomic_load(&worker->state)) {
+
+			case WORKER_IS_ALIVE:
+			case WORKER_IS_ZOMBIE:
+
+				break;
+
+			default:
+
+				atomic_fetch_add(&worker->pending_jobs, job_count);
+				goto stop_waiting;
+
+		}
+
+		tempval =
+			absolute_time ?
+				pthread_cond_timedwait(
+					&worker->room_cond,
+					&worker->room_mutex,
+					absolute_time
+				)
+			:
+				pthread_cond_wait(&worker->room_cond, &worker->room_mutex);
+
+		switch (tempval) {
+
+			case __EOK__: continue;
+
+			case ETIMEDOUT: retval = GNUNET_WORKER_ERR_EXPIRED; break;
+
+			case EINVAL: retval = GNUNET_WORKER_ERR_INVALID_TIME; break;
+
+			default: retval = GNUNET_WORKER_ERR_UNKNOWN;
+
+		}
+
+		break;
 
 	}
 
-	job->routine(job->data);
-	free(job);
 
-	#undef job
+	/* \                                 /\
+	\ */     stop_waiting:              /* \
+	 \/     _______________________     \ */
+
+
+	atomic_fetch_sub(&worker->blocked_producers, 1);
+	pthread_mutex_unlock(&worker->room_mutex);
+	return retval;
 
 }
 
 
 /**
 
-	@brief      A routine that is woken up by a pipe and schedules new tasks
-	            requested by other threads
-	@param      v_worker        The worker this listener routine belongs to,
-	                            passed as `void *`               [NON-NULLABLE]
+	@brief      Schedule a batch of new functions for the worker, atomically,
+	            possibly waiting for the worker to make room for them
+	@param      worker          The worker for which the tasks must be
+	                            scheduled                        [NON-NULLABLE]
+	@param      jobs            The jobs to push                 [NON-NULLABLE]
+	@param      job_count       The number of jobs in @p jobs
+	@param      may_wait        Whether to wait if the worker has reached its
+	                            capacity (ignored in the worker thread)
+	@param      absolute_time   The absolute time to wait until, or `NULL` for
+	                            waiting indefinitely                 [NULLABLE]
+	@param      save_tickets    An array of @p job_count placeholders for
+	                            storing a ticket for each job, or `NULL` if no
+	                            tickets are needed                   [NULLABLE]
+	@param      due_time        When the jobs must run (zero for as soon as
+	                            possible)
+	@param      period          The interval between two runs of the jobs (zero
+	                            for jobs that must run only once)
+	@param      own_job         A node owned by the caller to use for the only
+	                            job of @p jobs, already reserved by the caller
+	                            (see `GNUNET_WORKER_push_job()`), or `NULL` for
+	                            taking the nodes from the pool       [NULLABLE]
+	@return     See `GNUNET_WORKER_push_load_batch()`,
+	            `GNUNET_WORKER_wait_push_load()`,
+	            `GNUNET_WORKER_timedwait_push_load()`,
+	            `GNUNET_WORKER_push_load_with_ticket()`,
+	            `GNUNET_WORKER_push_load_at()`,
+	            `GNUNET_WORKER_push_load_periodic()` and
+	            `GNUNET_WORKER_push_job()`
+
+	Tickets are stored only if the jobs have actually been published; in all
+	other cases the placeholders are set to `NULL`. Jobs stay published (and
+	their tickets valid) only on success or when `GNUNET_WORKER_ERR_SIGNAL` is
+	returned because the worker could not be woken up after other threads had
+	stacked their jobs on top of them. On any other failure @p own_job is given
+	back to the caller; when the jobs are dropped right away it is handed back
+	via its completion function at once.
 
 **/
-static void load_request_handler (
-	void * const v_worker
+static int load_push (
+	const GNUNET_WORKER_Handle worker,
+	const GNUNET_WORKER_Load * const jobs,
+	const size_t job_count,
+	const bool may_wait,
+	const struct timespec * const absolute_time,
+	GNUNET_WORKER_JobList ** const save_tickets,
+	const struct GNUNET_TIME_Absolute due_time,
+	const struct GNUNET_TIME_Relative period,
+	GNUNET_WORKER_JobList * const own_job
 ) {
 
-	#define worker ((GNUNET_WORKER_Handle) v_worker)
+	if (save_tickets) {
 
-	pthread_mutex_lock(&worker->wishes_mutex);
+		for (size_t idx = 0; idx < job_count; save_tickets[idx++] = NULL);
 
-	GNUNET_WORKER_JobList * const last_wish = worker->wishlist;
-	const int what_to_do = worker->future_plans;
-	unsigned char beep = BEEP_CODE;
+	}
 
-	/*  Flush the pipe  */
+	if (!job_count) {
 
-	if (
-		(
-			read(worker->beep_fd[0], &beep, 1) != 1 &&
-			worker->listener_schedule
-		) || beep != BEEP_CODE
-	) {
+		return GNUNET_WORKER_SUCCESS;
 
-		GNUNET_log(
-			GNUNET_ERROR_TYPE_WARNING,
-			_("Unable to read the notification sent to the worker thread\n")
-		);
+	}
+
+	worker_enter(worker);
+
+	int retval = GNUNET_WORKER_SUCCESS;
+	bool published = false;
+
+	for (size_t idx = 0; idx < job_count; idx++) {
+
+		if (!priority_is_valid(jobs[idx].priority)) {
+
+			retval = GNUNET_WORKER_ERR_INVALID_PRIORITY;
+			goto leave_and_exit;
+
+		}
 
 	}
 
-	if (what_to_do != GNUNET_WORKER_LONG_LIFE) {
+	switch (atomic_load(&worker->state)) {
 
-		/*  Worker must die (possibly shutting down the scheduler)  */
+		case WORKER_IS_ALIVE:
 
-		pthread_mutex_lock(&worker->kill_mutex);
-		worker->listener_schedule = NULL;
-		job_list_clear_unlocked(&worker->wishlist);
-		pthread_mutex_unlock(&worker->wishes_mutex);
-		clear_schedule(&worker->shutdown_schedule);
-		job_list_unschedule_and_clear(&worker->schedules);
-		GNUNET_WORKER_terminate(worker);
+			break;
 
-		/*  `worker->kill_mutex` will be unlocked by `GNUNET_WORKER_dispose()`
-			either now or later...  */
+		case WORKER_IS_ZOMBIE:
 
-		if (what_to_do == GNUNET_WORKER_DISMISSAL) {
+			if (currently_serving_as == worker) {
 
-			GNUNET_WORKER_dispose(worker);
-			return;
+				/*  The zombie will be unzombified...  */
 
-		}
+				/*
 
-		/*  `what_to_do` equals `GNUNET_WORKER_DESTRUCTION`  */
+				We return `GNUNET_WORKER_SUCCESS` here. It will appear as if
+				the jobs were scheduled and then immediately cancelled by the
+				shutdown, although none of it really took place...
 
-		GNUNET_WORKER_dispose_if_guest(worker);
-		GNUNET_SCHEDULER_shutdown();
-		return;
+				*/
 
-	}
+				clear_schedule(&worker->listener_schedule);
+				worker_leave(worker);
+				load_request_handler(worker);
 
-	/*  Worker must live  */
+				if (own_job) {
 
-	worker->wishlist = NULL;
-	pthread_mutex_unlock(&worker->wishes_mutex);
+					job_complete(own_job, false);
 
-	if (last_wish) {
+				}
 
-		GNUNET_WORKER_JobList * first_wish, * iter = last_wish;
+				return GNUNET_WORKER_SUCCESS;
 
-		/*  `worker->wishlist` is processed in chronological order  */
+			}
 
-		do {
+			if (!worker_beep(worker)) {
 
-			first_wish = iter;
-			iter = first_wish->next;
-			first_wish->next = first_wish->prev;
-			first_wish->prev = iter;
+				retval = GNUNET_WORKER_ERR_SIGNAL;
+				goto leave_and_exit;
 
-		} while (iter);
+			}
 
-		iter = first_wish;
+			/*  The zombie will be unzombified...  */
 
-		do {
+			/*  No case break (fallthrough)  */
 
-			iter->scheduled_as = GNUNET_SCHEDULER_add_with_priority(
-				iter->priority,
-				&call_and_unlist_handler,
-				iter
+		case WORKER_SAYS_BYE:
+
+			/*
+
+			We return `GNUNET_WORKER_SUCCESS` here. It will appear as if the
+			jobs were scheduled and then immediately cancelled by the shutdown,
+			although none of it really took place...
+
+			*/
+
+			goto drop_and_exit;
+
+		default:
+
+			GNUNET_WORKER_log(
+				GNUNET_ERROR_TYPE_ERROR,
+				_(
+					"An attempt to push load into a destroyed worker has been "
+					"detected\n"
+				)
 			);
 
-		} while ((iter = iter->next));
+			retval = GNUNET_WORKER_ERR_INVALID_HANDLE;
+			goto leave_and_exit;
 
-		/*  `worker->schedules` is not kept in chronological order  */
+	}
 
-		if (worker->schedules) {
+	/*  Reserve room for the jobs first  */
 
-			last_wish->next = worker->schedules;
-			worker->schedules->prev = last_wish;
+	if (!jobs_reserve(worker, job_count)) {
+
+		if (!may_wait || currently_serving_as == worker) {
+
+			/*  The worker thread cannot wait for itself  */
+
+			retval = GNUNET_WORKER_ERR_QUEUE_FULL;
+			goto leave_and_exit;
 
 		}
 
-		worker->schedules = first_wish;
+		if ((retval = jobs_wait_for_room(worker, job_count, absolute_time))) {
+
+			goto leave_and_exit;
+
+		}
 
 	}
 
-	/*  To the next awakening...  */
+	/*  All the memory is allocated in advance: either every job is pushed or
+		none is  */
 
-	worker->listener_schedule =
-		atomic_load(&worker->state) == WORKER_IS_ALIVE ?
-			GNUNET_SCHEDULER_add_select(
-				WORKER_LISTENER_PRIORITY,
-				GNUNET_TIME_UNIT_FOREVER_REL,
-				worker->beep_fds,
-				NULL,
-				&load_request_handler,
-				v_worker
-			)
-		:
-			NULL;
+	GNUNET_WORKER_JobList * bottom_job = NULL, * top_job = NULL, * new_job;
 
-	#undef worker
+	const uint64_t pushed_at =
+		atomic_load_explicit(&worker->track_latency, memory_order_relaxed) ?
+			monotonic_now()
+		:
+			0;
 
-}
+	for (size_t idx = 0; idx < job_count; idx++) {
 
+		if (!(new_job = own_job ? own_job : job_alloc(worker))) {
 
-/**
+			job_chain_free(top_job);
+			jobs_release(worker, job_count);
+			retval = GNUNET_WORKER_ERR_NO_MEMORY;
+			goto forget_tickets_and_exit;
 
-	@brief      The scheduler's main task that initializes a worker
-	@param      v_worker        The worker this is the main routine of, passed
-	                            as `void *`                      [NON-NULLABLE]
+		}
 
-**/
-static void worker_main_routine (
-	void * const v_worker
-) {
+		new_job->routine = jobs[idx].routine;
+		new_job->data = jobs[idx].data;
+		new_job->priority = jobs[idx].priority;
+		new_job->assigned_to = worker;
+		new_job->worker_id = worker->id;
+		new_job->prev = NULL;
+		new_job->scheduled_as = NULL;
+		new_job->due = due_time;
+		new_job->period = period;
+		new_job->pushed_at = pushed_at;
+		new_job->rerun = false;
 
-	#define worker ((GNUNET_WORKER_Handle) v_worker)
+		if (!own_job) {
 
-	const GNUNET_WORKER_LifeInstructions destiny =
-		worker->on_start ?
-			worker->on_start(worker->data)
-		:
-			GNUNET_WORKER_LONG_LIFE;
+			new_job->on_complete = NULL;
 
-	if (destiny != GNUNET_WORKER_LONG_LIFE) {
+		}
 
-		pthread_mutex_lock(&worker->kill_mutex);
+		if ((new_job->ticketed = save_tickets != NULL)) {
 
-		if (
-			atomic_load(&worker->state) == WORKER_IS_ALIVE &&
-			(worker->flags & WORKER_FLAG_OWN_THREAD)
-		) {
+			/*  One reference for the worker and one for the ticket  */
 
-			pthread_detach(worker->worker_thread);
+			atomic_init(&new_job->status, JOB_IS_PENDING);
+			atomic_init(&new_job->refs, 2);
+			save_tickets[idx] = new_job;
 
 		}
 
-		atomic_store(&worker->state, WORKER_IS_DYING);
-		/*  Other threads might have started populating the wishlist before the
-			scheduler had even time to start...  */
-		job_list_clear_locked(&worker->wishlist, &worker->wishes_mutex);
-		GNUNET_WORKER_terminate(worker);
+		/*  The last job of the batch stays on top of the chain, as if each
+			job had been pushed individually  */
 
-		if (destiny == GNUNET_WORKER_DISMISSAL) {
+		new_job->next = top_job;
+		top_job = new_job;
 
-			/*  Worker must be dismissed  */
+		if (!bottom_job) {
 
-			GNUNET_WORKER_dispose(worker);
-			return;
+			bottom_job = new_job;
 
 		}
 
-		/*  `worker->on_start()` has returned `GNUNET_WORKER_DESTRUCTION`  */
+	}
 
-		GNUNET_WORKER_dispose_if_guest(worker);
-		GNUNET_SCHEDULER_shutdown();
-		return;
+	if (currently_serving_as == worker) {
 
-		/*  `worker->kill_mutex` will be unlocked by `GNUNET_WORKER_dispose()`
-			either now or later...  */
+		/*  The user has called this function from the worker thread  */
+
+		counter_bump(&worker->counters.jobs_pushed_locally, job_count);
+		trace_job_chain(worker, GNUNET_WORKER_TRACE_ENQUEUE, top_job);
+
+		WORKER_PROBE4(
+			push,
+			worker,
+			jobs->priority,
+			job_count,
+			atomic_load_explicit(&worker->pending_jobs, memory_order_relaxed)
+		);
+
+		jobs_schedule(worker, top_job);
+		goto leave_and_exit;
 
 	}
 
-	worker->shutdown_schedule = GNUNET_SCHEDULER_add_shutdown(
-		&unattended_shutdown_handler,
-		v_worker
-	);
+	/*  The user has **not** called this function from the worker thread  */
 
-	worker->listener_schedule = GNUNET_SCHEDULER_add_select(
-		WORKER_LISTENER_PRIORITY,
-		GNUNET_TIME_UNIT_FOREVER_REL,
-		worker->beep_fds,
-		NULL,
-		&load_request_handler,
-		v_worker
-	);
+	GNUNET_WORKER_JobList * old_head =
+		atomic_load_explicit(&worker->wishlist, memory_order_relaxed);
 
-	#undef worker
+	/*  Counted before the jobs are published, so that the worker never drains
+		more jobs than those counted here  */
 
-}
+	counter_add(&worker->counters.jobs_pushed_remotely, job_count);
 
+	/*  Reported before the jobs are published too, or the worker thread could
+		report them as started before they are reported as pushed  */
 
-/**
+	trace_job_chain(worker, GNUNET_WORKER_TRACE_ENQUEUE, top_job);
 
-	@brief      The routine that is run in a new thread and invokes the
-	            worker's master for `GNUNET_WORKER_start_serving()` or
-	            `GNUNET_WORKER_adopt_running_scheduler()`
-	@param      v_worker        The worker in need of a master, passed as
-	                            `void *`                         [NON-NULLABLE]
-	@return     Nothing
+	WORKER_PROBE4(
+		push,
+		worker,
+		jobs->priority,
+		job_count,
+		atomic_load_explicit(&worker->pending_jobs, memory_order_relaxed)
+	);
 
-**/
-static void * master_launcher (
-	void * v_worker
-) {
+	/*  Lock-free push: producers never block each other (and once published
+		the chain belongs to the worker thread, so we only look at our private
+		copy of the old head afterwards)  */
 
-	#define worker ((GNUNET_WORKER_Handle) v_worker)
+	do {
 
-	currently_serving_as = NULL;
-	worker->master(worker, worker->data);
-	return NULL;
+		bottom_job->next = old_head;
 
-	#undef worker
+	} while (
+		!atomic_compare_exchange_weak_explicit(
+			&worker->wishlist,
+			&old_head,
+			top_job,
+			memory_order_release,
+			memory_order_relaxed
+		)
+	);
 
-}
+	published = true;
 
+	/*  Only who finds the wishlist empty has to beep (once per batch)  */
 
-/**
+	if (!old_head && !worker_beep(worker)) {
 
-	@brief      The routine that launches the GNUnet scheduler (often invoked
-	            via `pthread_create()`)
-	@param      v_worker        The worker in need of a running scheduler,
-	                            passed as `void *`               [NON-NULLABLE]
-	@return     Nothing
+		/*  Without a "beep" the list stays unnoticed... Take the jobs back if
+			nobody has stacked anything on top of them in the meanwhile (the
+			beep channel is down, so the worker cannot have detached them)  */
 
-**/
-static void * scheduler_launcher (
-	void * v_worker
-) {
+		GNUNET_WORKER_JobList * expected = top_job;
 
-	#define worker ((GNUNET_WORKER_Handle) v_worker)
+		if (
+			atomic_compare_exchange_strong(
+				&worker->wishlist,
+				&expected,
+				NULL
+			)
+		) {
 
-	currently_serving_as = worker;
-	GNUNET_SCHEDULER_run(&worker_main_routine, v_worker);
+			atomic_fetch_sub_explicit(
+				&worker->counters.jobs_pushed_remotely,
+				job_count,
+				memory_order_relaxed
+			);
 
-	if (!currently_serving_as) {
+			trace_job_chain(worker, GNUNET_WORKER_TRACE_CANCEL, top_job);
 
-		/*  The user has launched `GNUNET_WORKER_dismiss()`  */
+			if (!own_job) {
 
-		return NULL;
+				job_chain_free(top_job);
 
-	}
+			}
 
-	if (atomic_load(&worker->state) != WORKER_IS_DEAD) {
+			jobs_release(worker, job_count);
+			published = false;
+			retval = GNUNET_WORKER_ERR_SIGNAL;
+			goto forget_tickets_and_exit;
 
-		/*  If we ended up here `GNUNET_SCHEDULER_add_shutdown()` has a bug  */
+		}
 
-		GNUNET_log(
-			GNUNET_ERROR_TYPE_ERROR,
-			_(
-				"The worker thread's event loop has been unexpectedly cut off "
-				"- the scheduler is down\n"
-			)
-		);
+		/*  Other producers have stacked their jobs on top of ours, but they
+			found the wishlist non-empty and did not beep: nobody else is going
+			to wake the worker up. If a second attempt fails too the jobs stay
+			published (they will run if the worker ever wakes up, or be dropped
+			by its shutdown), but the failure is reported  */
+
+		if (!worker_beep(worker)) {
+
+			retval = GNUNET_WORKER_ERR_SIGNAL;
 
-		exit(EINTR);
+		}
 
 	}
 
-	GNUNET_WORKER_dispose(worker);
-	return NULL;
+	goto leave_and_exit;
 
-	#undef worker
 
-}
+	/* \                                 /\
+	\ */     drop_and_exit:             /* \
+	 \/     _______________________     \ */
 
 
-/**
+	/*  Nothing has been pushed, but the caller expects its node back  */
 
-	@brief      Allocate the memory necessary for a new worker
-    @param      save_handle         A placeholder for storing a handle for the
-                                    new worker created               [NULLABLE]
-    @param      master_routine      A master function to call in a new detached
-                                    thread                           [NULLABLE]
-	@param      on_worker_start     The first routine invoked by the worker,
-	                                with @p worker_data passed as argument; the
-	                                return value of this function determines
-	                                the destiny of the worker        [NULLABLE]
-	@param      on_worker_end       The last routine invoked by the worker,
-	                                with @p worker_data passed as argument
-	                                                                 [NULLABLE]
-    @param      worker_data         Custom user data retrievable at any moment
-	                                                                 [NULLABLE]
-	@param      worker_flags        The worker's flags
-	@return     A newly allocated (but not running) worker
+	if (own_job) {
 
-**/
-int GNUNET_WORKER_allocate (
-	GNUNET_WORKER_Handle * const save_handle,
-	const GNUNET_WORKER_MasterRoutine master_routine,
-	const GNUNET_WORKER_LifeRoutine on_worker_start,
-	const GNUNET_CallbackRoutine on_worker_end,
-	void * const worker_data,
-	const unsigned int worker_flags
-) {
+		job_complete(own_job, false);
 
-	const GNUNET_WORKER_Handle
-		new_worker = malloc(sizeof(GNUNET_WORKER_Instance));
+	}
 
-	if (!new_worker) {
 
-		return GNUNET_WORKER_ERR_NO_MEMORY;
+	/* \                                 /\
+	\ */     forget_tickets_and_exit:   /* \
+	 \/     _______________________     \ */
 
-	}
 
-	if (pipe2(*((int (*)[2]) &new_worker->beep_fd), O_NONBLOCK) < 0) {
+	if (save_tickets) {
 
-		free(new_worker);
-		return GNUNET_WORKER_ERR_SIGNAL;
+		for (size_t idx = 0; idx < job_count; save_tickets[idx++] = NULL);
 
 	}
 
-	requirement_init(&new_worker->scheduler_has_returned, REQ_INIT_RED);
-	requirement_init(&new_worker->worker_is_disposable, REQ_INIT_GREEN);
-	pthread_mutex_init(&new_worker->wishes_mutex, NULL);
-	pthread_mutex_init(&new_worker->kill_mutex, NULL);
-	new_worker->wishlist = NULL;
-	new_worker->schedules = NULL;
-	new_worker->listener_schedule = NULL;
-	new_worker->shutdown_schedule = NULL;
-	*((GNUNET_WORKER_MasterRoutine *) &new_worker->master) = master_routine;
-	*((GNUNET_WORKER_LifeRoutine *) &new_worker->on_start) = on_worker_start;
-	*((GNUNET_CallbackRoutine *) &new_worker->on_terminate) = on_worker_end;
-	*((void **) &new_worker->data) = worker_data;
-	*((struct GNUNET_NETWORK_FDSet **) &new_worker->beep_fds) =
-		GNUNET_NETWORK_fdset_create();
-	new_worker->state = WORKER_IS_ALIVE;
-	new_worker->future_plans = GNUNET_WORKER_LONG_LIFE;
-	*((unsigned int *) &new_worker->flags) = worker_flags;
-
-	/*  Fields left undefined: `::worker_thread`  */
 
-	GNUNET_NETWORK_fdset_set_native(
-		new_worker->beep_fds,
-		new_worker->beep_fd[0]
-	);
-
-	*save_handle = new_worker;
-	return GNUNET_WORKER_SUCCESS;
+	/* \                                 /\
+	\ */     leave_and_exit:            /* \
+	 \/     _______________________     \ */
 
-}
 
+	if (retval && own_job && !published) {
 
+		/*  The node has never left the caller's hands  */
 
-		/*\
-		|*|
-		|*|     GLOBAL ENVIRONMENT
-		|*|    ________________________________
-		\*/
+		atomic_store_explicit(&own_job->refs, 0, memory_order_release);
 
+	}
 
+	worker_leave(worker);
+	return retval;
 
-	/*  Please see the public header for the complete documentation  */
+}
 
 
 /**
 
-	@brief      Terminate a worker and free its memory, without waiting for the
-	            scheduler to return -- this will be completed in parallel
-	            (asynchronous)
+	@brief      Schedule a batch of new functions for the worker, atomically
 
 */
-int GNUNET_WORKER_asynch_destroy (
-	const GNUNET_WORKER_Handle worker
+int GNUNET_WORKER_push_load_batch (
+	const GNUNET_WORKER_Handle worker,
+	const GNUNET_WORKER_Load * const jobs,
+	const size_t job_count
 ) {
 
-	int retval = GNUNET_WORKER_SUCCESS;
+	return load_push(
+		worker,
+		jobs,
+		job_count,
+		false,
+		NULL,
+		NULL,
+		GNUNET_TIME_UNIT_ZERO_ABS,
+		GNUNET_TIME_UNIT_ZERO,
+		NULL
+	);
 
-	requirement_paint_red(&worker->worker_is_disposable);
+}
 
-	switch (atomic_load(&worker->state)) {
 
-		case WORKER_IS_ZOMBIE:
+/**
 
-			if (currently_serving_as == worker) {
+	@brief      Schedule a new function for the worker, with a priority
 
-				/*  The zombie will be unzombified...  */
+*/
+int GNUNET_WORKER_push_load_with_priority (
+	const GNUNET_WORKER_Handle worker,
+	const enum GNUNET_SCHEDULER_Priority job_priority,
+	const GNUNET_CallbackRoutine job_routine,
+	void * const job_data
+) {
 
-				goto asynch_self_destroy;
+	const GNUNET_WORKER_Load job = {
+		.priority = job_priority,
+		.routine = job_routine,
+		.data = job_data
+	};
 
-			}
+	return GNUNET_WORKER_push_load_batch(worker, &job, 1);
 
-			if (write(worker->beep_fd[1], &BEEP_CODE, 1) == 1) {
+}
 
-				/*  The zombie will be unzombified...  */
 
-				goto paint_green_and_exit;
+/**
 
-			}
+	@brief      Schedule a new function for the worker, with a priority,
+	            waiting for the worker to make room for it if necessary
 
-			retval = GNUNET_WORKER_ERR_SIGNAL;
-			goto paint_green_and_exit;
+*/
+int GNUNET_WORKER_wait_push_load (
+	const GNUNET_WORKER_Handle worker,
+	const enum GNUNET_SCHEDULER_Priority job_priority,
+	const GNUNET_CallbackRoutine job_routine,
+	void * const job_data
+) {
 
-		case WORKER_IS_ALIVE:
+	const GNUNET_WORKER_Load job = {
+		.priority = job_priority,
+		.routine = job_routine,
+		.data = job_data
+	};
+
+	return load_push(
+		worker,
+		&job,
+		1,
+		true,
+		NULL,
+		NULL,
+		GNUNET_TIME_UNIT_ZERO_ABS,
+		GNUNET_TIME_UNIT_ZERO,
+		NULL
+	);
 
-			if (pthread_mutex_trylock(&worker->kill_mutex)) {
+}
 
-				if (worker->on_terminate) {
 
-		case WORKER_SAYS_BYE:
+/**
 
-					/*  It was still safe to call this function...  */
+	@brief      Schedule a new function for the worker, with a priority,
+	            waiting until a certain time for the worker to make room for it
+	            if necessary
 
-					goto paint_green_and_exit;
+*/
+int GNUNET_WORKER_timedwait_push_load (
+	const GNUNET_WORKER_Handle worker,
+	const enum GNUNET_SCHEDULER_Priority job_priority,
+	const GNUNET_CallbackRoutine job_routine,
+	void * const job_data,
+	const struct timespec * const absolute_time
+) {
 
-				}
+	const GNUNET_WORKER_Load job = {
+		.priority = job_priority,
+		.routine = job_routine,
+		.data = job_data
+	};
+
+	return load_push(
+		worker,
+		&job,
+		1,
+		true,
+		absolute_time,
+		NULL,
+		GNUNET_TIME_UNIT_ZERO_ABS,
+		GNUNET_TIME_UNIT_ZERO,
+		NULL
+	);
 
-		default:
+}
 
-				GNUNET_WORKER_log(
-					GNUNET_ERROR_TYPE_ERROR,
-					_("Double free detected\n")
-				);
 
-				retval = GNUNET_WORKER_ERR_DOUBLE_FREE;
-				goto paint_green_and_exit;
+/**
 
-			}
+	@brief      Schedule a new function for the worker, with a priority, and
+	            get a ticket for cancelling it
 
-	}
+*/
+int GNUNET_WORKER_push_load_with_ticket (
+	const GNUNET_WORKER_Handle worker,
+	const enum GNUNET_SCHEDULER_Priority job_priority,
+	const GNUNET_CallbackRoutine job_routine,
+	void * const job_data,
+	GNUNET_WORKER_Ticket * const save_ticket
+) {
 
-	atomic_store(
-		&worker->state,
-		worker->on_terminate ?
-			WORKER_SAYS_BYE
-		:
-			WORKER_IS_DYING
+	const GNUNET_WORKER_Load job = {
+		.priority = job_priority,
+		.routine = job_routine,
+		.data = job_data
+	};
+
+	return load_push(
+		worker,
+		&job,
+		1,
+		false,
+		NULL,
+		save_ticket,
+		GNUNET_TIME_UNIT_ZERO_ABS,
+		GNUNET_TIME_UNIT_ZERO,
+		NULL
 	);
 
-	if (currently_serving_as == worker) {
+}
 
-		/*  The user has called this function from the worker thread  */
 
-		if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+/**
 
-			pthread_detach(worker->worker_thread);
+	@brief      Release a ticket without cancelling its job
 
-		}
+*/
+void GNUNET_WORKER_release_ticket (
+	const GNUNET_WORKER_Ticket ticket
+) {
 
+	if (
+		ticket &&
+		atomic_fetch_sub_explicit(&ticket->refs, 1, memory_order_acq_rel) == 1
+	) {
 
-		/* \                                 /\
-		\ */     asynch_self_destroy:       /* \
-		 \/     _______________________     \ */
+		free(ticket);
 
+	}
 
-		clear_schedule(&worker->listener_schedule);
-		job_list_unschedule_and_clear(&worker->schedules);
-		job_list_clear_locked(&worker->wishlist, &worker->wishes_mutex);
-		GNUNET_SCHEDULER_cancel(worker->shutdown_schedule);
+}
 
-		worker->shutdown_schedule = GNUNET_SCHEDULER_add_shutdown(
-			&attended_shutdown_handler,
-			worker
-		);
 
-		pthread_mutex_unlock(&worker->kill_mutex);
-		requirement_paint_green(&worker->worker_is_disposable);
-		GNUNET_SCHEDULER_shutdown();
-		return GNUNET_WORKER_SUCCESS;
+/**
 
-	}
+	@brief      Cancel a job that has not started yet and release its ticket
 
-	/*  The user has **not** called this function from the worker thread  */
+*/
+bool GNUNET_WORKER_cancel_load (
+	const GNUNET_WORKER_Ticket ticket
+) {
 
-	if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+	if (!ticket) {
 
-		pthread_detach(worker->worker_thread);
+		return false;
 
 	}
 
-	pthread_mutex_lock(&worker->wishes_mutex);
-	worker->future_plans = GNUNET_WORKER_DESTRUCTION;
+	int expected = JOB_IS_PENDING;
+
+	const bool cancelled =
+		atomic_compare_exchange_strong(
+			&ticket->status,
+			&expected,
+			JOB_IS_CANCELLED
+		);
 
 	if (
-		!worker->wishlist &&
-		write(worker->beep_fd[1], &BEEP_CODE, 1) != 1
+		!cancelled && expected == JOB_HAS_STARTED &&
+		ticket->period.rel_value_us
 	) {
 
-		/*  Pipe is down...  */
-
-		atomic_store(&worker->state, WORKER_IS_ZOMBIE);
-		retval = GNUNET_WORKER_ERR_SIGNAL;
-
-	} else {
+		/*  A periodic job that is running right now: prevent the next run
+			(see `call_and_unlist_handler()`)  */
 
-		retval = GNUNET_WORKER_SUCCESS;
+		atomic_compare_exchange_strong(
+			&ticket->status,
+			&expected,
+			JOB_IS_CANCELLED
+		);
 
 	}
 
-	pthread_mutex_unlock(&worker->wishes_mutex);
-	pthread_mutex_unlock(&worker->kill_mutex);
-
-
-	/* \                                 /\
-	\ */     paint_green_and_exit:      /* \
-	 \/     _______________________     \ */
-
-
-	requirement_paint_green(&worker->worker_is_disposable);
-	return retval;
-
-}
+	if (cancelled) {
 
+		if (currently_serving_as == ticket->assigned_to) {
 
-/**
+			/*  We are in the worker thread: if the job is a GNUnet task of its
+				own remove it from the scheduler right away  */
 
-	@brief      Uninstall and destroy a worker without shutting down its
-	            scheduler
+			job_unschedule_cancelled(ticket->assigned_to, ticket);
 
-*/
-int GNUNET_WORKER_dismiss (
-	const GNUNET_WORKER_Handle worker
-) {
+		} else if (cancellation_post(ticket)) {
 
-	int retval = GNUNET_WORKER_SUCCESS;
+			/*  The worker thread will do the same and release the ticket (a
+				timed job must not hold its timer and its room in the
+				capacity until it is due)  */
 
-	requirement_paint_red(&worker->worker_is_disposable);
+			return true;
 
-	switch (atomic_load(&worker->state)) {
+		}
 
-		case WORKER_IS_ZOMBIE:
+	}
 
-			if (currently_serving_as == worker) {
+	GNUNET_WORKER_release_ticket(ticket);
+	return cancelled;
 
-				/*  The zombie will be unzombified...  */
+}
 
-				goto self_dismiss;
 
-			}
+/**
 
-			if (write(worker->beep_fd[1], &BEEP_CODE, 1) == 1) {
+	@brief      Schedule a new function for the worker, using a job node owned
+	            by the caller
 
-				/*  The zombie will be unzombified...  */
+*/
+int GNUNET_WORKER_push_job (
+	const GNUNET_WORKER_Handle worker,
+	GNUNET_WORKER_Job * const job,
+	const enum GNUNET_SCHEDULER_Priority job_priority,
+	const GNUNET_CallbackRoutine job_routine,
+	void * const job_data,
+	const GNUNET_WORKER_JobCompletion on_job_complete
+) {
 
-				goto paint_green_and_exit;
+	GNUNET_WORKER_JobList * const own_job = (GNUNET_WORKER_JobList *) job;
+	unsigned int expected = 0;
 
-			}
+	/*  The only reference is the worker's: whoever takes it owns the node  */
 
-			retval = GNUNET_WORKER_ERR_SIGNAL;
-			goto paint_green_and_exit;
+	if (
+		!atomic_compare_exchange_strong_explicit(
+			&own_job->refs,
+			&expected,
+			1,
+			memory_order_acquire,
+			memory_order_relaxed
+		)
+	) {
 
-		case WORKER_IS_ALIVE:
+		return GNUNET_WORKER_ERR_JOB_QUEUED;
 
-			if (pthread_mutex_trylock(&worker->kill_mutex)) {
+	}
 
-				if (worker->on_terminate) {
+	own_job->on_complete = on_job_complete;
 
-		case WORKER_SAYS_BYE:
+	const GNUNET_WORKER_Load load = {
+		.priority = job_priority,
+		.routine = job_routine,
+		.data = job_data
+	};
 
-					/*  It was still safe to call this function...  */
+	return load_push(
+		worker,
+		&load,
+		1,
+		false,
+		NULL,
+		NULL,
+		GNUNET_TIME_UNIT_ZERO_ABS,
+		GNUNET_TIME_UNIT_ZERO,
+		own_job
+	);
 
-					goto paint_green_and_exit;
+}
 
-				}
 
-		default:
+/**
 
-				GNUNET_WORKER_log(
-					GNUNET_ERROR_TYPE_ERROR,
-					_("Double free detected\n")
-				);
+	@brief      Schedule a new function for the worker, to be run at a certain
+	            time
 
-				retval = GNUNET_WORKER_ERR_DOUBLE_FREE;
-				goto paint_green_and_exit;
+*/
+int GNUNET_WORKER_push_load_at (
+	const GNUNET_WORKER_Handle worker,
+	const enum GNUNET_SCHEDULER_Priority job_priority,
+	const struct GNUNET_TIME_Absolute due_time,
+	const GNUNET_CallbackRoutine job_routine,
+	void * const job_data,
+	GNUNET_WORKER_Ticket * const save_ticket
+) {
 
-			}
+	const GNUNET_WORKER_Load job = {
+		.priority = job_priority,
+		.routine = job_routine,
+		.data = job_data
+	};
 
-	}
+	/*  A zero due time would mean "as soon as possible" to the worker, which
+		is what the scheduler does with every past time anyway  */
 
-	atomic_store(
-		&worker->state,
-		worker->on_terminate ?
-			WORKER_SAYS_BYE
-		:
-			WORKER_IS_DYING
+	return load_push(
+		worker,
+		&job,
+		1,
+		false,
+		NULL,
+		save_ticket,
+		due_time,
+		GNUNET_TIME_UNIT_ZERO,
+		NULL
 	);
 
-	if (currently_serving_as == worker) {
+}
 
-		/*  The user has called this function from the worker thread  */
 
-		if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+/**
 
-			pthread_detach(worker->worker_thread);
+	@brief      Schedule a new function for the worker, to be run after a delay
 
-		}
+*/
+int GNUNET_WORKER_push_load_delayed (
+	const GNUNET_WORKER_Handle worker,
+	const enum GNUNET_SCHEDULER_Priority job_priority,
+	const struct GNUNET_TIME_Relative delay,
+	const GNUNET_CallbackRoutine job_routine,
+	void * const job_data,
+	GNUNET_WORKER_Ticket * const save_ticket
+) {
 
+	return GNUNET_WORKER_push_load_at(
+		worker,
+		job_priority,
+		GNUNET_TIME_relative_to_absolute(delay),
+		job_routine,
+		job_data,
+		save_ticket
+	);
 
-		/* \                                 /\
-		\ */     self_dismiss:              /* \
-		 \/     _______________________     \ */
+}
 
 
-		clear_schedule(&worker->shutdown_schedule);
-		clear_schedule(&worker->listener_schedule);
-		job_list_clear_locked(&worker->wishlist, &worker->wishes_mutex);
-		job_list_unschedule_and_clear(&worker->schedules);
-		GNUNET_WORKER_terminate(worker);
-		requirement_paint_green(&worker->worker_is_disposable);
-		/*  `GNUNET_WORKER_dispose()` will unlock `worker->kill_mutex`...  */
-		GNUNET_WORKER_dispose(worker);
-		return GNUNET_WORKER_SUCCESS;
+/**
 
-	}
+	@brief      Schedule a function for the worker, to be run periodically
 
-	/*  The user has **not** called this function from the worker thread  */
+*/
+int GNUNET_WORKER_push_load_periodic (
+	const GNUNET_WORKER_Handle worker,
+	const enum GNUNET_SCHEDULER_Priority job_priority,
+	const struct GNUNET_TIME_Relative period,
+	const GNUNET_CallbackRoutine job_routine,
+	void * const job_data,
+	GNUNET_WORKER_Ticket * const save_ticket
+) {
 
-	if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+	if (!period.rel_value_us) {
 
-		pthread_detach(worker->worker_thread);
+		*save_ticket = NULL;
+		return GNUNET_WORKER_ERR_INVALID_TIME;
 
 	}
 
-	pthread_mutex_lock(&worker->wishes_mutex);
-	worker->future_plans = GNUNET_WORKER_DISMISSAL;
+	const GNUNET_WORKER_Load job = {
+		.priority = job_priority,
+		.routine = job_routine,
+		.data = job_data
+	};
+
+	return load_push(
+		worker,
+		&job,
+		1,
+		false,
+		NULL,
+		save_ticket,
+		GNUNET_TIME_relative_to_absolute(period),
+		period,
+		NULL
+	);
 
-	if (!worker->wishlist && write(worker->beep_fd[1], &BEEP_CODE, 1) != 1) {
+}
 
-		/*  Pipe is down...  */
 
-		atomic_store(&worker->state, WORKER_IS_ZOMBIE);
-		retval = GNUNET_WORKER_ERR_SIGNAL;
+/**
 
-	} else {
+	@brief      Run a function in the worker thread and wait for its result,
+	            but only if the function starts within a certain time (or
+	            without time limits if @p absolute_time is `NULL`)
+	@param      worker          The worker that must run the function
+	                                                             [NON-NULLABLE]
+	@param      call_routine    The function to run              [NON-NULLABLE]
+	@param      call_data       Custom data to pass to the function  [NULLABLE]
+	@param      save_result     A placeholder for storing the value returned by
+	                            @p call_routine                      [NULLABLE]
+	@param      absolute_time   The absolute time to wait until, or `NULL` for
+	                            waiting indefinitely                 [NULLABLE]
+	@return     See `GNUNET_WORKER_timedcall()`
 
-		retval = GNUNET_WORKER_SUCCESS;
+**/
+static int call_push_and_wait (
+	const GNUNET_WORKER_Handle worker,
+	const GNUNET_WORKER_CallRoutine call_routine,
+	void * const call_data,
+	void ** const save_result,
+	const struct timespec * const absolute_time
+) {
 
-	}
+	if (currently_serving_as == worker) {
 
-	pthread_mutex_unlock(&worker->wishes_mutex);
-	pthread_mutex_unlock(&worker->kill_mutex);
+		/*  The user has called this function from the worker thread  */
 
+		void * const result = call_routine(call_data);
 
-	/* \                                 /\
-	\ */     paint_green_and_exit:      /* \
-	 \/     _______________________     \ */
+		if (save_result) {
 
+			*save_result = result;
 
-	requirement_paint_green(&worker->worker_is_disposable);
-	return retval;
+		}
 
-}
+		return GNUNET_WORKER_SUCCESS;
 
+	}
 
-/**
+	/*  The user has **not** called this function from the worker thread  */
 
-	@brief      Terminate a worker and free its memory, waiting for the
-	            scheduler to complete the shutdown (synchronous)
+	GNUNET_WORKER_Call call = {
+		.routine = call_routine,
+		.data = call_data,
+		.result = NULL
+	};
+
+	atomic_init(&call.state, CALL_IS_PENDING);
+
+	const GNUNET_WORKER_Load job = {
+		.priority = GNUNET_SCHEDULER_PRIORITY_DEFAULT,
+		.routine = &call_trampoline,
+		.data = &call
+	};
+
+	GNUNET_WORKER_Ticket ticket;
+	int retval = load_push(
+		worker,
+		&job,
+		1,
+		false,
+		NULL,
+		&ticket,
+		GNUNET_TIME_UNIT_ZERO_ABS,
+		GNUNET_TIME_UNIT_ZERO,
+		NULL
+	);
 
-*/
-int GNUNET_WORKER_synch_destroy (
-	const GNUNET_WORKER_Handle worker
-) {
+	if (retval) {
 
-	requirement_paint_red(&worker->worker_is_disposable);
+		return retval;
 
-	switch (atomic_load(&worker->state)) {
+	}
 
-		case WORKER_IS_ZOMBIE:
+	if (!ticket) {
 
-			if (currently_serving_as == worker) {
+		/*  The worker is shutting down and has dropped the job already  */
 
-				/*  The zombie will be unzombified...  */
+		return GNUNET_WORKER_ERR_CANCELLED;
 
-				goto synch_self_destroy;
+	}
 
-			}
+	switch (call_wait(&call, absolute_time)) {
 
-			if (write(worker->beep_fd[1], &BEEP_CODE, 1) == 1) {
+		case 0:
 
-				/*  The zombie will be unzombified...  */
+			GNUNET_WORKER_release_ticket(ticket);
+			break;
 
-				requirement_paint_green(&worker->worker_is_disposable);
-				return GNUNET_WORKER_SUCCESS;
+		case ETIMEDOUT:
+
+			if (GNUNET_WORKER_cancel_load(ticket)) {
+
+				/*  The job will never touch `call`  */
+
+				return GNUNET_WORKER_ERR_EXPIRED;
 
 			}
 
-			requirement_paint_green(&worker->worker_is_disposable);
-			return GNUNET_WORKER_ERR_SIGNAL;
+			/*  Too late: the routine has started (or the shutdown has dropped
+				the job), and `call` must live until the worker is done with
+				it  */
 
-		case WORKER_IS_ALIVE:
+			call_wait(&call, NULL);
+			break;
 
-			if (pthread_mutex_trylock(&worker->kill_mutex)) {
+		default:
 
-				if (worker->on_terminate) {
+			if (GNUNET_WORKER_cancel_load(ticket)) {
 
-		case WORKER_SAYS_BYE:
+				return GNUNET_WORKER_ERR_INVALID_TIME;
 
-					/*  It was still safe to call this function...  */
+			}
 
-					requirement_paint_green(&worker->worker_is_disposable);
-					return GNUNET_WORKER_ERR_NOT_ALONE;
+			call_wait(&call, NULL);
 
-				}
+	}
 
-		default:
+	if (atomic_load(&call.state) != CALL_IS_DONE) {
 
-				GNUNET_WORKER_log(
-					GNUNET_ERROR_TYPE_ERROR,
-					_("Double free detected\n")
-				);
+		return GNUNET_WORKER_ERR_CANCELLED;
 
-				requirement_paint_green(&worker->worker_is_disposable);
-				return GNUNET_WORKER_ERR_DOUBLE_FREE;
+	}
 
-			}
+	if (save_result) {
+
+		*save_result = call.result;
 
 	}
 
-	atomic_store(
-		&worker->state,
-		worker->on_terminate ?
-			WORKER_SAYS_BYE
-		:
-			WORKER_IS_DYING
-	);
+	return GNUNET_WORKER_SUCCESS;
 
-	if (currently_serving_as == worker) {
+}
 
-		/*  The user has called this function from the worker thread  */
 
-		if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+/**
 
-			pthread_detach(worker->worker_thread);
+	@brief      Run a function in the worker thread and wait for its result
 
-		}
+*/
+int GNUNET_WORKER_call (
+	const GNUNET_WORKER_Handle worker,
+	const GNUNET_WORKER_CallRoutine call_routine,
+	void * const call_data,
+	void ** const save_result
+) {
 
+	return call_push_and_wait(
+		worker,
+		call_routine,
+		call_data,
+		save_result,
+		NULL
+	);
 
-		/* \                                 /\
-		\ */     synch_self_destroy:        /* \
-		 \/     _______________________     \ */
+}
 
 
-		clear_schedule(&worker->shutdown_schedule);
-		clear_schedule(&worker->listener_schedule);
-		job_list_clear_locked(&worker->wishlist, &worker->wishes_mutex);
-		job_list_unschedule_and_clear(&worker->schedules);
-		GNUNET_WORKER_terminate(worker);
-		requirement_paint_green(&worker->worker_is_disposable);
-		GNUNET_WORKER_dispose_if_guest(worker);
-		GNUNET_SCHEDULER_shutdown();
-		return GNUNET_WORKER_SUCCESS;
+/**
 
-		/*  `worker->kill_mutex` will be unlocked by `GNUNET_WORKER_dispose()`
-			either now or later...  */
+	@brief      Run a function in the worker thread and wait for its result,
+	            but only if the function starts within a certain time
 
-	}
+*/
+int GNUNET_WORKER_timedcall (
+	const GNUNET_WORKER_Handle worker,
+	const GNUNET_WORKER_CallRoutine call_routine,
+	void * const call_data,
+	void ** const save_result,
+	const struct timespec * const absolute_time
+) {
 
-	/*  The user has **not** called this function from the worker thread  */
+	return call_push_and_wait(
+		worker,
+		call_routine,
+		call_data,
+		save_result,
+		absolute_time
+	);
 
-	pthread_mutex_lock(&worker->wishes_mutex);
-	worker->future_plans = GNUNET_WORKER_DESTRUCTION;
+}
 
-	int tempval =
-		!worker->wishlist &&
-		write(worker->beep_fd[1], &BEEP_CODE, 1) != 1;
 
-	pthread_mutex_unlock(&worker->wishes_mutex);
+/**
 
-	if (tempval) {
+	@brief      Start the GNUnet scheduler in a separate thread
 
-		/*  Pipe is down...  */
+*/
+int GNUNET_WORKER_create (
+	GNUNET_WORKER_Handle * const save_handle,
+	const GNUNET_WORKER_LifeRoutine on_worker_start,
+	const GNUNET_CallbackRoutine on_worker_end,
+	void * const worker_data
+) {
 
-		if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+	GNUNET_WORKER_Handle worker;
 
-			pthread_detach(worker->worker_thread);
+	const int tempval = GNUNET_WORKER_allocate(
+		&worker,
+		NULL,
+		on_worker_start,
+		on_worker_end,
+		worker_data,
+		WORKER_FLAG_OWN_THREAD
+	);
 
-		}
+	if (tempval) {
 
-		atomic_store(&worker->state, WORKER_IS_ZOMBIE);
-		pthread_mutex_unlock(&worker->kill_mutex);
-		requirement_paint_green(&worker->worker_is_disposable);
-		return GNUNET_WORKER_ERR_SIGNAL;
+		return tempval;
 
 	}
 
-	pthread_mutex_unlock(&worker->kill_mutex);
+	if (
+		pthread_create(
+			(pthread_t *) &worker->worker_thread,
+			NULL,
+			&scheduler_launcher,
+			worker
+		)
+	) {
 
-	if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+		worker_set_state(worker, WORKER_IS_DEAD);
+		GNUNET_WORKER_slot_revoke(worker->id);
+		GNUNET_WORKER_unallocate(worker);
+		return GNUNET_WORKER_ERR_THREAD_CREATE;
 
-		/*  We started the scheduler's thread: it must be joined  */
+	}
 
-		pthread_t thread_ref_copy = worker->worker_thread;
-		requirement_paint_green(&worker->worker_is_disposable);
-		tempval = pthread_join(thread_ref_copy, NULL);
+	if (save_handle) {
 
-		if (tempval) {
+		*save_handle = worker;
 
-			pthread_detach(thread_ref_copy);
+	}
 
-		}
+	return GNUNET_WORKER_SUCCESS;
 
-		switch (tempval) {
+}
 
-			case __EOK__: return GNUNET_WORKER_SUCCESS;
 
-			case EDEADLK: case EINVAL: case EPERM: case ESRCH:
+/**
 
-				GNUNET_log(
-					GNUNET_ERROR_TYPE_WARNING,
-					_(
-						"`%s` has returned `%d`, possibly due to a bug in the "
-						"GNUnet Worker module\n"
-					),
-					"pthread_join()",
-					tempval
-				);
+	@brief      Launch the GNUnet scheduler in the current thread and turn it
+	            into a worker
 
-				return GNUNET_WORKER_ERR_INTERNAL_BUG;
+*/
+int GNUNET_WORKER_start_serving (
+	GNUNET_WORKER_Handle * const save_handle,
+	const GNUNET_WORKER_MasterRoutine master_routine,
+	const GNUNET_WORKER_LifeRoutine on_worker_start,
+	const GNUNET_CallbackRoutine on_worker_end,
+	void * const worker_data
+) {
 
-		}
+	if (currently_serving_as) {
 
-		/*  This should not happen with a decent C library...  */
+		return GNUNET_WORKER_ERR_ALREADY_SERVING;
 
-		GNUNET_log(
-			GNUNET_ERROR_TYPE_WARNING,
-			_(
-				"`%s` has returned `%d` (unknown code) while waiting for the "
-				"worker thread to terminate\n"
-			),
-			"pthread_join()",
-			tempval
-		);
+	}
 
-		return GNUNET_WORKER_ERR_UNKNOWN;
+	GNUNET_WORKER_Handle worker;
 
-	}
+	const int tempval = GNUNET_WORKER_allocate(
+		&worker,
+		master_routine,
+		on_worker_start,
+		on_worker_end,
+		worker_data,
+		WORKER_FLAG_NONE
+	);
 
-	/*  We did not start the scheduler's thread: it must live  */
+	if (tempval) {
 
-	tempval = requirement_wait_for_green(&worker->scheduler_has_returned);
-	requirement_paint_green(&worker->worker_is_disposable);
+		return tempval;
 
-	switch (tempval) {
+	}
 
-		case __EOK__: return GNUNET_WORKER_SUCCESS;
+	/*  This is not strictly necessary at the moment (`::worker_thread` can be
+		left undefined if we are not the ones who created the worker thread).
+		However we might want to add thread-related utilities to the GNUnet
+		Worker API in the future...  */
 
-		case EINVAL: case EPERM:
+	*((pthread_t *) &worker->worker_thread) = pthread_self();
 
-			GNUNET_log(
-				GNUNET_ERROR_TYPE_WARNING,
-				_(
-					"`%s` has returned `%d`, possibly due to a bug in the "
-					"GNUnet Worker module\n"
-				),
-				"pthread_cond_wait()",
-				tempval
-			);
+	if (master_routine && thread_create_detached(&master_launcher, worker)) {
 
-			return GNUNET_WORKER_ERR_INTERNAL_BUG;
+		worker_set_state(worker, WORKER_IS_DEAD);
+		GNUNET_WORKER_slot_revoke(worker->id);
+		GNUNET_WORKER_unallocate(worker);
+		return GNUNET_WORKER_ERR_THREAD_CREATE;
 
 	}
 
-	/*  This should not happen with a decent C library...  */
+	if (save_handle) {
 
-	GNUNET_log(
-		GNUNET_ERROR_TYPE_WARNING,
-		_(
-			"`%s` has returned `%d` (unknown code) while waiting for the "
-			"worker thread to terminate\n"
-		),
-		"pthread_cond_wait()",
-		tempval
-	);
+		*save_handle = worker;
 
-	return GNUNET_WORKER_ERR_UNKNOWN;
+	}
+
+	scheduler_launcher(worker);
+	return GNUNET_WORKER_SUCCESS;
 
 }
 
 
 /**
 
-	@brief      Terminate a worker and free its memory, waiting for the
-	            scheduler to complete the shutdown (synchronous), but only if
-	            this happens within a certain time, otherwise it will be
-	            completed in parallel (asynchronous)
+	@brief      Install a load listener into an already running scheduler and
+	            turn the latter into a worker
 
 */
-int GNUNET_WORKER_timedsynch_destroy (
-	const GNUNET_WORKER_Handle worker,
-	const struct timespec * const absolute_time
+int GNUNET_WORKER_adopt_running_scheduler (
+	GNUNET_WORKER_Handle * const save_handle,
+	const GNUNET_WORKER_MasterRoutine master_routine,
+	const GNUNET_CallbackRoutine on_worker_end,
+	void * const worker_data
 ) {
 
-	requirement_paint_red(&worker->worker_is_disposable);
-
-	switch (atomic_load(&worker->state)) {
+	if (currently_serving_as) {
 
-		case WORKER_IS_ZOMBIE:
+		return GNUNET_WORKER_ERR_ALREADY_SERVING;
 
-			if (currently_serving_as == worker) {
+	}
 
-				/*  The zombie will be unzombified...  */
+	const int tempval = GNUNET_WORKER_allocate(
+		&currently_serving_as,
+		master_routine,
+		NULL,
+		on_worker_end,
+		worker_data,
+		WORKER_FLAG_IS_GUEST
+	);
 
-				goto synch_self_destroy;
+	if (tempval) {
 
-			}
+		return tempval;
 
-			if (write(worker->beep_fd[1], &BEEP_CODE, 1) == 1) {
+	}
 
-				/*  The zombie will be unzombified...  */
+	/*  This is not strictly necessary at the moment (`::worker_thread` can be
+		left undefined if we are not the ones who created the worker thread).
+		However we might want to add thread-related utilities to the GNUnet
+		Worker API in the future...  */
 
-				requirement_paint_green(&worker->worker_is_disposable);
-				return GNUNET_WORKER_SUCCESS;
+	*((pthread_t *) &currently_serving_as->worker_thread) = pthread_self();
 
-			}
+	if (
+		master_routine &&
+		thread_create_detached(&master_launcher, currently_serving_as)
+	) {
 
-			requirement_paint_green(&worker->worker_is_disposable);
-			return GNUNET_WORKER_ERR_SIGNAL;
+		worker_set_state(currently_serving_as, WORKER_IS_DEAD);
+		GNUNET_WORKER_slot_revoke(currently_serving_as->id);
+		GNUNET_WORKER_unallocate(currently_serving_as);
+		return GNUNET_WORKER_ERR_THREAD_CREATE;
 
-		case WORKER_IS_ALIVE:
+	}
 
-			if (pthread_mutex_trylock(&worker->kill_mutex)) {
+	currently_serving_as->shutdown_schedule = GNUNET_SCHEDULER_add_shutdown(
+		&unattended_shutdown_handler,
+		currently_serving_as
+	);
 
-				if (worker->on_terminate) {
+	currently_serving_as->listener_schedule = GNUNET_SCHEDULER_add_select(
+		WORKER_LISTENER_PRIORITY,
+		GNUNET_TIME_UNIT_FOREVER_REL,
+		currently_serving_as->beep_fds,
+		NULL,
+		&load_request_handler,
+		currently_serving_as
+	);
 
-		case WORKER_SAYS_BYE:
+	if (save_handle) {
 
-					/*  It was still safe to call this function...  */
+		*save_handle = currently_serving_as;
 
-					requirement_paint_green(&worker->worker_is_disposable);
-					return GNUNET_WORKER_ERR_NOT_ALONE;
+	}
 
-				}
+	return GNUNET_WORKER_SUCCESS;
 
-		default:
+}
 
-				GNUNET_WORKER_log(
-					GNUNET_ERROR_TYPE_ERROR,
-					_("Double free detected\n")
-				);
 
-				requirement_paint_green(&worker->worker_is_disposable);
-				return GNUNET_WORKER_ERR_DOUBLE_FREE;
+/**
 
-			}
+	@brief      Set the maximum number of spare job nodes a worker keeps for
+	            reuse
 
-	}
+**/
+void GNUNET_WORKER_set_job_pool_size (
+	const GNUNET_WORKER_Handle worker,
+	const size_t max_spare_jobs
+) {
 
-	atomic_store(
-		&worker->state,
-		worker->on_terminate ?
-			WORKER_SAYS_BYE
-		:
-			WORKER_IS_DYING
+	atomic_store_explicit(
+		&worker->job_pool_size,
+		max_spare_jobs,
+		memory_order_relaxed
 	);
 
-	if (currently_serving_as == worker) {
+}
 
-		/*  The user has called this function from the worker thread  */
 
-		if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+/**
 
-			pthread_detach(worker->worker_thread);
+	@brief      Get the handle of the current worker if this is a worker thread
 
-		}
+**/
+GNUNET_WORKER_Handle GNUNET_WORKER_get_current_handle (void) {
 
+	return currently_serving_as;
 
-		/* \                                 /\
-		\ */     synch_self_destroy:        /* \
-		 \/     _______________________     \ */
+}
 
 
-		clear_schedule(&worker->shutdown_schedule);
-		clear_schedule(&worker->listener_schedule);
-		job_list_clear_locked(&worker->wishlist, &worker->wishes_mutex);
-		job_list_unschedule_and_clear(&worker->schedules);
-		GNUNET_WORKER_terminate(worker);
-		requirement_paint_green(&worker->worker_is_disposable);
-		GNUNET_WORKER_dispose_if_guest(worker);
-		GNUNET_SCHEDULER_shutdown();
-		return GNUNET_WORKER_SUCCESS;
+/**
 
-		/*  `worker->kill_mutex` will be unlocked by `GNUNET_WORKER_dispose()`
-			either now or later...  */
+	@brief      Set the maximum number of jobs that can be pending in a worker
+
+**/
+void GNUNET_WORKER_set_capacity (
+	const GNUNET_WORKER_Handle worker,
+	const size_t max_pending_jobs
+) {
+
+	atomic_store(&worker->capacity, max_pending_jobs);
+
+	/*  The room might have grown (see `jobs_release()`)  */
+
+	if (atomic_load(&worker->blocked_producers)) {
+
+		producers_wake(worker);
 
 	}
 
-	/*  The user has **not** called this function from the worker thread  */
+}
 
-	pthread_mutex_lock(&worker->wishes_mutex);
-	worker->future_plans = GNUNET_WORKER_DESTRUCTION;
 
-	int tempval =
-		!worker->wishlist &&
-		write(worker->beep_fd[1], &BEEP_CODE, 1) != 1;
+/**
 
-	pthread_mutex_unlock(&worker->wishes_mutex);
+	@brief      Set how many jobs a dispatcher may run before yielding back to
+	            the scheduler, or switch the dispatch mode off
 
-	if (tempval) {
+**/
+void GNUNET_WORKER_set_dispatch_budget (
+	const GNUNET_WORKER_Handle worker,
+	const unsigned int jobs_per_slice
+) {
 
-		/*  Pipe is down...  */
+	atomic_store_explicit(
+		&worker->dispatch_budget,
+		jobs_per_slice,
+		memory_order_relaxed
+	);
 
-		if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+}
 
-			pthread_detach(worker->worker_thread);
 
-		}
+/**
 
-		atomic_store(&worker->state, WORKER_IS_ZOMBIE);
-		pthread_mutex_unlock(&worker->kill_mutex);
-		requirement_paint_green(&worker->worker_is_disposable);
-		return GNUNET_WORKER_ERR_SIGNAL;
+	@brief      Get the number of jobs of a given priority that the worker
+	            thread has received but not started yet
 
-	}
+**/
+size_t GNUNET_WORKER_get_queue_depth (
+	const GNUNET_WORKER_Handle worker,
+	const enum GNUNET_SCHEDULER_Priority priority
+) {
 
-	pthread_mutex_unlock(&worker->kill_mutex);
+	if (!priority_is_valid(priority)) {
 
-	if (worker->flags & WORKER_FLAG_OWN_THREAD) {
+		return 0;
 
-		/*  We started the scheduler's thread: it must be joined  */
+	}
 
-		pthread_t thread_ref_copy = worker->worker_thread;
-		requirement_paint_green(&worker->worker_is_disposable);
-		tempval = pthread_timedjoin_np(thread_ref_copy, NULL, absolute_time);
+	return atomic_load_explicit(
+		&worker->buckets[priority].depth,
+		memory_order_relaxed
+	);
 
-		if (tempval) {
+}
 
-			pthread_detach(thread_ref_copy);
 
-		}
+/**
 
-		switch (tempval) {
+	@brief      Get a snapshot of the statistics of a worker
 
-			case __EOK__: return GNUNET_WORKER_SUCCESS;
+*/
+void GNUNET_WORKER_get_stats (
+	const GNUNET_WORKER_Handle worker,
+	GNUNET_WORKER_Stats * const save_stats
+) {
 
-			case EDEADLK: case EPERM: case ESRCH:
+	#define counter_of(FIELD) \
+		atomic_load_explicit(&worker->counters.FIELD, memory_order_relaxed)
 
-				GNUNET_log(
-					GNUNET_ERROR_TYPE_WARNING,
-					_(
-						"`%s` has returned `%d`, possibly due to a bug in the "
-						"GNUnet Worker module\n"
-					),
-					"pthread_timedjoin_np()",
-					tempval
-				);
+	const uint64_t drained = counter_of(jobs_drained);
 
-				return GNUNET_WORKER_ERR_INTERNAL_BUG;
+	save_stats->jobs_pushed_locally = counter_of(jobs_pushed_locally);
+	save_stats->jobs_pushed_remotely = counter_of(jobs_pushed_remotely);
+	save_stats->jobs_executed = counter_of(jobs_executed);
+	save_stats->jobs_dropped = counter_of(jobs_dropped);
+	save_stats->beeps_sent = counter_of(beeps_sent);
+	save_stats->beeps_received = counter_of(beeps_received);
+	save_stats->beeps_failed = counter_of(beeps_failed);
+	save_stats->wakeups = counter_of(wakeups);
+	save_stats->wishlist_peak = counter_of(wishlist_peak);
+	save_stats->scheduled_peak = counter_of(scheduled_peak);
 
-			case ETIMEDOUT: return GNUNET_WORKER_ERR_EXPIRED;
+	#undef counter_of
 
-			case EINVAL: return GNUNET_WORKER_ERR_INVALID_TIME;
+	/*  The two counters are read at different moments  */
 
-		}
+	save_stats->wishlist_length =
+		save_stats->jobs_pushed_remotely > drained ?
+			save_stats->jobs_pushed_remotely - drained
+		:
+			0;
 
-		/*  This should not happen with a decent C library...  */
+	save_stats->scheduled_length = 0;
 
-		GNUNET_log(
-			GNUNET_ERROR_TYPE_WARNING,
-			_(
-				"`%s` has returned `%d` (unknown code) while waiting for the "
-				"worker thread to terminate\n"
-			),
-			"pthread_timedjoin_np()",
-			tempval
-		);
+	for (int idx = 0; idx < GNUNET_SCHEDULER_PRIORITY_COUNT; idx++) {
 
-		return GNUNET_WORKER_ERR_UNKNOWN;
+		save_stats->scheduled_length += atomic_load_explicit(
+			&worker->buckets[idx].depth,
+			memory_order_relaxed
+		);
 
 	}
 
-	/*  We did not start the scheduler's thread: it must live  */
-
-	tempval = requirement_timedwait_for_green(
-		&worker->scheduler_has_returned,
-		absolute_time
-	);
+}
 
-	requirement_paint_green(&worker->worker_is_disposable);
 
-	switch (tempval) {
+/**
 
-		case __EOK__: return GNUNET_WORKER_SUCCESS;
+	@brief      Switch the tracking of the latencies of the jobs on or off
 
-		case ETIMEDOUT: return GNUNET_WORKER_ERR_EXPIRED;
+*/
+int GNUNET_WORKER_set_latency_tracking (
+	const GNUNET_WORKER_Handle worker,
+	const bool enabled
+) {
 
-		case EINVAL: return GNUNET_WORKER_ERR_INVALID_TIME;
+	if (enabled && !atomic_load(&worker->latencies)) {
 
-		case EPERM:
+		/*  All-zero bits are a valid initial state for lock-free atomics  */
 
-			GNUNET_log(
-				GNUNET_ERROR_TYPE_WARNING,
-				_(
-					"`%s` has returned `%d`, possibly due to a bug in the "
-					"GNUnet Worker module\n"
-				),
-				"pthread_cond_timedwait()",
-				tempval
+		GNUNET_WORKER_LatencyHistogram * expected = NULL, * const histograms =
+			calloc(
+				GNUNET_SCHEDULER_PRIORITY_COUNT *
+					GNUNET_WORKER_LATENCY_KIND_COUNT,
+				sizeof(GNUNET_WORKER_LatencyHistogram)
 			);
 
-			return GNUNET_WORKER_ERR_INTERNAL_BUG;
+		if (!histograms) {
 
-	}
+			return GNUNET_WORKER_ERR_NO_MEMORY;
 
-	/*  This should not happen with a decent C library...  */
+		}
+
+		/*  Another thread might have been faster  */
+
+		if (
+			!atomic_compare_exchange_strong(
+				&worker->latencies,
+				&expected,
+				histograms
+			)
+		) {
+
+			free(histograms);
+
+		}
 
-	GNUNET_log(
-		GNUNET_ERROR_TYPE_WARNING,
-		_(
-			"`%s` has returned `%d` (unknown code) while waiting for the "
-			"worker thread to terminate\n"
-		),
-		"pthread_cond_timedwait()",
-		tempval
-	);
+	}
 
-	return GNUNET_WORKER_ERR_UNKNOWN;
+	atomic_store(&worker->track_latency, enabled);
+	return GNUNET_WORKER_SUCCESS;
 
 }
 
 
 /**
 
-	@brief      Schedule a new function for the worker, with a priority
+	@brief      Get a snapshot of the histogram of a latency
 
 */
-int GNUNET_WORKER_push_load_with_priority (
+bool GNUNET_WORKER_get_latency_histogram (
 	const GNUNET_WORKER_Handle worker,
-	const enum GNUNET_SCHEDULER_Priority job_priority,
-	const GNUNET_CallbackRoutine job_routine,
-	void * const job_data
+	const enum GNUNET_SCHEDULER_Priority priority,
+	const GNUNET_WORKER_LatencyKind kind,
+	GNUNET_WORKER_Histogram * const save_histogram
 ) {
 
-	requirement_paint_red(&worker->worker_is_disposable);
-
-	int retval = GNUNET_WORKER_SUCCESS;
-
-	switch (atomic_load(&worker->state)) {
-
-		case WORKER_IS_ALIVE:
-
-			break;
+	if (
+		!priority_is_valid(priority) ||
+		(unsigned int) kind >= GNUNET_WORKER_LATENCY_KIND_COUNT
+	) {
 
-		case WORKER_IS_ZOMBIE:
+		return false;
 
-			if (currently_serving_as == worker) {
+	}
 
-				/*  The zombie will be unzombified...  */
+	const GNUNET_WORKER_LatencyHistogram * const histograms =
+		atomic_load_explicit(&worker->latencies, memory_order_acquire);
 
-				/*
+	if (!histograms) {
 
-				We return `GNUNET_WORKER_SUCCESS` here. It will appear as if
-				the job was scheduled and then immediately cancelled by the
-				shutdown, although none of it really took place...
+		return false;
 
-				*/
+	}
 
-				clear_schedule(&worker->listener_schedule);
-				requirement_paint_green(&worker->worker_is_disposable);
-				load_request_handler(worker);
-				return GNUNET_WORKER_SUCCESS;
+	const GNUNET_WORKER_LatencyHistogram * const source =
+		histograms + priority * GNUNET_WORKER_LATENCY_KIND_COUNT + kind;
 
-			}
+	for (int idx = 0; idx < GNUNET_WORKER_HISTOGRAM_SIZE; idx++) {
 
-			if (write(worker->beep_fd[1], &BEEP_CODE, 1) != 1) {
+		save_histogram->counts[idx] =
+			atomic_load_explicit(source->counts + idx, memory_order_relaxed);
 
-				retval = GNUNET_WORKER_ERR_SIGNAL;
-				goto paint_green_and_exit;
+	}
 
-			}
+	save_histogram->total =
+		atomic_load_explicit(&source->total, memory_order_relaxed);
 
-			/*  The zombie will be unzombified...  */
+	save_histogram->sum =
+		atomic_load_explicit(&source->sum, memory_order_relaxed);
 
-			/*  No case break (fallthrough)  */
+	save_histogram->max =
+		atomic_load_explicit(&source->max, memory_order_relaxed);
 
-		case WORKER_SAYS_BYE:
+	return true;
 
-			/*
+}
 
-			We return `GNUNET_WORKER_SUCCESS` here. It will appear as if the
-			job was scheduled and then immediately cancelled by the shutdown,
-			although none of it really took place...
 
-			*/
+/**
 
-			goto paint_green_and_exit;
+	@brief      Get the highest latency that falls in a bucket of a
+	            `GNUNET_WORKER_Histogram`
 
-		default:
+*/
+uint64_t GNUNET_WORKER_histogram_bucket_value (
+	const unsigned int bucket
+) {
 
-			GNUNET_WORKER_log(
-				GNUNET_ERROR_TYPE_ERROR,
-				_(
-					"An attempt to push load into a destroyed worker has been "
-					"detected\n"
-				)
-			);
+	if (bucket < (1u << WORKER_HISTOGRAM_SUB_BITS)) {
 
-			retval = GNUNET_WORKER_ERR_INVALID_HANDLE;
-			goto paint_green_and_exit;
+		return bucket;
 
 	}
 
-	GNUNET_WORKER_JobList * new_job = malloc(sizeof(GNUNET_WORKER_JobList));
-
-	if (!new_job) {
+	if (bucket >= GNUNET_WORKER_HISTOGRAM_SIZE - 1) {
 
-		retval = GNUNET_WORKER_ERR_NO_MEMORY;
-		goto paint_green_and_exit;
+		return UINT64_MAX;
 
 	}
 
-	new_job->routine = job_routine;
-	new_job->data = job_data;
-	new_job->priority = job_priority;
-	new_job->assigned_to = worker;
-	new_job->prev = NULL;
+	const unsigned int
+		offset = bucket - (1u << WORKER_HISTOGRAM_SUB_BITS),
+		shift = (offset >> (WORKER_HISTOGRAM_SUB_BITS - 1)) + 1;
 
-	if (currently_serving_as == worker) {
+	const uint64_t sub =
+		(offset & ((1u << (WORKER_HISTOGRAM_SUB_BITS - 1)) - 1)) +
+		(1u << (WORKER_HISTOGRAM_SUB_BITS - 1));
 
-		/*  The user has called this function from the worker thread  */
+	return (sub << shift) + ((uint64_t) 1 << shift) - 1;
 
-		if (worker->schedules) {
+}
 
-			worker->schedules->prev = new_job;
 
-		}
+/**
 
-		new_job->next = worker->schedules;
-		worker->schedules = new_job;
+	@brief      Get a percentile of a `GNUNET_WORKER_Histogram`
 
-		new_job->scheduled_as = GNUNET_SCHEDULER_add_with_priority(
-			job_priority,
-			call_and_unlist_handler,
-			new_job
-		);
+*/
+uint64_t GNUNET_WORKER_histogram_percentile (
+	const GNUNET_WORKER_Histogram * const histogram,
+	const double percentile
+) {
 
-		goto paint_green_and_exit;
+	if (!histogram->total) {
 
-	}
+		return 0;
 
-	/*  The user has **not** called this function from the worker thread  */
+	}
 
-	new_job->scheduled_as = NULL;
-	pthread_mutex_lock(&worker->wishes_mutex);
-	new_job->next = worker->wishlist;
+	uint64_t rank = percentile * histogram->total / 100.0 + 0.999999, seen = 0;
 
-	if (worker->wishlist) {
+	if (rank < 1) {
 
-		worker->wishlist->prev = new_job;
-		worker->wishlist = new_job;
+		rank = 1;
 
-	} else {
+	}
 
-		worker->wishlist = new_job;
+	for (int idx = 0; idx < GNUNET_WORKER_HISTOGRAM_SIZE; idx++) {
 
-		if (write(worker->beep_fd[1], &BEEP_CODE, 1) != 1) {
+		if ((seen += histogram->counts[idx]) >= rank) {
 
-			/*  Without a "beep" the list stays empty...  */
+			const uint64_t value = GNUNET_WORKER_histogram_bucket_value(idx);
 
-			worker->wishlist = NULL;
-			free(new_job);
-			retval = GNUNET_WORKER_ERR_SIGNAL;
+			return value < histogram->max ? value : histogram->max;
 
 		}
 
 	}
 
-	pthread_mutex_unlock(&worker->wishes_mutex);
-
-
-	/* \                                 /\
-	\ */     paint_green_and_exit:      /* \
-	 \/     _______________________     \ */
-
-
-	requirement_paint_green(&worker->worker_is_disposable);
-	return retval;
+	return histogram->max;
 
 }
 
 
 /**
 
-	@brief      Start the GNUnet scheduler in a separate thread
+	@brief      Switch the routine profiler of a worker on or off
 
 */
-int GNUNET_WORKER_create (
-	GNUNET_WORKER_Handle * const save_handle,
-	const GNUNET_WORKER_LifeRoutine on_worker_start,
-	const GNUNET_CallbackRoutine on_worker_end,
-	void * const worker_data
+int GNUNET_WORKER_set_routine_profiling (
+	const GNUNET_WORKER_Handle worker,
+	const unsigned int flags
 ) {
 
-	GNUNET_WORKER_Handle worker;
+	if (flags && !atomic_load(&worker->routine_table)) {
 
-	const int tempval = GNUNET_WORKER_allocate(
-		&worker,
-		NULL,
-		on_worker_start,
-		on_worker_end,
-		worker_data,
-		WORKER_FLAG_OWN_THREAD
-	);
+		/*  All-zero bits are a valid initial state for lock-free atomics  */
 
-	if (tempval) {
+		GNUNET_WORKER_RoutineTable * expected = NULL, * const table =
+			calloc(1, sizeof(GNUNET_WORKER_RoutineTable));
 
-		return tempval;
+		if (!table) {
 
-	}
+			return GNUNET_WORKER_ERR_NO_MEMORY;
 
-	if (
-		pthread_create(
-			(pthread_t *) &worker->worker_thread,
-			NULL,
-			&scheduler_launcher,
-			worker
-		)
-	) {
+		}
 
-		GNUNET_WORKER_unallocate(worker);
-		return GNUNET_WORKER_ERR_THREAD_CREATE;
+		/*  Another thread might have been faster  */
 
-	}
+		if (
+			!atomic_compare_exchange_strong(
+				&worker->routine_table,
+				&expected,
+				table
+			)
+		) {
 
-	if (save_handle) {
+			free(table);
 
-		*save_handle = worker;
+		}
 
 	}
 
+	atomic_store(&worker->profile_flags, flags);
 	return GNUNET_WORKER_SUCCESS;
 
 }
@@ -1797,165 +5479,193 @@ int GNUNET_WORKER_create (
 
 /**
 
-	@brief      Launch the GNUnet scheduler in the current thread and turn it
-	            into a worker
+	@brief      Get a snapshot of the routine profile of a worker
 
 */
-int GNUNET_WORKER_start_serving (
-	GNUNET_WORKER_Handle * const save_handle,
-	const GNUNET_WORKER_MasterRoutine master_routine,
-	const GNUNET_WORKER_LifeRoutine on_worker_start,
-	const GNUNET_CallbackRoutine on_worker_end,
-	void * const worker_data
+size_t GNUNET_WORKER_get_routine_profile (
+	const GNUNET_WORKER_Handle worker,
+	GNUNET_WORKER_RoutineProfile * const save_profile,
+	const size_t max_entries
 ) {
 
-	if (currently_serving_as) {
+	const GNUNET_WORKER_RoutineTable * const table =
+		atomic_load_explicit(&worker->routine_table, memory_order_acquire);
 
-		return GNUNET_WORKER_ERR_ALREADY_SERVING;
+	size_t found = 0;
+
+	if (!table) {
+
+		return 0;
 
 	}
 
-	GNUNET_WORKER_Handle worker;
+	for (int idx = 0; idx <= WORKER_PROFILE_SIZE; idx++) {
 
-	const int tempval = GNUNET_WORKER_allocate(
-		&worker,
-		master_routine,
-		on_worker_start,
-		on_worker_end,
-		worker_data,
-		WORKER_FLAG_NONE
-	);
+		const GNUNET_WORKER_RoutineCounters * const source =
+			idx < WORKER_PROFILE_SIZE ? table->routines + idx : &table->others;
 
-	if (tempval) {
+		const uintptr_t routine =
+			atomic_load_explicit(&source->routine, memory_order_acquire);
 
-		return tempval;
+		const uint64_t calls =
+			atomic_load_explicit(&source->calls, memory_order_relaxed);
 
-	}
+		/*  Free entries, and a `::others` that has never been needed  */
 
-	/*  This is not strictly necessary at the moment (`::worker_thread` can be
-		left undefined if we are not the ones who created the worker thread).
-		However we might want to add thread-related utilities to the GNUnet
-		Worker API in the future...  */
+		if ((idx < WORKER_PROFILE_SIZE && !routine) || !calls) {
 
-	*((pthread_t *) &worker->worker_thread) = pthread_self();
+			continue;
 
-	if (master_routine && thread_create_detached(&master_launcher, worker)) {
+		}
 
-		GNUNET_WORKER_unallocate(worker);
-		return GNUNET_WORKER_ERR_THREAD_CREATE;
+		if (found < max_entries) {
 
-	}
+			#define counter_of(FIELD) \
+				atomic_load_explicit(&source->FIELD, memory_order_relaxed)
 
-	if (save_handle) {
+			save_profile[found] = (GNUNET_WORKER_RoutineProfile) {
+				.routine = (GNUNET_CallbackRoutine) routine,
+				.calls = calls,
+				.wall_time = counter_of(wall_time),
+				.cpu_time = counter_of(cpu_time),
+				.cycles = counter_of(cycles),
+				.instructions = counter_of(instructions)
+			};
 
-		*save_handle = worker;
+			#undef counter_of
+
+		}
+
+		found++;
 
 	}
 
-	scheduler_launcher(worker);
-	return GNUNET_WORKER_SUCCESS;
+	return found;
 
 }
 
 
 /**
 
-	@brief      Install a load listener into an already running scheduler and
-	            turn the latter into a worker
+	@brief      Install or remove the process-wide tracer
 
 */
-int GNUNET_WORKER_adopt_running_scheduler (
-	GNUNET_WORKER_Handle * const save_handle,
-	const GNUNET_WORKER_MasterRoutine master_routine,
-	const GNUNET_CallbackRoutine on_worker_end,
-	void * const worker_data
+void GNUNET_WORKER_set_tracer (
+	const GNUNET_WORKER_Tracer * const tracer
 ) {
 
-	if (currently_serving_as) {
+	pthread_mutex_lock(&tracer_mutex);
+	atomic_store(&current_tracer, tracer);
 
-		return GNUNET_WORKER_ERR_ALREADY_SERVING;
+	/*  Whoever enters the tracer from now on sees the new one  */
 
-	}
+	const unsigned int slot = atomic_fetch_add(&tracer_epoch, 1) & 1;
 
-	const int tempval = GNUNET_WORKER_allocate(
-		&currently_serving_as,
-		master_routine,
-		NULL,
-		on_worker_end,
-		worker_data,
-		WORKER_FLAG_IS_GUEST
-	);
+	/*  The calls of the old tracer last as long as one event, hence yielding
+		is enough  */
 
-	if (tempval) {
+	while (atomic_load_explicit(tracer_calls + slot, memory_order_acquire)) {
 
-		return tempval;
+		sched_yield();
 
 	}
 
-	/*  This is not strictly necessary at the moment (`::worker_thread` can be
-		left undefined if we are not the ones who created the worker thread).
-		However we might want to add thread-related utilities to the GNUnet
-		Worker API in the future...  */
+	pthread_mutex_unlock(&tracer_mutex);
 
-	*((pthread_t *) &currently_serving_as->worker_thread) = pthread_self();
+}
 
-	if (
-		master_routine &&
-		thread_create_detached(&master_launcher, currently_serving_as)
-	) {
 
-		GNUNET_WORKER_unallocate(currently_serving_as);
-		return GNUNET_WORKER_ERR_THREAD_CREATE;
+/**
 
-	}
+	@brief      Retrieve the custom data initially passed to the worker
 
-	currently_serving_as->shutdown_schedule = GNUNET_SCHEDULER_add_shutdown(
-		&unattended_shutdown_handler,
-		currently_serving_as
-	);
+**/
+void * GNUNET_WORKER_get_data (
+	const GNUNET_WORKER_Handle worker
+) {
 
-	currently_serving_as->listener_schedule = GNUNET_SCHEDULER_add_select(
-		WORKER_LISTENER_PRIORITY,
-		GNUNET_TIME_UNIT_FOREVER_REL,
-		currently_serving_as->beep_fds,
-		NULL,
-		&load_request_handler,
-		currently_serving_as
-	);
+	return worker->data;
 
-	if (save_handle) {
+}
 
-		*save_handle = currently_serving_as;
 
-	}
+/**
 
-	return GNUNET_WORKER_SUCCESS;
+	@brief      Get the checked identifier of a worker
+
+**/
+GNUNET_WORKER_Id GNUNET_WORKER_get_id (
+	const GNUNET_WORKER_Handle worker
+) {
+
+	return worker->id;
 
 }
 
 
 /**
 
-	@brief      Get the handle of the current worker if this is a worker thread
+	@brief      Check whether an identifier still refers to a worker
 
 **/
-GNUNET_WORKER_Handle GNUNET_WORKER_get_current_handle (void) {
+bool GNUNET_WORKER_id_is_valid (
+	const GNUNET_WORKER_Id worker_id
+) {
 
-	return currently_serving_as;
+	const GNUNET_WORKER_Handle worker = GNUNET_WORKER_slot_pin(worker_id);
+
+	if (!worker) {
+
+		return false;
+
+	}
+
+	const enum GNUNET_WORKER_State state = atomic_load(&worker->state);
+	const bool retval = state != WORKER_IS_DYING && state != WORKER_IS_DEAD;
+	GNUNET_WORKER_slot_unpin(worker_id);
+	return retval;
 
 }
 
 
 /**
 
-	@brief      Retrieve the custom data initially passed to the worker
+	@brief      Schedule a new function for a worker addressed by its
+	            identifier, with a priority
 
 **/
-void * GNUNET_WORKER_get_data (
-	const GNUNET_WORKER_Handle worker
+int GNUNET_WORKER_push_load_by_id (
+	const GNUNET_WORKER_Id worker_id,
+	const enum GNUNET_SCHEDULER_Priority job_priority,
+	const GNUNET_CallbackRoutine job_routine,
+	void * const job_data
 ) {
 
-	return worker->data;
+	const GNUNET_WORKER_Handle worker = GNUNET_WORKER_slot_pin(worker_id);
+
+	if (!worker) {
+
+		return GNUNET_WORKER_ERR_INVALID_HANDLE;
+
+	}
+
+	/*  A worker that is being destroyed is as good as freed (but quietly)  */
+
+	const enum GNUNET_WORKER_State state = atomic_load(&worker->state);
+
+	const int retval =
+		state != WORKER_IS_DYING && state != WORKER_IS_DEAD ?
+			GNUNET_WORKER_push_load_with_priority(
+				worker,
+				job_priority,
+				job_routine,
+				job_data
+			)
+		:
+			GNUNET_WORKER_ERR_INVALID_HANDLE;
+
+	GNUNET_WORKER_slot_unpin(worker_id);
+	return retval;
 
 }
 
@@ -1981,7 +5691,7 @@ bool GNUNET_WORKER_ping (
 
 	/*  The user has **not** called this function from the worker thread  */
 
-	return write(worker->beep_fd[1], &BEEP_CODE, 1) == 1;
+	return worker_beep(worker);
 
 }
 
@@ -37,15 +37,19 @@
 
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdatomic.h>
 #include <time.h>
 #include <pthread.h>
 #include <gnunet/platform.h>
 #include <gnunet/gnunet_common.h>
+#include <gnunet/gnunet_time_lib.h>
 #include <gnunet/gnunet_scheduler_lib.h>
 #include <gnunet/gnunet_network_lib.h>
 #include "include/gnunet_worker_lib.h"
 #include "requirement.h"
+#include "flight.h"
+#include "slots.h"
 
 
 /**
@@ -72,6 +76,164 @@
     GNUNET_SCHEDULER_PRIORITY_URGENT
 
 
+/**
+
+    @brief      The number of file descriptors that form a beep channel
+
+    With `eventfd(2)` a single counter is both read and written, and any
+    number of beeps is coalesced into one read; otherwise a pipe is used
+    (`::beep_fd[0]` is then its read end and `::beep_fd[1]` its write end).
+
+**/
+#ifdef WORKER_USE_EVENTFD
+#define WORKER_BEEP_FDS 1
+#else
+#define WORKER_BEEP_FDS 2
+#endif
+
+
+/**
+
+    @brief      Fire a USDT static probe of the `gnunet_worker` provider
+
+    With `--enable-sdt` every probe is one NOP instruction (plus the
+    evaluation of its arguments) until a tracer such as `perf`, `bpftrace` or
+    SystemTap attaches to it; otherwise the probes are not compiled at all.
+
+**/
+#ifdef WORKER_USE_SDT
+#define WORKER_PROBE1(NAME, A1) \
+    STAP_PROBE1(gnunet_worker, NAME, A1)
+#define WORKER_PROBE2(NAME, A1, A2) \
+    STAP_PROBE2(gnunet_worker, NAME, A1, A2)
+#define WORKER_PROBE3(NAME, A1, A2, A3) \
+    STAP_PROBE3(gnunet_worker, NAME, A1, A2, A3)
+#define WORKER_PROBE4(NAME, A1, A2, A3, A4) \
+    STAP_PROBE4(gnunet_worker, NAME, A1, A2, A3, A4)
+#else
+#define WORKER_PROBE1(NAME, A1) ((void) 0)
+#define WORKER_PROBE2(NAME, A1, A2) ((void) 0)
+#define WORKER_PROBE3(NAME, A1, A2, A3) ((void) 0)
+#define WORKER_PROBE4(NAME, A1, A2, A3, A4) ((void) 0)
+#endif
+
+
+/**
+
+    @brief      The default maximum number of spare job nodes a worker keeps
+                for reuse
+
+    See `GNUNET_WORKER_set_job_pool_size()`.
+
+**/
+#define WORKER_DEFAULT_JOB_POOL_SIZE 1024
+
+
+/**
+
+    @brief      The default number of jobs a dispatcher runs before yielding
+                back to the scheduler
+
+    Zero, i.e. the dispatch mode is off and every job becomes a GNUnet task of
+    its own. See `GNUNET_WORKER_set_dispatch_budget()`.
+
+**/
+#define WORKER_DEFAULT_DISPATCH_BUDGET 0
+
+
+/**
+
+    @brief      The bits of precision of the buckets of a latency histogram
+
+    See `GNUNET_WORKER_HISTOGRAM_SIZE`.
+
+**/
+#define WORKER_HISTOGRAM_SUB_BITS 5
+
+
+/**
+
+    @brief      The number of bits of the largest latency a histogram can tell
+                apart from the others
+
+**/
+#define WORKER_HISTOGRAM_MAX_BITS 40
+
+
+_Static_assert(
+    GNUNET_WORKER_HISTOGRAM_SIZE ==
+        (1 << WORKER_HISTOGRAM_SUB_BITS) +
+        ((WORKER_HISTOGRAM_MAX_BITS - WORKER_HISTOGRAM_SUB_BITS) <<
+            (WORKER_HISTOGRAM_SUB_BITS - 1)),
+    "GNUNET_WORKER_HISTOGRAM_SIZE does not match the histogram layout"
+);
+
+
+/**
+
+    @brief      The flag added to `GNUNET_WORKER_Instance::calls_in_flight` by
+                the thread that waits for the public functions to leave the
+                worker before freeing it
+
+**/
+#define WORKER_DISPOSER_WAITS 0x80000000u
+
+
+/**
+
+    @brief      The number of routines the profiler of a worker can tell apart
+                (must be a power of two)
+
+    See `GNUNET_WORKER_set_routine_profiling()`.
+
+**/
+#define WORKER_PROFILE_SIZE 256
+
+
+/**
+
+    @brief      The hardware counters read by the routine profiler
+
+**/
+#define WORKER_PERF_COUNTERS 2
+
+
+/**
+
+    @brief      The size of a cache line, which the regions of
+                `GNUNET_WORKER_Instance` are aligned to
+
+    Most CPUs have 64-byte lines. On those with larger ones the spatial
+    prefetcher might still pair two regions, which is harmless but costs
+    some of the benefit.
+
+**/
+#define WORKER_CACHE_LINE 64
+
+
+/**
+
+    @brief      Start a new region of `GNUNET_WORKER_Instance` or of
+                `GNUNET_WORKER_Counters` on a new cache line
+
+    With `--disable-aligned-layout` the regions are not aligned and the fields
+    are packed as in a plain structure. That layout exists only for measuring
+    what the alignment is worth (see the "Benchmarks" section of the README).
+
+**/
+#ifdef WORKER_PACKED_LAYOUT
+#define WORKER_REGION
+#else
+#define WORKER_REGION _Alignas(WORKER_CACHE_LINE)
+#endif
+
+
+_Static_assert(
+    !(WORKER_PROFILE_SIZE & (WORKER_PROFILE_SIZE - 1)),
+    "WORKER_PROFILE_SIZE must be a power of two"
+);
+
+
 /**
 
     @brief      An alternative to `GNUNET_log()` that prints the name of this
@@ -109,11 +271,47 @@ enum GNUNET_WORKER_State {
     WORKER_IS_ALIVE = 0,    /**< The worker is alive and well **/
     WORKER_SAYS_BYE = 1,    /**< The worker is calling its `on_worker_end` **/
     WORKER_IS_DYING = 2,    /**< The worker might die at any moment now **/
-    WORKER_IS_ZOMBIE = 3,   /**< The worker is unable to die (pipe is down) **/
+    WORKER_IS_ZOMBIE = 3,   /**< The worker is unable to die (the beep channel
+                                 is down) **/
     WORKER_IS_DEAD = 4      /**< The worker is dead, to be disposed soon **/
 };
 
 
+_Static_assert(
+    (int) WORKER_IS_ALIVE == (int) GNUNET_WORKER_STAGE_ALIVE &&
+        (int) WORKER_SAYS_BYE == (int) GNUNET_WORKER_STAGE_SAYS_BYE &&
+        (int) WORKER_IS_DYING == (int) GNUNET_WORKER_STAGE_DYING &&
+        (int) WORKER_IS_ZOMBIE == (int) GNUNET_WORKER_STAGE_ZOMBIE &&
+        (int) WORKER_IS_DEAD == (int) GNUNET_WORKER_STAGE_DEAD,
+    "GNUNET_WORKER_LifeStage does not match enum GNUNET_WORKER_State"
+);
+
+
+/**
+
+    @brief      Possible states of a job that has a ticket
+
+**/
+enum GNUNET_WORKER_JobStatus {
+    JOB_IS_PENDING = 0,     /**< The job has not been started yet **/
+    JOB_HAS_STARTED = 1,    /**< The job's routine has been invoked **/
+    JOB_IS_CANCELLED = 2,   /**< The job has been cancelled via its ticket **/
+    JOB_IS_DISCARDED = 3    /**< The job has been dropped by the shutdown **/
+};
+
+
+/**
+
+    @brief      Possible states of a `GNUNET_WORKER_Call`
+
+**/
+enum GNUNET_WORKER_CallState {
+    CALL_IS_PENDING = 0,    /**< The routine has not returned yet **/
+    CALL_IS_DONE = 1,       /**< The routine has returned a result **/
+    CALL_IS_DROPPED = 2     /**< The call has been dropped by the shutdown **/
+};
+
+
 /**
 
     @brief      Flags set during the creation of a worker
@@ -130,6 +328,17 @@ enum GNUNET_WORKER_Flags {
 
     @brief      Doubly linked list containing tasks for the scheduler
 
+    When a job is still in `GNUNET_WORKER_Instance::wishlist` only the
+    `::next` field is used (the wishlist is a singly linked lock-free stack);
+    the `::prev` field becomes meaningful only after the job has been moved
+    into `GNUNET_WORKER_Instance::schedules`.
+
+    A ticketed job (see `GNUNET_WORKER_push_load_with_ticket()`) is freed only
+    when both the worker and the ticket have released it.
+
+    A node owned by the caller (see `GNUNET_WORKER_push_job()`) is never freed
+    nor recycled: it is handed back via `::on_complete` instead.
+
 **/
 typedef struct GNUNET_WORKER_JobList {
     struct GNUNET_WORKER_JobList
@@ -146,9 +355,214 @@ typedef struct GNUNET_WORKER_JobList {
         * scheduled_as;             /**< A handle for the scheduled task **/
     enum GNUNET_SCHEDULER_Priority
         priority;                   /**< The job's priority **/
+    struct GNUNET_TIME_Absolute
+        due;                        /**< When the job must run (zero if the
+                                         job must run as soon as possible) **/
+    struct GNUNET_TIME_Relative
+        period;                     /**< The interval between two runs of a
+                                         periodic job (zero if the job must
+                                         run only once) **/
+    uint64_t
+        pushed_at;                  /**< When the job was pushed, in
+                                         nanoseconds (zero if latency tracking
+                                         was off) **/
+    atomic_int
+        status;                     /**< Atomic; see
+                                         `enum GNUNET_WORKER_JobStatus` (used
+                                         only if `::ticketed` is `true`) **/
+    atomic_uint
+        refs;                       /**< Atomic; the references held by the
+                                         worker and by the ticket (used only
+                                         if `::ticketed` is `true`), or by the
+                                         worker alone (`1` while a node owned
+                                         by the caller is queued) **/
+    GNUNET_WORKER_JobCompletion
+        on_complete;                /**< The function that hands a node owned
+                                         by the caller back, or `NULL` for a
+                                         node owned by the library **/
+    struct GNUNET_WORKER_JobList
+        * next_cancelled;           /**< The next ticket in
+                                         `GNUNET_WORKER_Instance::cancellations`
+                                         **/
+    GNUNET_WORKER_Id
+        worker_id;                  /**< The identifier of `::assigned_to`,
+                                         for the threads that cannot trust the
+                                         handle anymore (see
+                                         `GNUNET_WORKER_cancel_load()`) **/
+    bool
+        ticketed,                   /**< A ticket was given for this job **/
+        rerun;                      /**< The job is periodic and has already
+                                         run at least once **/
 } GNUNET_WORKER_JobList;
 
 
+_Static_assert(
+    sizeof(GNUNET_WORKER_JobList) <= sizeof(GNUNET_WORKER_Job) &&
+        _Alignof(GNUNET_WORKER_JobList) <= _Alignof(GNUNET_WORKER_Job),
+    "GNUNET_WORKER_JobList does not fit in GNUNET_WORKER_Job"
+);
+
+
+/**
+
+    @brief      A synchronous call, living on the stack of the calling thread
+
+    See `GNUNET_WORKER_call()`. The job that carries the call is an ordinary
+    job node; only this record lives on the caller's stack, and the worker
+    never touches it after having set `::state`.
+
+**/
+typedef struct GNUNET_WORKER_Call {
+    GNUNET_WORKER_CallRoutine
+        routine;                    /**< The routine to call **/
+    void
+        * data,                     /**< The routine's argument **/
+        * result;                   /**< The routine's return value **/
+    atomic_uint
+        state;                      /**< Atomic; see
+                                         `enum GNUNET_WORKER_CallState` (also
+                                         used as futex word) **/
+} GNUNET_WORKER_Call;
+
+
+/**
+
+    @brief      The FIFO queue of the jobs of one priority level, together with
+                the task that runs them (dispatch mode)
+
+    Jobs in `::head` are linked via `GNUNET_WORKER_JobList::next` only and are
+    not GNUnet tasks of their own; only `::dispatcher` is. In classic mode
+    buckets stay empty and only `::depth` is used.
+
+**/
+typedef struct GNUNET_WORKER_Bucket {
+    GNUNET_WORKER_JobList
+        * head,                     /**< The oldest job in the queue **/
+        * tail;                     /**< The newest job in the queue **/
+    struct GNUNET_SCHEDULER_Task
+        * dispatcher;               /**< A handle for the scheduled dispatcher
+                                         (`NULL` also while it runs) **/
+    GNUNET_WORKER_Handle
+        owner;                      /**< The worker the bucket belongs to **/
+    atomic_size_t
+        depth;                      /**< Atomic; the number of jobs received
+                                         by the worker thread and not started
+                                         yet **/
+    enum GNUNET_SCHEDULER_Priority
+        priority;                   /**< The priority of the bucket **/
+} GNUNET_WORKER_Bucket;
+
+
+/**
+
+    @brief      The statistics of a worker (see `GNUNET_WORKER_get_stats()`)
+
+    All the counters are updated with relaxed atomic operations; those written
+    by the worker thread only are updated without read-modify-write
+    instructions.
+
+    The counters written by other threads and those written by the worker
+    thread live on different cache lines.
+
+**/
+typedef struct GNUNET_WORKER_Counters {
+    WORKER_REGION atomic_uint_fast64_t
+        jobs_pushed_remotely;       /**< Atomic; jobs published in
+                                         `GNUNET_WORKER_Instance::wishlist` **/
+    atomic_uint_fast64_t
+        jobs_dropped,               /**< Atomic; jobs freed by the shutdown **/
+        beeps_sent,                 /**< Atomic; successful writes into the
+                                         beep channel **/
+        beeps_failed;               /**< Atomic; failed writes into the beep
+                                         channel **/
+    WORKER_REGION atomic_uint_fast64_t
+        jobs_pushed_locally;        /**< Atomic; written by the worker thread
+                                         only **/
+    atomic_uint_fast64_t
+        jobs_drained,               /**< Atomic; jobs taken out of
+                                         `GNUNET_WORKER_Instance::wishlist`
+                                         (written by the worker thread only,
+                                         except at shutdown) **/
+        jobs_executed,              /**< Atomic; written by the worker thread
+                                         only **/
+        beeps_received,             /**< Atomic; written by the worker thread
+                                         only **/
+        wakeups,                    /**< Atomic; written by the worker thread
+                                         only **/
+        wishlist_peak,              /**< Atomic; written by the worker thread
+                                         only **/
+        scheduled_peak;             /**< Atomic; written by the worker thread
+                                         only **/
+} GNUNET_WORKER_Counters;
+
+
+/**
+
+    @brief      A latency histogram updated by the worker thread and read by
+                any thread (see `GNUNET_WORKER_Histogram`)
+
+**/
+typedef struct GNUNET_WORKER_LatencyHistogram {
+    atomic_uint_fast64_t
+        counts[GNUNET_WORKER_HISTOGRAM_SIZE],   /**< Atomic; the buckets **/
+        total,                      /**< Atomic; the number of samples **/
+        sum,                        /**< Atomic; the sum of the samples **/
+        max;                        /**< Atomic; the largest sample **/
+} GNUNET_WORKER_LatencyHistogram;
+
+
+/**
+
+    @brief      The resources spent in one routine, updated by the worker
+                thread and read by any thread (see
+                `GNUNET_WORKER_RoutineProfile`)
+
+**/
+typedef struct GNUNET_WORKER_RoutineCounters {
+    atomic_uintptr_t
+        routine;                    /**< Atomic; the routine, or `0` for a free
+                                         entry (written once) **/
+    atomic_uint_fast64_t
+        calls,                      /**< Atomic; the calls measured **/
+        wall_time,                  /**< Atomic; in nanoseconds **/
+        cpu_time,                   /**< Atomic; in nanoseconds **/
+        cycles,                     /**< Atomic; user-space CPU cycles **/
+        instructions;               /**< Atomic; user-space instructions **/
+} GNUNET_WORKER_RoutineCounters;
+
+
+/**
+
+    @brief      The routine profile of a worker
+
+    The routines are kept in an open-addressing hash table keyed by their
+    address; entries are never removed.
+
+**/
+typedef struct GNUNET_WORKER_RoutineTable {
+    GNUNET_WORKER_RoutineCounters
+        routines[WORKER_PROFILE_SIZE],  /**< The hash table **/
+        others;                     /**< The routines that did not fit in
+                                         `::routines` **/
+} GNUNET_WORKER_RoutineTable;
+
+
+/**
+
+    @brief      A reading of what the routine profiler measures, taken before
+                and after a routine (worker thread only)
+
+**/
+typedef struct GNUNET_WORKER_ProfileSample {
+    uint64_t
+        wall_time,                  /**< `CLOCK_MONOTONIC`, in nanoseconds **/
+        cpu_time,                   /**< `CLOCK_THREAD_CPUTIME_ID`, in
+                                         nanoseconds **/
+        counters[WORKER_PERF_COUNTERS]; /**< The cycles and the instructions
+                                             **/
+} GNUNET_WORKER_ProfileSample;
+
+
 /**
 
     @brief      The entire scope of a worker
@@ -157,20 +571,113 @@ typedef struct GNUNET_WORKER_JobList {
     multiple threads; in the latter case they are either atomic or a mutual
     exclusion mechanism is provided.
 
+    The fields are grouped by who writes them, and every group begins on a new
+    cache line: a push dirties only the lines of the producer side, while the
+    worker thread keeps the lines of the consumer side for itself and everybody
+    shares the lines of the cold side in read-only mode. Since the structure is
+    over-aligned it must be allocated with `aligned_alloc()`.
+
 **/
 typedef struct GNUNET_WORKER_Instance {
-    Requirement
-        scheduler_has_returned, /**< The scheduler has returned **/
-        worker_is_disposable;   /**< `free()` can be launched on the worker **/
+
+    /*  Producer side: written by the threads that push load  */
+
+    WORKER_REGION atomic_uint
+        calls_in_flight;        /**< Atomic; the public functions that are
+                                     using the worker, plus
+                                     `WORKER_DISPOSER_WAITS` when the worker
+                                     is about to be freed (also used as futex
+                                     word); see `worker_enter()` **/
+    _Atomic(GNUNET_WORKER_JobList *)
+        wishlist;               /**< Atomic; lock-free LIFO stack **/
+    _Atomic(GNUNET_WORKER_JobList *)
+        cancellations;          /**< Atomic; lock-free LIFO stack of the
+                                     tickets cancelled by other threads,
+                                     linked via
+                                     `GNUNET_WORKER_JobList::next_cancelled` **/
+    _Atomic(GNUNET_WORKER_JobList *)
+        spare_jobs;             /**< Atomic; recycled nodes for any thread **/
+    atomic_size_t
+        spare_jobs_count,       /**< Atomic; approximate length of
+                                     `::spare_jobs` **/
+        pending_jobs;           /**< Atomic; jobs pushed and not started yet **/
+    atomic_uint
+        blocked_producers;      /**< Atomic; threads waiting for room **/
     pthread_mutex_t
-        wishes_mutex,           /**< For `::wishlist` and `::future_plans` **/
-        kill_mutex;             /**< For various shutting down operations **/
-    GNUNET_WORKER_JobList
-        * wishlist,             /**< Mutual exclusion via `::wishes_mutex` **/
+        room_mutex;             /**< For producers waiting for room **/
+    pthread_cond_t
+        room_cond;              /**< Broadcast when a bounded worker makes room
+                                     and producers are waiting **/
+
+    /*  Consumer side: accessed only by the worker thread  */
+
+    WORKER_REGION GNUNET_WORKER_JobList
         * schedules;            /**< Accessed only by the worker thread **/
+    GNUNET_WORKER_JobList
+        * recycled_jobs,        /**< Accessed only by the worker thread **/
+        * recycled_jobs_tail;   /**< Accessed only by the worker thread **/
+    size_t
+        recycled_jobs_count;    /**< Accessed only by the worker thread **/
+    unsigned int
+        busy_buckets;           /**< Accessed only by the worker thread; a
+                                     bitmap of the buckets with queued jobs or
+                                     a dispatcher scheduled or running **/
+    int
+        perf_fd[WORKER_PERF_COUNTERS];  /**< Accessed only by the worker
+                                             thread (and by the disposal); the
+                                             hardware counters of the worker
+                                             thread, `-1` if not opened yet,
+                                             `-2` if they cannot be opened **/
     struct GNUNET_SCHEDULER_Task
         * listener_schedule,    /**< Accessed only by the worker thread **/
         * shutdown_schedule;    /**< Accessed only by the worker thread **/
+    GNUNET_WORKER_Bucket
+        buckets[GNUNET_SCHEDULER_PRIORITY_COUNT];   /**< One per priority;
+                                                         see
+                                                         `GNUNET_WORKER_Bucket`
+                                                         **/
+
+    /*  Statistics: aligned internally (see `GNUNET_WORKER_Counters`)  */
+
+    GNUNET_WORKER_Counters
+        counters;               /**< See `GNUNET_WORKER_Counters` **/
+
+    /*  Cold side: immutable, read-mostly or rarely used  */
+
+    WORKER_REGION atomic_int
+        state;                  /**< Atomic; see `enum GNUNET_WORKER_State` **/
+    atomic_int
+        future_plans;           /**< Atomic; see
+                                     `GNUNET_WORKER_LifeInstructions` **/
+    unsigned int
+        const flags;            /**< See `enum GNUNET_WORKER_Flags` **/
+    atomic_size_t
+        job_pool_size,          /**< Atomic; the high-water mark of the pool **/
+        capacity;               /**< Atomic; the maximum number of pending jobs
+                                     (`0` for no limit) **/
+    atomic_uint
+        dispatch_budget;        /**< Atomic; jobs per dispatcher run, or `0`
+                                     for one GNUnet task per job **/
+    atomic_bool
+        track_latency;          /**< Atomic; see
+                                     `GNUNET_WORKER_set_latency_tracking()` **/
+    atomic_uint
+        profile_flags;          /**< Atomic; see
+                                     `GNUNET_WORKER_set_routine_profiling()` **/
+    _Atomic(GNUNET_WORKER_LatencyHistogram *)
+        latencies;              /**< Atomic; `NULL` until latency tracking is
+                                     switched on for the first time, then one
+                                     histogram per priority and per
+                                     `GNUNET_WORKER_LatencyKind` **/
+    _Atomic(GNUNET_WORKER_RoutineTable *)
+        routine_table;          /**< Atomic; `NULL` until the routine profiler
+                                     is switched on for the first time **/
+    FlightRecorder
+        * const flight_recorder;    /**< The ring of the last events of the
+                                         worker; see `FlightRecorder` **/
+    GNUNET_WORKER_Id
+        const id;               /**< The checked identifier of the worker; see
+                                     `WorkerSlot` **/
     GNUNET_WORKER_MasterRoutine
         const master;           /**< See the `master_routine` argument **/
     GNUNET_WORKER_LifeRoutine
@@ -184,13 +691,11 @@ typedef struct GNUNET_WORKER_Instance {
     struct GNUNET_NETWORK_FDSet
         * const beep_fds;       /**< GNUnet's file descriptor set **/
     int
-        const beep_fd[2];       /**< The worker's pipe **/
-    unsigned int
-        const flags;            /**< See `enum GNUNET_WORKER_Flags` **/
-    atomic_int
-        state;                  /**< Atomic; see `enum GNUNET_WORKER_State` **/
-    GNUNET_WORKER_LifeInstructions
-        future_plans;           /**< Mutual exclusion via `::wishes_mutex` **/
+        const beep_fd[WORKER_BEEP_FDS]; /**< The worker's beep channel **/
+    Requirement
+        scheduler_has_returned; /**< The scheduler has returned **/
+    pthread_mutex_t
+        kill_mutex;             /**< For various shutting down operations **/
 } GNUNET_WORKER_Instance;
 
 